@@ -0,0 +1,283 @@
+// bench_simd - Per-kernel timing of the SIMD layer on every ISA
+//
+// Usage: bench_simd [-s seconds] [-r repeats] [-o out.tsv]
+//
+// Times each kernel of each SimdKernels table this host runs (see
+// src/dsp/simd_dispatch.h) over a range of lengths and writes one TSV row per
+// case (header first):
+//
+//   isa kernel n calls ns_per_call ns_per_element
+//
+// Each case repeats the kernel on the same warm buffers for about seconds,
+// and reports the best of the repeats. Lengths include the bin counts of the
+// 512- and 1024-point FFTs the detector runs at 16 and 44.1/48 kHz.
+
+#include "dsp/simd_dispatch.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MAX_N 4096
+
+static const size_t lengths[] = {16, 26, 64, 257, 513, 1024, 4096};
+#define NUM_LENGTHS (int)(sizeof(lengths) / sizeof(lengths[0]))
+
+// --- Timing ---
+
+static double now_seconds(void) {
+#ifdef _WIN32
+  LARGE_INTEGER freq, count;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+// --- Kernels ---
+
+// Inputs, filled once; outputs are overwritten by every call
+static float in_a[2 * MAX_N], in_b[MAX_N], in_c[MAX_N];
+static float out_f[MAX_N];
+static int16_t in_i16[2 * MAX_N];
+static uint8_t in_i24[3 * MAX_N];
+static int32_t in_i32[MAX_N];
+
+// One call of a kernel; returns a value derived from its output so that the
+// work cannot be skipped
+typedef float (*KernelRun)(const SimdKernels *k, size_t n);
+
+static float run_dot_product(const SimdKernels *k, size_t n) {
+  return k->dot_product(in_a, in_b, n);
+}
+
+static float run_complex_dot(const SimdKernels *k, size_t n) {
+  float r, i;
+  k->complex_dot(in_a, in_b, in_c, n, &r, &i);
+  return r + i;
+}
+
+static float run_sum_squares(const SimdKernels *k, size_t n) {
+  return k->sum_squares(in_a, n);
+}
+
+static float run_hwr_diff_sum(const SimdKernels *k, size_t n) {
+  return k->hwr_diff_sum(in_a, in_b, n);
+}
+
+static float run_apply_window(const SimdKernels *k, size_t n) {
+  // Window of ones: the data stays the same call after call
+  k->apply_window(out_f, in_c, n);
+  return out_f[n - 1];
+}
+
+static float run_window_copy(const SimdKernels *k, size_t n) {
+  k->window_copy(in_a, in_b, out_f, n);
+  return out_f[n - 1];
+}
+
+static float run_magnitude(const SimdKernels *k, size_t n) {
+  k->magnitude(in_a, out_f, n);
+  return out_f[n - 1];
+}
+
+static float run_power(const SimdKernels *k, size_t n) {
+  k->power(in_a, out_f, n);
+  return out_f[n - 1];
+}
+
+static float run_log(const SimdKernels *k, size_t n) {
+  k->log(in_b, out_f, n);
+  return out_f[n - 1];
+}
+
+static float run_exp(const SimdKernels *k, size_t n) {
+  k->exp(in_a, out_f, n);
+  return out_f[n - 1];
+}
+
+static float run_spectral_stats(const SimdKernels *k, size_t n) {
+  float log_sum, arith_sum;
+  int valid;
+  return k->spectral_stats(in_a, out_f, n, &log_sum, &arith_sum, &valid) +
+         log_sum;
+}
+
+static float run_i16_to_f32(const SimdKernels *k, size_t n) {
+  k->i16_to_f32(in_i16, out_f, n, 1.0f / 32768.0f);
+  return out_f[n - 1];
+}
+
+static float run_i16_stereo_to_f32(const SimdKernels *k, size_t n) {
+  k->i16_stereo_to_f32(in_i16, out_f, n, -1, 0.5f / 32768.0f);
+  return out_f[n - 1];
+}
+
+static float run_i24_to_f32(const SimdKernels *k, size_t n) {
+  k->i24_to_f32(in_i24, out_f, n, 1.0f / 8388608.0f);
+  return out_f[n - 1];
+}
+
+static float run_i32_to_f32(const SimdKernels *k, size_t n) {
+  k->i32_to_f32(in_i32, out_f, n, 1.0f / 2147483648.0f);
+  return out_f[n - 1];
+}
+
+static const struct {
+  const char *name;
+  KernelRun run;
+} kernels[] = {
+    {"dot_product", run_dot_product},
+    {"complex_dot", run_complex_dot},
+    {"sum_squares", run_sum_squares},
+    {"hwr_diff_sum", run_hwr_diff_sum},
+    {"apply_window", run_apply_window},
+    {"window_copy", run_window_copy},
+    {"magnitude", run_magnitude},
+    {"power", run_power},
+    {"log", run_log},
+    {"exp", run_exp},
+    {"spectral_stats", run_spectral_stats},
+    {"i16_to_f32", run_i16_to_f32},
+    {"i16_stereo_to_f32", run_i16_stereo_to_f32},
+    {"i24_to_f32", run_i24_to_f32},
+    {"i32_to_f32", run_i32_to_f32},
+};
+#define NUM_KERNELS (int)(sizeof(kernels) / sizeof(kernels[0]))
+
+// xorshift32: the same inputs on every platform and run
+static uint32_t next_random(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static void fill_inputs(void) {
+  uint32_t state = 0x12345678u;
+  for (int i = 0; i < 2 * MAX_N; i++) {
+    in_a[i] = (float)(int32_t)next_random(&state) * (1.0f / 2147483648.0f);
+    in_i16[i] = (int16_t)(next_random(&state) >> 16);
+  }
+  for (int i = 0; i < MAX_N; i++) {
+    // Positive, for log
+    in_b[i] = 0.01f + (float)(next_random(&state) >> 8) * (1.0f / 16777216.0f);
+    in_c[i] = 1.0f;
+    out_f[i] = in_b[i];
+    in_i32[i] = (int32_t)next_random(&state);
+  }
+  for (int i = 0; i < 3 * MAX_N; i++)
+    in_i24[i] = (uint8_t)next_random(&state);
+}
+
+// --- Main ---
+
+static volatile float sink;
+
+// Seconds taken by that many back-to-back calls
+static double time_calls(const SimdKernels *k, KernelRun run, size_t n,
+                         long calls) {
+  double t0 = now_seconds();
+  float acc = 0.0f;
+  for (long c = 0; c < calls; c++)
+    acc += run(k, n);
+  sink = acc;
+  return now_seconds() - t0;
+}
+
+// Best time per call over repeats runs of about seconds each
+static double time_case(const SimdKernels *k, KernelRun run, size_t n,
+                        double seconds, int repeats, long *calls_out) {
+  // Double the call count until a run is long enough to scale from
+  long calls = 1;
+  double t;
+  while ((t = time_calls(k, run, n, calls)) < seconds / 8 &&
+         calls < (1L << 30))
+    calls *= 2;
+  if (t > 0)
+    calls = (long)(calls * (seconds / t)) + 1;
+
+  double best = 1e30;
+  for (int r = 0; r < repeats; r++) {
+    double per_call = time_calls(k, run, n, calls) / (double)calls;
+    if (per_call < best)
+      best = per_call;
+  }
+  *calls_out = calls;
+  return best;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-s seconds] [-r repeats] [-o out.tsv]\n"
+          "  -s SEC   Seconds per timed run (default: 0.05)\n"
+          "  -r N     Timed runs per case, best reported (default: 3)\n"
+          "  -o FILE  Write the TSV to FILE (default: stdout)\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  double seconds = 0.05;
+  int repeats = 3;
+  const char *out_path = NULL;
+  FILE *out = stdout;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      repeats = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (seconds <= 0.0 || repeats < 1) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (out_path) {
+    out = fopen(out_path, "w");
+    if (!out) {
+      fprintf(stderr, "Could not open output file %s\n", out_path);
+      return 1;
+    }
+  }
+
+  fill_inputs();
+  fprintf(out, "isa\tkernel\tn\tcalls\tns_per_call\tns_per_element\n");
+  for (int isa = SIMD_ISA_SCALAR; isa <= SIMD_ISA_AVX512; isa++) {
+    const SimdKernels *k = simd_get_kernels((SimdIsa)isa);
+    if (!k)
+      continue;
+    for (int j = 0; j < NUM_KERNELS; j++) {
+      for (int l = 0; l < NUM_LENGTHS; l++) {
+        long calls;
+        double t = time_case(k, kernels[j].run, lengths[l], seconds, repeats,
+                             &calls);
+        fprintf(out, "%s\t%s\t%zu\t%ld\t%.2f\t%.4f\n",
+                simd_isa_name((SimdIsa)isa), kernels[j].name, lengths[l],
+                calls, t * 1e9, t * 1e9 / (double)lengths[l]);
+        fflush(out);
+      }
+    }
+  }
+
+  if (out != stdout)
+    fclose(out);
+  return 0;
+}
@@ -0,0 +1,324 @@
+// bench_throughput - End-to-end throughput of the syllable detector
+//
+// Usage: bench_throughput [-a] [-s seconds] [-r repeats] [-o out.tsv]
+//
+// Runs the detector over deterministic synthetic signals and writes one TSV
+// row per case (header first) for tracking regressions across releases:
+//
+//   signal sample_rate block_size features samples seconds ns_per_sample
+//   realtime_factor events events_per_sec
+//
+// seconds is the best of the repeats (a fresh syllable_reset each time),
+// realtime_factor is processing time / audio duration (lower is faster), and
+// events_per_sec is events reported per second of processing.
+//
+// By default each axis is swept with the others at the reference point
+// (16 kHz, 256-sample blocks, default features): every feature-enable
+// combination, every sample rate and every block size, for every signal.
+// -a runs the full cross product instead.
+
+#include "syllable_detector.h"
+#include "test_signal.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+
+#define EVENT_BUFFER 256
+
+// --- Cases ---
+
+typedef enum {
+  SIGNAL_NOISE,
+  SIGNAL_VOWELS,
+  SIGNAL_CLICKS,
+  SIGNAL_SILENCE,
+  NUM_SIGNALS
+} SignalKind;
+
+static const char *signal_names[NUM_SIGNALS] = {"noise", "vowels", "clicks",
+                                                "silence"};
+
+static const int sample_rates[] = {8000, 16000, 44100, 48000};
+#define NUM_RATES (int)(sizeof(sample_rates) / sizeof(sample_rates[0]))
+
+static const int block_sizes[] = {32, 64, 128, 256, 512, 1024, 2048, 4096,
+                                  8192};
+#define NUM_BLOCKS (int)(sizeof(block_sizes) / sizeof(block_sizes[0]))
+
+// Feature enables of SyllableConfig, one bit each
+enum {
+  FEATURE_SPECTRAL_FLUX = 1 << 0,
+  FEATURE_HIGH_FREQ = 1 << 1,
+  FEATURE_MFCC = 1 << 2,
+  FEATURE_WAVELET = 1 << 3,
+  FEATURE_AGC = 1 << 4,
+  NUM_FEATURE_SETS = 1 << 5
+};
+
+static const char *feature_names[] = {"flux", "hfe", "mfcc", "wavelet", "agc"};
+
+#define REFERENCE_RATE 16000
+#define REFERENCE_BLOCK 256
+#define REFERENCE_FEATURES (NUM_FEATURE_SETS - 1) // The defaults: all enabled
+
+// --- Timing ---
+
+static double now_seconds(void) {
+#ifdef _WIN32
+  LARGE_INTEGER freq, count;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+// --- Synthetic Signals (test_signal.h: the same on every platform and run) ---
+
+// White noise at about -20 dBFS
+static void make_noise(float *x, int n, uint32_t *rng) {
+  for (int i = 0; i < n; i++)
+    x[i] = 0.17f * test_noise(rng);
+}
+
+// Syllable-like bursts: 180 ms harmonic vowels (F0 gliding around 100-220 Hz,
+// harmonics shaped by two formant peaks) separated by 90-160 ms of near
+// silence, with a raised-cosine envelope
+static void make_vowels(float *x, int n, int sr, uint32_t *rng) {
+  const int num_harmonics = 20;
+  int burst = (int)(0.18 * sr);
+  int i = 0;
+  double phase = 0.0;
+  while (i < n) {
+    int gap = (int)((0.09 + 0.07 * (test_random(rng) % 1000) / 1000.0) * sr);
+    for (int k = 0; k < gap && i < n; k++, i++)
+      x[i] = 0.001f * test_noise(rng);
+
+    double f0_start = 100.0 + 120.0 * (test_random(rng) % 1000) / 1000.0;
+    double f0_end =
+        f0_start * (0.85 + 0.3 * (test_random(rng) % 1000) / 1000.0);
+    double formant1 = 500.0 + 300.0 * (test_random(rng) % 1000) / 1000.0;
+    double formant2 = 1200.0 + 1000.0 * (test_random(rng) % 1000) / 1000.0;
+    float gain = 0.2f + 0.3f * (test_random(rng) % 1000) / 1000.0f;
+    for (int k = 0; k < burst && i < n; k++, i++) {
+      double t = (double)k / burst;
+      double f0 = f0_start + (f0_end - f0_start) * t;
+      phase += 2.0 * M_PI * f0 / sr;
+      double s = 0.0;
+      for (int h = 1; h <= num_harmonics && h * f0 < 0.45 * sr; h++) {
+        double fh = h * f0;
+        double d1 = (fh - formant1) / 120.0, d2 = (fh - formant2) / 180.0;
+        double a = exp(-0.5 * d1 * d1) + 0.5 * exp(-0.5 * d2 * d2) + 0.02;
+        s += a * sin(h * phase);
+      }
+      double env = 0.5 - 0.5 * cos(2.0 * M_PI * t);
+      x[i] = (float)(gain * env * s * 0.3);
+    }
+  }
+}
+
+// Plosive-like clicks: 8 ms exponentially decaying noise bursts every
+// 150-250 ms over a low noise floor
+static void make_clicks(float *x, int n, int sr, uint32_t *rng) {
+  int click = (int)(0.008 * sr);
+  int i = 0;
+  while (i < n) {
+    int gap = (int)((0.15 + 0.1 * (test_random(rng) % 1000) / 1000.0) * sr);
+    for (int k = 0; k < gap && i < n; k++, i++)
+      x[i] = 0.002f * test_noise(rng);
+    for (int k = 0; k < click && i < n; k++, i++) {
+      float decay = expf(-5.0f * k / click);
+      x[i] = 0.6f * decay * test_noise(rng);
+    }
+  }
+}
+
+static void make_signal(SignalKind kind, float *x, int n, int sr) {
+  uint32_t rng = 0x9E3779B9u + (uint32_t)kind;
+  switch (kind) {
+  case SIGNAL_NOISE:
+    make_noise(x, n, &rng);
+    break;
+  case SIGNAL_VOWELS:
+    make_vowels(x, n, sr, &rng);
+    break;
+  case SIGNAL_CLICKS:
+    make_clicks(x, n, sr, &rng);
+    break;
+  default:
+    memset(x, 0, n * sizeof(float));
+    break;
+  }
+}
+
+// --- Runner ---
+
+typedef struct {
+  double seconds_per_run;
+  int samples;
+  int repeats;
+  FILE *out;
+  SyllableEvent events[EVENT_BUFFER];
+} Bench;
+
+static void format_features(int set, char *buf, size_t len) {
+  buf[0] = '\0';
+  for (int f = 0; f < 5; f++) {
+    if (!(set & (1 << f)))
+      continue;
+    if (buf[0])
+      strncat(buf, "+", len - strlen(buf) - 1);
+    strncat(buf, feature_names[f], len - strlen(buf) - 1);
+  }
+  if (!buf[0])
+    strncat(buf, "none", len - 1);
+}
+
+static int run_case(Bench *b, const float *x, int n, SignalKind kind, int sr,
+                    int block, int features) {
+  SyllableConfig cfg = syllable_default_config(sr);
+  cfg.enable_spectral_flux = (features & FEATURE_SPECTRAL_FLUX) != 0;
+  cfg.enable_high_freq_energy = (features & FEATURE_HIGH_FREQ) != 0;
+  cfg.enable_mfcc_delta = (features & FEATURE_MFCC) != 0;
+  cfg.enable_wavelet = (features & FEATURE_WAVELET) != 0;
+  cfg.enable_agc = (features & FEATURE_AGC) != 0;
+
+  SyllableDetector *d = syllable_create(&cfg);
+  if (!d) {
+    fprintf(stderr, "Could not create a detector (%d Hz)\n", sr);
+    return -1;
+  }
+
+  double best = -1.0;
+  long long events = 0;
+  for (int r = 0; r < b->repeats; r++) {
+    syllable_reset(d);
+    long long count = 0;
+    double start = now_seconds();
+    for (int pos = 0; pos < n; pos += block) {
+      int len = n - pos < block ? n - pos : block;
+      count += syllable_process(d, x + pos, len, b->events, EVENT_BUFFER);
+    }
+    count += syllable_flush(d, b->events, EVENT_BUFFER);
+    double elapsed = now_seconds() - start;
+    if (best < 0.0 || elapsed < best)
+      best = elapsed;
+    events = count;
+  }
+  syllable_destroy(d);
+
+  char names[64];
+  format_features(features, names, sizeof(names));
+  double audio_seconds = (double)n / sr;
+  fprintf(b->out, "%s\t%d\t%d\t%s\t%d\t%.6f\t%.3f\t%.6f\t%lld\t%.1f\n",
+          signal_names[kind], sr, block, names, n, best, best * 1e9 / n,
+          best / audio_seconds, events, best > 0.0 ? events / best : 0.0);
+  fflush(b->out);
+  return 0;
+}
+
+// Every case for one signal at one sample rate
+static int run_rate(Bench *b, SignalKind kind, int sr, int all) {
+  int n = (int)(b->seconds_per_run * sr);
+  if (n < 1)
+    n = 1;
+  float *x = (float *)malloc(n * sizeof(float));
+  if (!x) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return -1;
+  }
+  make_signal(kind, x, n, sr);
+
+  int status = 0;
+  if (all) {
+    for (int f = 0; f < NUM_FEATURE_SETS && status == 0; f++)
+      for (int k = 0; k < NUM_BLOCKS && status == 0; k++)
+        status = run_case(b, x, n, kind, sr, block_sizes[k], f);
+  } else {
+    // Rate sweep point, then the feature and block sweeps at the reference
+    status = run_case(b, x, n, kind, sr, REFERENCE_BLOCK, REFERENCE_FEATURES);
+    if (sr == REFERENCE_RATE) {
+      for (int f = 0; f < NUM_FEATURE_SETS && status == 0; f++)
+        if (f != REFERENCE_FEATURES)
+          status = run_case(b, x, n, kind, sr, REFERENCE_BLOCK, f);
+      for (int k = 0; k < NUM_BLOCKS && status == 0; k++)
+        if (block_sizes[k] != REFERENCE_BLOCK)
+          status = run_case(b, x, n, kind, sr, block_sizes[k],
+                            REFERENCE_FEATURES);
+    }
+  }
+  free(x);
+  return status;
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-a] [-s seconds] [-r repeats] [-o out.tsv]\n"
+          "  -a       Full cross product of features, rates and blocks\n"
+          "  -s SEC   Seconds of audio per case (default: 10)\n"
+          "  -r N     Timed repeats per case, best reported (default: 3)\n"
+          "  -o FILE  Write the TSV to FILE (default: stdout)\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  Bench b;
+  b.seconds_per_run = 10.0;
+  b.repeats = 3;
+  b.out = stdout;
+  int all = 0;
+  const char *out_path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-a") == 0) {
+      all = 1;
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      b.seconds_per_run = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      b.repeats = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (b.seconds_per_run <= 0.0 || b.repeats < 1) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (out_path) {
+    b.out = fopen(out_path, "w");
+    if (!b.out) {
+      fprintf(stderr, "Could not open output file %s\n", out_path);
+      return 1;
+    }
+  }
+
+  fprintf(b.out, "signal\tsample_rate\tblock_size\tfeatures\tsamples\t"
+                 "seconds\tns_per_sample\trealtime_factor\tevents\t"
+                 "events_per_sec\n");
+
+  int status = 0;
+  for (int s = 0; s < NUM_SIGNALS && status == 0; s++)
+    for (int r = 0; r < NUM_RATES && status == 0; r++)
+      status = run_rate(&b, (SignalKind)s, sample_rates[r], all);
+
+  if (b.out != stdout)
+    fclose(b.out);
+  return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,673 @@
+// batch_wav - Run the syllable detector over a corpus of WAV files
+//
+// Usage: batch_wav [-j threads] [-o out_dir] [-l list.txt] [file|dir ...]
+//
+// Inputs are WAV files, directories (searched recursively for *.wav) and
+// list files with one path per line. Each file's events are written as TSV to
+// out_dir/<name>.tsv, or next to the input as <input>.tsv without -o. <name>
+// is the file's path below the directory argument it was found in (the
+// subdirectories are created under out_dir), or its base name if it was
+// given as a file. Inputs that would share an output file are refused.
+//
+// Scheduling: files are sorted longest first and dealt to per-worker queues.
+// A worker takes its own longest file, and once its queue is empty it steals
+// the longest file left in the fullest other queue, so the last files to start
+// are the short ones and no worker is left finishing a long file alone.
+// Each worker owns one detector, reused across files with syllable_reset
+// (recreated only when the sample rate changes), and streams its file through
+// a fixed-size buffer: memory in flight is bounded by the worker count, not
+// by the file sizes.
+
+#include "syllable_detector.h"
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHUNK_FRAMES 4096 // Frames read and processed per call
+#define MAX_CHANNELS 8
+#define EVENT_BUFFER 64
+
+typedef struct {
+  char *path;
+  const char *name; // Output name under out_dir: the tail of path
+  long long size;   // File size in bytes, the scheduling estimate of its length
+} Job;
+
+// Per-worker queue of job indices, longest first
+typedef struct {
+  pthread_mutex_t lock;
+  int *jobs;
+  int head;
+  int tail;
+  long long pending_bytes;
+} JobQueue;
+
+typedef struct Pool Pool;
+
+typedef struct {
+  int id;
+  Pool *pool;
+  JobQueue queue;
+
+  SyllableDetector *detector;
+  unsigned int detector_rate;
+  int16_t *pcm; // Interleaved frames
+  SyllableEvent events[EVENT_BUFFER];
+
+  // Stats
+  int files_done;
+  int files_failed;
+  int files_stolen;
+  double audio_seconds;
+  long long total_events;
+  double busy_seconds;
+} Worker;
+
+struct Pool {
+  Job *jobs;
+  int num_jobs;
+  Worker *workers;
+  int num_workers;
+  const char *out_dir;
+};
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// --- Job List ---
+
+typedef struct {
+  Job *items;
+  int count;
+  int capacity;
+} JobList;
+
+// Add a file; its output name starts name_offset characters into path
+static int job_list_add(JobList *list, const char *path, size_t name_offset) {
+  struct stat st;
+  if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+    fprintf(stderr, "Skipping %s: not a regular file\n", path);
+    return 0;
+  }
+  if (list->count == list->capacity) {
+    int capacity = list->capacity ? list->capacity * 2 : 256;
+    Job *items = (Job *)realloc(list->items, capacity * sizeof(Job));
+    if (!items)
+      return -1;
+    list->items = items;
+    list->capacity = capacity;
+  }
+  char *copy = (char *)malloc(strlen(path) + 1);
+  if (!copy)
+    return -1;
+  strcpy(copy, path);
+  list->items[list->count].path = copy;
+  list->items[list->count].name = copy + name_offset;
+  list->items[list->count].size = (long long)st.st_size;
+  list->count++;
+  return 0;
+}
+
+static int has_wav_extension(const char *name) {
+  size_t len = strlen(name);
+  if (len < 4)
+    return 0;
+  const char *ext = name + len - 4;
+  return ext[0] == '.' && (ext[1] | 0x20) == 'w' && (ext[2] | 0x20) == 'a' &&
+         (ext[3] | 0x20) == 'v';
+}
+
+// Add the WAV files below dir_path; root_len characters of their paths name
+// the directory argument
+static int job_list_add_dir(JobList *list, const char *dir_path,
+                            size_t root_len) {
+  DIR *dir = opendir(dir_path);
+  if (!dir) {
+    fprintf(stderr, "Could not open directory %s\n", dir_path);
+    return 0;
+  }
+  int status = 0;
+  struct dirent *entry;
+  while (status == 0 && (entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.')
+      continue;
+    size_t len = strlen(dir_path) + strlen(entry->d_name) + 2;
+    char *path = (char *)malloc(len);
+    if (!path) {
+      status = -1;
+      break;
+    }
+    snprintf(path, len, "%s/%s", dir_path, entry->d_name);
+
+    struct stat st;
+    if (stat(path, &st) == 0) {
+      if (S_ISDIR(st.st_mode))
+        status = job_list_add_dir(list, path, root_len);
+      else if (S_ISREG(st.st_mode) && has_wav_extension(entry->d_name))
+        status = job_list_add(list, path, root_len + 1);
+    }
+    free(path);
+  }
+  closedir(dir);
+  return status;
+}
+
+static int job_list_add_path(JobList *list, const char *path) {
+  struct stat st;
+  if (stat(path, &st) == 0 && S_ISDIR(st.st_mode))
+    return job_list_add_dir(list, path, strlen(path));
+  const char *slash = strrchr(path, '/');
+  return job_list_add(list, path, slash ? (size_t)(slash - path) + 1 : 0);
+}
+
+static int job_list_add_list_file(JobList *list, const char *list_path) {
+  FILE *fp = fopen(list_path, "r");
+  if (!fp) {
+    fprintf(stderr, "Could not open list file %s\n", list_path);
+    return -1;
+  }
+  int status = 0;
+  char line[4096];
+  while (status == 0 && fgets(line, sizeof(line), fp)) {
+    size_t len = strcspn(line, "\r\n");
+    line[len] = '\0';
+    if (len > 0 && line[0] != '#')
+      status = job_list_add_path(list, line);
+  }
+  fclose(fp);
+  return status;
+}
+
+// Output file of a job, relative to out_dir when there is one
+static const char *job_output_key(const Job *job, const char *out_dir) {
+  return out_dir ? job->name : job->path;
+}
+
+static const char *sort_out_dir;
+static int compare_output_keys(const void *a, const void *b) {
+  return strcmp(job_output_key(*(const Job *const *)a, sort_out_dir),
+                job_output_key(*(const Job *const *)b, sort_out_dir));
+}
+
+// Report inputs that would write the same event file; two workers would
+// truncate and write it at once. Returns the number of clashes, or -1 if
+// memory runs out.
+static int find_output_clashes(const JobList *list, const char *out_dir) {
+  const Job **sorted = (const Job **)malloc(list->count * sizeof(Job *));
+  if (!sorted)
+    return -1;
+  for (int j = 0; j < list->count; j++)
+    sorted[j] = &list->items[j];
+  sort_out_dir = out_dir;
+  qsort(sorted, list->count, sizeof(Job *), compare_output_keys);
+
+  int clashes = 0;
+  for (int j = 1; j < list->count; j++) {
+    if (compare_output_keys(&sorted[j - 1], &sorted[j]) == 0) {
+      fprintf(stderr, "%s and %s both write %s.tsv\n", sorted[j - 1]->path,
+              sorted[j]->path, job_output_key(sorted[j], out_dir));
+      clashes++;
+    }
+  }
+  free(sorted);
+  return clashes;
+}
+
+static int compare_jobs_longest_first(const void *a, const void *b) {
+  long long sa = ((const Job *)a)->size;
+  long long sb = ((const Job *)b)->size;
+  return (sa < sb) - (sa > sb);
+}
+
+// --- Scheduling ---
+
+// Take the longest job from the worker's own queue, or steal the longest job
+// left in the queue with the most pending work. Returns -1 when all are empty.
+static int next_job(Worker *w, int *stolen) {
+  Pool *pool = w->pool;
+  JobQueue *own = &w->queue;
+
+  pthread_mutex_lock(&own->lock);
+  int job = -1;
+  if (own->head < own->tail) {
+    job = own->jobs[own->head++];
+    own->pending_bytes -= pool->jobs[job].size;
+  }
+  pthread_mutex_unlock(&own->lock);
+  *stolen = 0;
+  if (job >= 0)
+    return job;
+
+  for (;;) {
+    // The victim may drain between the scan and the pop; then scan again
+    JobQueue *victim = NULL;
+    long long most = 0;
+    for (int i = 1; i < pool->num_workers; i++) {
+      JobQueue *q = &pool->workers[(w->id + i) % pool->num_workers].queue;
+      pthread_mutex_lock(&q->lock);
+      long long pending = q->head < q->tail ? q->pending_bytes + 1 : 0;
+      pthread_mutex_unlock(&q->lock);
+      if (pending > most) {
+        most = pending;
+        victim = q;
+      }
+    }
+    if (!victim)
+      return -1;
+
+    pthread_mutex_lock(&victim->lock);
+    if (victim->head < victim->tail) {
+      job = victim->jobs[victim->head++];
+      victim->pending_bytes -= pool->jobs[job].size;
+    }
+    pthread_mutex_unlock(&victim->lock);
+    if (job >= 0) {
+      *stolen = 1;
+      return job;
+    }
+  }
+}
+
+// --- WAV Input ---
+
+typedef struct {
+  FILE *fp;
+  unsigned int sample_rate;
+  unsigned short channels;
+  unsigned int frames_left;
+} WavReader;
+
+static int find_chunk(FILE *fp, const char *id, unsigned int *size) {
+  char chunk_id[4];
+  unsigned int chunk_size;
+
+  while (fread(chunk_id, 1, 4, fp) == 4) {
+    if (fread(&chunk_size, 4, 1, fp) != 1)
+      return 0;
+    if (memcmp(chunk_id, id, 4) == 0) {
+      *size = chunk_size;
+      return 1;
+    }
+    // Chunks are padded to an even size
+    if (fseek(fp, (long)chunk_size + (chunk_size & 1), SEEK_CUR) != 0)
+      return 0;
+  }
+  return 0;
+}
+
+// Open a 16-bit PCM WAV file. Returns 0 on success, or prints why not.
+static int wav_open(WavReader *r, const char *path) {
+  r->fp = fopen(path, "rb");
+  if (!r->fp) {
+    fprintf(stderr, "%s: could not open\n", path);
+    return -1;
+  }
+
+  char riff[4], wave[4];
+  unsigned int riff_size, fmt_size, data_size;
+  unsigned short format, bits_per_sample, block_align;
+  unsigned int byte_rate;
+  const char *error = NULL;
+
+  if (fread(riff, 1, 4, r->fp) != 4 || fread(&riff_size, 4, 1, r->fp) != 1 ||
+      fread(wave, 1, 4, r->fp) != 4 || memcmp(riff, "RIFF", 4) != 0 ||
+      memcmp(wave, "WAVE", 4) != 0)
+    error = "not a WAV file";
+  else if (!find_chunk(r->fp, "fmt ", &fmt_size) || fmt_size < 16)
+    error = "no fmt chunk";
+  else if (fread(&format, 2, 1, r->fp) != 1 ||
+           fread(&r->channels, 2, 1, r->fp) != 1 ||
+           fread(&r->sample_rate, 4, 1, r->fp) != 1 ||
+           fread(&byte_rate, 4, 1, r->fp) != 1 ||
+           fread(&block_align, 2, 1, r->fp) != 1 ||
+           fread(&bits_per_sample, 2, 1, r->fp) != 1)
+    error = "truncated fmt chunk";
+  else if ((format != 1 && format != 0xFFFE) || bits_per_sample != 16)
+    error = "only 16-bit PCM is supported";
+  else if (r->channels < 1 || r->channels > MAX_CHANNELS ||
+           block_align != 2 * r->channels || r->sample_rate == 0)
+    error = "unsupported channel layout";
+  else if (fseek(r->fp, (long)(fmt_size - 16) + (fmt_size & 1), SEEK_CUR) !=
+               0 ||
+           !find_chunk(r->fp, "data", &data_size))
+    error = "no data chunk";
+
+  if (error) {
+    fprintf(stderr, "%s: %s\n", path, error);
+    fclose(r->fp);
+    r->fp = NULL;
+    return -1;
+  }
+  r->frames_left = data_size / block_align;
+  return 0;
+}
+
+// Read up to max_frames interleaved frames. Returns the count.
+static int wav_read(WavReader *r, int16_t *pcm, int max_frames) {
+  int want = r->frames_left < (unsigned int)max_frames ? (int)r->frames_left
+                                                       : max_frames;
+  int got = (int)fread(pcm, 2 * r->channels, want, r->fp);
+  r->frames_left = got < want ? 0 : r->frames_left - got;
+  return got;
+}
+
+// --- Event Output ---
+
+// Create the directories leading to the file at path (modified in place and
+// restored). Several workers may create the same ones at once.
+static int make_parent_dirs(char *path) {
+  for (char *p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+    *p = '\0';
+    int failed = mkdir(path, 0777) != 0 && errno != EEXIST;
+    *p = '/';
+    if (failed)
+      return -1;
+  }
+  return 0;
+}
+
+static FILE *open_event_file(const Pool *pool, const Job *job) {
+  const char *name = pool->out_dir ? job->name : job->path;
+
+  size_t len = strlen(name) + 5;
+  if (pool->out_dir)
+    len += strlen(pool->out_dir) + 1;
+  char *path = (char *)malloc(len);
+  if (!path)
+    return NULL;
+  if (pool->out_dir)
+    snprintf(path, len, "%s/%s.tsv", pool->out_dir, name);
+  else
+    snprintf(path, len, "%s.tsv", name);
+
+  FILE *fp = NULL;
+  if (!pool->out_dir || make_parent_dirs(path) == 0)
+    fp = fopen(path, "w");
+  if (!fp)
+    fprintf(stderr, "Could not open output file %s\n", path);
+  free(path);
+  if (fp)
+    fprintf(fp, "time\tpeak_rate\tspectral_flux\thigh_freq_energy\t"
+                "mfcc_delta\twavelet\tfusion\tf0\tdelta_f0\tprominence\t"
+                "type\taccented\n");
+  return fp;
+}
+
+static void write_events(FILE *fp, const SyllableEvent *events, int count) {
+  static const char *onset_type_names[] = {"V", "U", "M"};
+  for (int i = 0; i < count; i++) {
+    const SyllableEvent *e = &events[i];
+    fprintf(fp, "%.4f\t%.5f\t%.5f\t%.5f\t%.5f\t%.5f\t%.4f\t%.1f\t%.1f\t%.4f\t"
+                "%s\t%d\n",
+            e->time_seconds, e->peak_rate, e->spectral_flux,
+            e->high_freq_energy, e->mfcc_delta, e->wavelet_score,
+            e->fusion_score, e->f0, e->delta_f0, e->prominence_score,
+            onset_type_names[e->onset_type], e->is_accented);
+  }
+}
+
+// --- Worker ---
+
+static SyllableConfig make_config(unsigned int sample_rate) {
+  SyllableConfig config = syllable_default_config((int)sample_rate);
+  const char *threshold_env = getenv("SYLLABLE_THRESHOLD");
+  if (threshold_env && threshold_env[0] != '\0')
+    config.threshold_peak_rate = (float)atof(threshold_env);
+  const char *adaptive_k_env = getenv("SYLLABLE_ADAPT_K");
+  if (adaptive_k_env && adaptive_k_env[0] != '\0')
+    config.adaptive_peak_rate_k = (float)atof(adaptive_k_env);
+  const char *adaptive_tau_env = getenv("SYLLABLE_ADAPT_TAU_MS");
+  if (adaptive_tau_env && adaptive_tau_env[0] != '\0')
+    config.adaptive_peak_rate_tau_ms = (float)atof(adaptive_tau_env);
+  const char *voiced_hold_env = getenv("SYLLABLE_VOICED_HOLD_MS");
+  if (voiced_hold_env && voiced_hold_env[0] != '\0')
+    config.voiced_hold_ms = (float)atof(voiced_hold_env);
+  return config;
+}
+
+// Reuse the worker's detector for this sample rate, or create one
+static SyllableDetector *acquire_detector(Worker *w, unsigned int rate) {
+  if (w->detector && w->detector_rate == rate) {
+    syllable_reset(w->detector);
+    return w->detector;
+  }
+  if (w->detector)
+    syllable_destroy(w->detector);
+  SyllableConfig config = make_config(rate);
+  w->detector = syllable_create(&config);
+  w->detector_rate = w->detector ? rate : 0;
+  return w->detector;
+}
+
+static int process_file(Worker *w, const Job *job) {
+  const char *path = job->path;
+  WavReader reader;
+  if (wav_open(&reader, path) != 0)
+    return -1;
+
+  SyllableDetector *det = acquire_detector(w, reader.sample_rate);
+  FILE *out = det ? open_event_file(w->pool, job) : NULL;
+  if (!out) {
+    if (!det)
+      fprintf(stderr, "%s: could not create detector\n", path);
+    fclose(reader.fp);
+    return -1;
+  }
+
+  long long frames = 0;
+  long long events = 0;
+  int n;
+  while ((n = wav_read(&reader, w->pcm, CHUNK_FRAMES)) > 0) {
+    frames += n;
+    // Multi-channel files are analyzed as their mono mix, as in process_wav.
+    // Events that do not fit stay queued in the detector until the next call.
+    int count = syllable_process_i16_interleaved(
+        det, w->pcm, n, reader.channels, -1, w->events, EVENT_BUFFER);
+    write_events(out, w->events, count);
+    events += count;
+  }
+  int count;
+  while ((count = syllable_flush(det, w->events, EVENT_BUFFER)) > 0) {
+    write_events(out, w->events, count);
+    events += count;
+  }
+
+  int failed = ferror(reader.fp) != 0;
+  fclose(reader.fp);
+  if (fclose(out) != 0 || failed) {
+    fprintf(stderr, "%s: I/O error\n", path);
+    return -1;
+  }
+
+  w->audio_seconds += (double)frames / reader.sample_rate;
+  w->total_events += events;
+  return 0;
+}
+
+static void *worker_main(void *arg) {
+  Worker *w = (Worker *)arg;
+  int job, stolen;
+  while ((job = next_job(w, &stolen)) >= 0) {
+    double start = now_seconds();
+    if (process_file(w, &w->pool->jobs[job]) == 0)
+      w->files_done++;
+    else
+      w->files_failed++;
+    w->files_stolen += stolen;
+    w->busy_seconds += now_seconds() - start;
+  }
+  return NULL;
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-j threads] [-o out_dir] [-l list.txt] [file|dir ...]\n"
+          "  -j N     Worker threads (default: online CPUs)\n"
+          "  -o DIR   Write <name>.tsv event files to DIR, mirroring input "
+          "subdirectories (default: next to each input)\n"
+          "  -l FILE  Read input paths from FILE, one per line\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  int num_workers = 0;
+  const char *out_dir = NULL;
+  JobList list = {NULL, 0, 0};
+
+  for (int i = 1; i < argc; i++) {
+    int status = 0;
+    if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      num_workers = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_dir = argv[++i];
+    } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+      status = job_list_add_list_file(&list, argv[++i]);
+    } else if (argv[i][0] == '-') {
+      usage(argv[0]);
+      return 1;
+    } else {
+      status = job_list_add_path(&list, argv[i]);
+    }
+    if (status != 0) {
+      fprintf(stderr, "Could not build the file list\n");
+      return 1;
+    }
+  }
+  if (list.count == 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  int clashes = find_output_clashes(&list, out_dir);
+  if (clashes != 0) {
+    fprintf(stderr, clashes < 0 ? "Memory allocation failed.\n"
+                                : "Refusing to overwrite event files\n");
+    return 1;
+  }
+
+  if (num_workers <= 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    num_workers = cpus > 0 ? (int)cpus : 1;
+  }
+  if (num_workers > list.count)
+    num_workers = list.count;
+
+  qsort(list.items, list.count, sizeof(Job), compare_jobs_longest_first);
+
+  Pool pool;
+  pool.jobs = list.items;
+  pool.num_jobs = list.count;
+  pool.num_workers = num_workers;
+  pool.out_dir = out_dir;
+  pool.workers = (Worker *)calloc(num_workers, sizeof(Worker));
+  int *queue_storage = (int *)malloc(list.count * sizeof(int));
+  if (!pool.workers || !queue_storage) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return 1;
+  }
+
+  // Deal the sorted jobs in snake order (0..W-1, W-1..0, ...) so each queue
+  // starts with a similar amount of work, longest first
+  int per_worker = (list.count + num_workers - 1) / num_workers;
+  int next_slot = 0;
+  for (int i = 0; i < num_workers; i++) {
+    Worker *w = &pool.workers[i];
+    w->id = i;
+    w->pool = &pool;
+    pthread_mutex_init(&w->queue.lock, NULL);
+    w->queue.jobs = queue_storage + next_slot;
+    next_slot += per_worker;
+    w->pcm =
+        (int16_t *)malloc(CHUNK_FRAMES * MAX_CHANNELS * sizeof(int16_t));
+    if (!w->pcm) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      return 1;
+    }
+  }
+  for (int j = 0; j < list.count; j++) {
+    int round = j / num_workers;
+    int pos = j % num_workers;
+    JobQueue *q = &pool.workers[round & 1 ? num_workers - 1 - pos : pos].queue;
+    q->jobs[q->tail++] = j;
+    q->pending_bytes += list.items[j].size;
+  }
+
+  printf("Processing %d files on %d threads\n", list.count, num_workers);
+
+  double start = now_seconds();
+  pthread_t *threads = (pthread_t *)malloc(num_workers * sizeof(pthread_t));
+  if (!threads) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return 1;
+  }
+  int started = 0;
+  for (; started < num_workers; started++) {
+    if (pthread_create(&threads[started], NULL, worker_main,
+                       &pool.workers[started]) != 0)
+      break;
+  }
+  if (started == 0) {
+    // No threads available: run the whole pool on this one
+    for (int i = 0; i < num_workers; i++)
+      worker_main(&pool.workers[i]);
+  }
+  for (int i = 0; i < started; i++)
+    pthread_join(threads[i], NULL);
+  double wall = now_seconds() - start;
+
+  // Report
+  int done = 0, failed = 0, stolen = 0;
+  long long events = 0;
+  double audio_seconds = 0.0, busy = 0.0;
+  for (int i = 0; i < num_workers; i++) {
+    Worker *w = &pool.workers[i];
+    done += w->files_done;
+    failed += w->files_failed;
+    stolen += w->files_stolen;
+    events += w->total_events;
+    audio_seconds += w->audio_seconds;
+    busy += w->busy_seconds;
+  }
+
+  printf("\n=== Batch Summary ===\n");
+  printf("Files: %d processed, %d failed, %d stolen\n", done, failed, stolen);
+  printf("Events: %lld\n", events);
+  printf("Audio: %.1f s in %.2f s wall\n", audio_seconds, wall);
+  if (wall > 0.0) {
+    printf("Throughput: %.1f files/s, %.1fx real time\n", done / wall,
+           audio_seconds / wall);
+    printf("Worker utilization: %.0f%%\n",
+           100.0 * busy / (wall * num_workers));
+  }
+  if (audio_seconds > 0.0)
+    printf("Real-time factor: %.5f (wall), %.5f (per thread)\n",
+           wall / audio_seconds, busy / audio_seconds);
+
+  for (int i = 0; i < num_workers; i++) {
+    Worker *w = &pool.workers[i];
+    if (w->detector)
+      syllable_destroy(w->detector);
+    pthread_mutex_destroy(&w->queue.lock);
+    free(w->pcm);
+  }
+  for (int j = 0; j < list.count; j++)
+    free(list.items[j].path);
+  free(list.items);
+  free(queue_storage);
+  free(threads);
+  free(pool.workers);
+
+  return failed ? 2 : 0;
+}
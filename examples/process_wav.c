@@ -1,9 +1,26 @@
 #include "syllable_detector.h"
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Frames per syllable_process call
+#define CHUNK_FRAMES 1024
+
+// Mapped pages already processed are dropped every this many bytes, so the
+// resident size stays constant however long the file is
+#define RELEASE_INTERVAL_BYTES (8u << 20)
+
 // Minimal WAV header for output (standard 44-byte PCM)
 #pragma pack(push, 1)
 typedef struct {
@@ -23,25 +40,246 @@ typedef struct {
 } WavHeaderOut;
 #pragma pack(pop)
 
-// Helper to find a chunk in WAV file
-static int find_chunk(FILE *fp, const char *id, unsigned int *size) {
-  char chunk_id[4];
-  unsigned int chunk_size;
+// --- Memory-Mapped Input ---
 
-  while (fread(chunk_id, 1, 4, fp) == 4) {
-    if (fread(&chunk_size, 4, 1, fp) != 1)
-      return 0;
+// Read-only view of a whole file
+typedef struct {
+  const unsigned char *data;
+  size_t size;
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#endif
+} MappedFile;
+
+static int map_file(const char *path, MappedFile *m) {
+  memset(m, 0, sizeof(*m));
+#ifdef _WIN32
+  m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (m->file == INVALID_HANDLE_VALUE)
+    return 0;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m->file, &size) || size.QuadPart == 0) {
+    CloseHandle(m->file);
+    return 0;
+  }
+  m->mapping = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!m->mapping) {
+    CloseHandle(m->file);
+    return 0;
+  }
+  m->data = (const unsigned char *)MapViewOfFile(m->mapping, FILE_MAP_READ, 0,
+                                                 0, 0);
+  if (!m->data) {
+    CloseHandle(m->mapping);
+    CloseHandle(m->file);
+    return 0;
+  }
+  m->size = (size_t)size.QuadPart;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return 0;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return 0;
+  }
+  void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps the file open
+  if (data == MAP_FAILED)
+    return 0;
+  // Read ahead aggressively and drop pages behind the reader
+  madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+  m->data = (const unsigned char *)data;
+  m->size = (size_t)st.st_size;
+#endif
+  return 1;
+}
+
+// Drop the mapped pages wholly before offset from the resident set (they
+// are faulted back in from the file if read again)
+static void release_mapped(const MappedFile *m, size_t offset) {
+#ifdef _WIN32
+  (void)m;
+  (void)offset;
+#else
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t len = offset / page * page;
+  if (len > 0)
+    madvise((void *)m->data, len, MADV_DONTNEED);
+#endif
+}
 
-    if (memcmp(chunk_id, id, 4) == 0) {
+static void unmap_file(MappedFile *m) {
+#ifdef _WIN32
+  UnmapViewOfFile(m->data);
+  CloseHandle(m->mapping);
+  CloseHandle(m->file);
+#else
+  munmap((void *)m->data, m->size);
+#endif
+  m->data = NULL;
+}
+
+// --- RIFF Parsing (in place) ---
+
+static unsigned int read_u16(const unsigned char *p) {
+  return p[0] | (unsigned int)p[1] << 8;
+}
+
+static unsigned int read_u32(const unsigned char *p) {
+  return p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 |
+         (unsigned int)p[3] << 24;
+}
+
+// Find a chunk of a RIFF file, searching from offset pos. Returns the offset
+// of its payload (0 if absent) and its size in *size.
+static size_t find_chunk(const MappedFile *m, size_t pos, const char *id,
+                         unsigned int *size) {
+  while (pos + 8 <= m->size) {
+    unsigned int chunk_size = read_u32(m->data + pos + 4);
+    if (memcmp(m->data + pos, id, 4) == 0) {
       *size = chunk_size;
-      return 1;
+      return pos + 8;
     }
-    // Skip this chunk
-    fseek(fp, chunk_size, SEEK_CUR);
+    // Chunks are padded to an even size
+    pos += 8 + (size_t)chunk_size + (chunk_size & 1);
   }
   return 0;
 }
 
+// --- Output ---
+
+// One accent beep, centered on the syllable onset
+typedef struct {
+  int64_t start; // First frame
+} Beep;
+
+// Copy the 16-bit input (data chunk at offset data of the mapping) to a WAV
+// file with a 1 kHz beep mixed in at every accented syllable, one chunk at a
+// time
+static void write_output(const char *path, const MappedFile *in, size_t data,
+                         int num_frames, int channels, unsigned int sample_rate,
+                         const Beep *beeps, int num_beeps) {
+  const short *pcm = (const short *)(in->data + data);
+  size_t released = 0;
+  FILE *out_fp = fopen(path, "wb");
+  if (!out_fp) {
+    printf("Could not open output file %s\n", path);
+    return;
+  }
+
+  // Build standard 44-byte WAV header
+  WavHeaderOut hdr;
+  memcpy(hdr.riff, "RIFF", 4);
+  hdr.file_size = 36 + num_frames * channels * sizeof(short);
+  memcpy(hdr.wave, "WAVE", 4);
+  memcpy(hdr.fmt_marker, "fmt ", 4);
+  hdr.fmt_size = 16;
+  hdr.format = 1;
+  hdr.channels = channels;
+  hdr.sample_rate = sample_rate;
+  hdr.byte_rate = sample_rate * channels * sizeof(short);
+  hdr.block_align = channels * sizeof(short);
+  hdr.bits_per_sample = 16;
+  memcpy(hdr.data_marker, "data", 4);
+  hdr.data_size = num_frames * channels * sizeof(short);
+  fwrite(&hdr, sizeof(WavHeaderOut), 1, out_fp);
+
+  int beep_len = sample_rate / 20; // 50ms
+  short *chunk = (short *)malloc(CHUNK_FRAMES * channels * sizeof(short));
+  if (!chunk) {
+    fclose(out_fp);
+    return;
+  }
+
+  int first_beep = 0; // Beeps are in time order
+  for (int i = 0; i < num_frames; i += CHUNK_FRAMES) {
+    int n = (num_frames - i < CHUNK_FRAMES) ? (num_frames - i) : CHUNK_FRAMES;
+    memcpy(chunk, pcm + (size_t)i * channels, n * channels * sizeof(short));
+
+    while (first_beep < num_beeps && beeps[first_beep].start + beep_len <= i)
+      first_beep++;
+    for (int b = first_beep; b < num_beeps && beeps[b].start < i + n; b++) {
+      for (int k = 0; k < beep_len; k++) {
+        int64_t pos = beeps[b].start + k;
+        if (pos < i || pos >= i + n)
+          continue;
+        float val = 0.5f * sinf(2.0f * 3.14159f * 1000.0f * k / sample_rate);
+        short *frame = &chunk[(pos - i) * channels];
+        for (int c = 0; c < channels; c++) {
+          float mixed = frame[c] / 32768.0f + val;
+          if (mixed > 1.0f)
+            mixed = 1.0f;
+          if (mixed < -1.0f)
+            mixed = -1.0f;
+          frame[c] = (short)(mixed * 32767.0f);
+        }
+      }
+    }
+
+    fwrite(chunk, sizeof(short), (size_t)n * channels, out_fp);
+
+    size_t consumed = data + ((size_t)i + n) * channels * sizeof(short);
+    if (consumed - released >= RELEASE_INTERVAL_BYTES) {
+      release_mapped(in, consumed);
+      released = consumed;
+    }
+  }
+
+  free(chunk);
+  fclose(out_fp);
+  printf("Written result to %s (%d frames)\n", path, num_frames);
+}
+
+// --- Main ---
+
+static void print_event(const SyllableEvent *e) {
+  // Voiced, Unvoiced, Mixed
+  static const char *onset_type_names[] = {"V", "U", "M"};
+  printf(
+      "%-8.3f %-6.3f %-6.3f %-6.3f %-6.3f %-6.3f %-6.2f %-6.1f %-6.1f %-6.2f "
+      "%-5s %s\n",
+      e->time_seconds, e->peak_rate, e->spectral_flux, e->high_freq_energy,
+      e->mfcc_delta, e->wavelet_score, e->fusion_score, e->f0, e->delta_f0,
+      e->prominence_score, onset_type_names[e->onset_type],
+      e->is_accented ? "*" : "");
+}
+
+// Where the accent beeps go, collected by the event callback
+typedef struct {
+  unsigned int sample_rate;
+  int keep_beeps; // Only with an output file
+  Beep *beeps;
+  int num_beeps;
+  int capacity;
+  int ok; // 0 once the beep list could not grow
+} BeepList;
+
+// Event callback: print each event as soon as it is complete and remember
+// where its accent beep goes
+static void on_event(void *user_data, const SyllableEvent *e) {
+  BeepList *list = (BeepList *)user_data;
+  print_event(e);
+  if (!list->keep_beeps || !e->is_accented || !list->ok)
+    return;
+  if (list->num_beeps == list->capacity) {
+    int capacity = list->capacity ? 2 * list->capacity : 256;
+    Beep *grown = (Beep *)realloc(list->beeps, capacity * sizeof(Beep));
+    if (!grown) {
+      list->ok = 0;
+      return;
+    }
+    list->beeps = grown;
+    list->capacity = capacity;
+  }
+  int64_t pos = (int64_t)(e->time_seconds * list->sample_rate);
+  list->beeps[list->num_beeps++].start =
+      pos - (int64_t)(list->sample_rate / 20) / 2;
+}
+
 int main(int argc, char **argv) {
   if (argc < 2) {
     printf("Usage: %s <input.wav> [output.wav]\n", argv[0]);
@@ -51,47 +289,35 @@ int main(int argc, char **argv) {
   const char *input_filename = argv[1];
   const char *output_filename = (argc >= 3) ? argv[2] : NULL;
 
-  FILE *in_fp = fopen(input_filename, "rb");
-  if (!in_fp) {
+  // The file is mapped, not read: detection starts on the first page and
+  // memory use does not depend on the file length
+  MappedFile in;
+  if (!map_file(input_filename, &in)) {
     printf("Could not open input file %s\n", input_filename);
     return 1;
   }
 
   // Read RIFF header
-  char riff[4], wave[4];
-  unsigned int riff_size;
-  fread(riff, 1, 4, in_fp);
-  fread(&riff_size, 4, 1, in_fp);
-  fread(wave, 1, 4, in_fp);
-
-  if (memcmp(riff, "RIFF", 4) != 0 || memcmp(wave, "WAVE", 4) != 0) {
+  if (in.size < 12 || memcmp(in.data, "RIFF", 4) != 0 ||
+      memcmp(in.data + 8, "WAVE", 4) != 0) {
     printf("Not a valid WAV file\n");
-    fclose(in_fp);
+    unmap_file(&in);
     return 1;
   }
 
   // Find fmt chunk
   unsigned int fmt_size;
-  if (!find_chunk(in_fp, "fmt ", &fmt_size)) {
+  size_t fmt = find_chunk(&in, 12, "fmt ", &fmt_size);
+  if (!fmt || fmt_size < 16 || fmt + 16 > in.size) {
     printf("Could not find fmt chunk\n");
-    fclose(in_fp);
+    unmap_file(&in);
     return 1;
   }
 
-  unsigned short format, channels, bits_per_sample, block_align;
-  unsigned int sample_rate, byte_rate;
-
-  fread(&format, 2, 1, in_fp);
-  fread(&channels, 2, 1, in_fp);
-  fread(&sample_rate, 4, 1, in_fp);
-  fread(&byte_rate, 4, 1, in_fp);
-  fread(&block_align, 2, 1, in_fp);
-  fread(&bits_per_sample, 2, 1, in_fp);
-
-  // Skip rest of fmt chunk if larger than 16 bytes
-  if (fmt_size > 16) {
-    fseek(in_fp, fmt_size - 16, SEEK_CUR);
-  }
+  unsigned short format = read_u16(in.data + fmt);
+  unsigned short channels = read_u16(in.data + fmt + 2);
+  unsigned int sample_rate = read_u32(in.data + fmt + 4);
+  unsigned short bits_per_sample = read_u16(in.data + fmt + 14);
 
   printf("Processing %s\n", input_filename);
   printf("Sample Rate: %u\n", sample_rate);
@@ -99,48 +325,44 @@ int main(int argc, char **argv) {
   printf("Bits: %hu\n", bits_per_sample);
   printf("Format: %hu (1=PCM)\n", format);
 
-  if (channels != 1) {
-    printf("Warning: Only mono supported.\n");
+  if (channels < 1) {
+    printf("Invalid channel count\n");
+    unmap_file(&in);
+    return 1;
+  }
+  if (channels > 1) {
+    printf("Analyzing the mean of all channels.\n");
+  }
+  if (format != 1 ||
+      (bits_per_sample != 16 && bits_per_sample != 24 &&
+       bits_per_sample != 32)) {
+    printf("Only 16/24/32-bit integer PCM is supported.\n");
+    unmap_file(&in);
+    return 1;
   }
-  if (bits_per_sample != 16) {
-    printf("Warning: Only 16-bit supported.\n");
+  if (output_filename && bits_per_sample != 16) {
+    printf("Warning: Output is only written for 16-bit input.\n");
+    output_filename = NULL;
   }
 
   // Find data chunk
   unsigned int data_size;
-  if (!find_chunk(in_fp, "data", &data_size)) {
+  size_t data = find_chunk(&in, 12, "data", &data_size);
+  if (!data) {
     printf("Could not find data chunk\n");
-    fclose(in_fp);
-    return 1;
-  }
-
-  int num_samples = data_size / sizeof(short);
-  printf("Data size: %u bytes (%d samples)\n", data_size, num_samples);
-
-  short *pcm_data = (short *)malloc(data_size);
-  if (!pcm_data) {
-    printf("Memory allocation failed.\n");
-    fclose(in_fp);
+    unmap_file(&in);
     return 1;
   }
 
-  size_t read_count = fread(pcm_data, sizeof(short), num_samples, in_fp);
-  fclose(in_fp);
-
-  if (read_count != num_samples) {
-    printf("Warning: Expected %d samples but read %zu\n", num_samples,
-           read_count);
-    num_samples = (int)read_count;
-  }
+  int frame_bytes = channels * (bits_per_sample / 8);
+  int num_frames = data_size / frame_bytes;
+  printf("Data size: %u bytes (%d frames)\n", data_size, num_frames);
 
-  // Convert to float
-  float *float_data = (float *)malloc(num_samples * sizeof(float));
-  if (!float_data) {
-    free(pcm_data);
-    return 1;
-  }
-  for (int i = 0; i < num_samples; i++) {
-    float_data[i] = pcm_data[i] / 32768.0f;
+  size_t available = (in.size - data) / frame_bytes;
+  if ((size_t)num_frames > available) {
+    printf("Warning: Expected %d frames but the file holds %zu\n", num_frames,
+           available);
+    num_frames = (int)available;
   }
 
   // Config
@@ -166,44 +388,10 @@ int main(int argc, char **argv) {
   SyllableDetector *detector = syllable_create(&config);
   if (!detector) {
     printf("Failed to create detector.\n");
-    free(pcm_data);
-    free(float_data);
+    unmap_file(&in);
     return 1;
   }
 
-  // Store all events
-  int max_total_events = 2000;
-  SyllableEvent *all_events =
-      (SyllableEvent *)malloc(max_total_events * sizeof(SyllableEvent));
-  int total_event_count = 0;
-
-  // Process in chunks
-  int chunk_size = 1024;
-  SyllableEvent buffer_events[64];
-
-  for (int i = 0; i < num_samples; i += chunk_size) {
-    int n = (num_samples - i < chunk_size) ? (num_samples - i) : chunk_size;
-    int count =
-        syllable_process(detector, &float_data[i], n, buffer_events, 64);
-    for (int k = 0; k < count; k++) {
-      if (total_event_count < max_total_events) {
-        all_events[total_event_count++] = buffer_events[k];
-      }
-    }
-  }
-
-  int count_flush = syllable_flush(detector, buffer_events, 64);
-  for (int k = 0; k < count_flush; k++) {
-    if (total_event_count < max_total_events) {
-      all_events[total_event_count++] = buffer_events[k];
-    }
-  }
-
-  syllable_destroy(detector);
-
-  // Print and mix pulses
-  const char *onset_type_names[] = {"V", "U", "M"}; // Voiced, Unvoiced, Mixed
-
   printf("\n=== Detected Syllables ===\n");
   printf("%-8s %-6s %-6s %-6s %-6s %-6s %-6s %-6s %-6s %-6s %-5s %-4s\n",
          "Time", "Peak", "SF", "HFE", "MFCC", "Wav", "Fuse", "F0", "dF0",
@@ -211,73 +399,47 @@ int main(int argc, char **argv) {
   printf("---------------------------------------------------------------------"
          "------------\n");
 
-  for (int i = 0; i < total_event_count; i++) {
-    printf(
-        "%-8.3f %-6.3f %-6.3f %-6.3f %-6.3f %-6.3f %-6.2f %-6.1f %-6.1f %-6.2f "
-        "%-5s %s\n",
-        all_events[i].time_seconds, all_events[i].peak_rate,
-        all_events[i].spectral_flux, all_events[i].high_freq_energy,
-        all_events[i].mfcc_delta, all_events[i].wavelet_score,
-        all_events[i].fusion_score, all_events[i].f0, all_events[i].delta_f0,
-        all_events[i].prominence_score,
-        onset_type_names[all_events[i].onset_type],
-        all_events[i].is_accented ? "*" : "");
-
-    if (output_filename && all_events[i].is_accented) {
-      int pos = (int)(all_events[i].time_seconds * sample_rate);
-      int beep_len = sample_rate / 20;    // 50ms
-      int start_pos = pos - beep_len / 2; // Center beep on timestamp
-      for (int k = 0; k < beep_len; k++) {
-        if (start_pos + k >= 0 && start_pos + k < num_samples) {
-          float val = 0.5f * sinf(2.0f * 3.14159f * 1000.0f * k / sample_rate);
-          float_data[start_pos + k] += val;
-          if (float_data[start_pos + k] > 1.0f)
-            float_data[start_pos + k] = 1.0f;
-          if (float_data[start_pos + k] < -1.0f)
-            float_data[start_pos + k] = -1.0f;
-        }
-      }
+  // Feed the detector straight from the mapped PCM. Events are printed by
+  // the callback as they complete; only the accent positions are kept, for
+  // the output beeps.
+  BeepList list = {sample_rate, output_filename != NULL, NULL, 0, 0, 1};
+  syllable_set_event_callback(detector, on_event, &list);
+  const unsigned char *pcm = in.data + data;
+  size_t released = 0;
+
+  for (int i = 0; i < num_frames && list.ok; i += CHUNK_FRAMES) {
+    int n = (num_frames - i < CHUNK_FRAMES) ? (num_frames - i) : CHUNK_FRAMES;
+    const unsigned char *chunk = pcm + (size_t)i * frame_bytes;
+    if (bits_per_sample == 16)
+      syllable_process_i16_interleaved(detector, (const int16_t *)chunk, n,
+                                       channels, -1, NULL, 0);
+    else if (bits_per_sample == 24)
+      syllable_process_i24_interleaved(detector, chunk, n, channels, -1, NULL,
+                                       0);
+    else
+      syllable_process_i32_interleaved(detector, (const int32_t *)chunk, n,
+                                       channels, -1, NULL, 0);
+
+    size_t consumed = data + ((size_t)i + n) * frame_bytes;
+    if (consumed - released >= RELEASE_INTERVAL_BYTES) {
+      release_mapped(&in, consumed);
+      released = consumed;
     }
   }
 
-  // Write output
-  if (output_filename) {
-    FILE *out_fp = fopen(output_filename, "wb");
-    if (!out_fp) {
-      printf("Could not open output file %s\n", output_filename);
-    } else {
-      // Convert back to short
-      for (int i = 0; i < num_samples; i++) {
-        pcm_data[i] = (short)(float_data[i] * 32767.0f);
-      }
+  syllable_flush(detector, NULL, 0);
+  syllable_destroy(detector);
 
-      // Build standard 44-byte WAV header
-      WavHeaderOut hdr;
-      memcpy(hdr.riff, "RIFF", 4);
-      hdr.file_size = 36 + num_samples * sizeof(short);
-      memcpy(hdr.wave, "WAVE", 4);
-      memcpy(hdr.fmt_marker, "fmt ", 4);
-      hdr.fmt_size = 16;
-      hdr.format = 1;
-      hdr.channels = 1;
-      hdr.sample_rate = sample_rate;
-      hdr.byte_rate = sample_rate * sizeof(short);
-      hdr.block_align = sizeof(short);
-      hdr.bits_per_sample = 16;
-      memcpy(hdr.data_marker, "data", 4);
-      hdr.data_size = num_samples * sizeof(short);
-
-      fwrite(&hdr, sizeof(WavHeaderOut), 1, out_fp);
-      fwrite(pcm_data, sizeof(short), num_samples, out_fp);
-      fclose(out_fp);
-      printf("Written result to %s (%d samples)\n", output_filename,
-             num_samples);
-    }
+  // Write output
+  if (!list.ok) {
+    printf("Memory allocation failed.\n");
+  } else if (output_filename) {
+    write_output(output_filename, &in, data, num_frames, channels,
+                 sample_rate, list.beeps, list.num_beeps);
   }
 
-  free(pcm_data);
-  free(float_data);
-  free(all_events);
+  free(list.beeps);
+  unmap_file(&in);
 
-  return 0;
+  return list.ok ? 0 : 1;
 }
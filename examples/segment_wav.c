@@ -0,0 +1,432 @@
+// segment_wav - Analyze one long WAV file as parallel segments
+//
+// Usage: segment_wav [-j threads] [-s segments] [-p preroll_ms] [-c]
+//                    [-o events.tsv] input.wav
+//
+// The file is split into equal segments, each analyzed by its own detector on
+// a worker thread (syllable_process_segment, with a warm-up pre-roll before
+// every segment), and the segment events are stitched into one list
+// (syllable_stitch_segments). With -c the file is also run through a single
+// detector and the divergence of the stitched events from it is reported.
+
+#include "syllable_detector.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MATCH_TOLERANCE_MS 5.0 // Onsets this close count as the same syllable
+
+typedef struct {
+  uint64_t start;
+  uint64_t end;
+  SyllableEvent *events;
+  int capacity;
+  int count;
+} Segment;
+
+typedef struct {
+  const SyllableConfig *config;
+  const float *audio;
+  uint64_t num_samples;
+  float preroll_ms;
+  Segment *segments;
+  int num_segments;
+  int first; // This worker runs segments first, first + stride, ...
+  int stride;
+  int running; // Started on its own thread
+  int failed;
+} Worker;
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// --- WAV Input ---
+
+static int find_chunk(FILE *fp, const char *id, unsigned int *size) {
+  char chunk_id[4];
+  unsigned int chunk_size;
+
+  while (fread(chunk_id, 1, 4, fp) == 4) {
+    if (fread(&chunk_size, 4, 1, fp) != 1)
+      return 0;
+    if (memcmp(chunk_id, id, 4) == 0) {
+      *size = chunk_size;
+      return 1;
+    }
+    // Chunks are padded to an even size
+    if (fseek(fp, (long)chunk_size + (chunk_size & 1), SEEK_CUR) != 0)
+      return 0;
+  }
+  return 0;
+}
+
+// Load a 16-bit PCM WAV file as float, keeping the first channel
+static float *load_wav(const char *path, uint64_t *num_samples,
+                       unsigned int *sample_rate) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    printf("Could not open input file %s\n", path);
+    return NULL;
+  }
+
+  char riff[4], wave[4];
+  unsigned int riff_size, fmt_size, data_size, byte_rate;
+  unsigned short format, channels, block_align, bits_per_sample;
+  const char *error = NULL;
+
+  if (fread(riff, 1, 4, fp) != 4 || fread(&riff_size, 4, 1, fp) != 1 ||
+      fread(wave, 1, 4, fp) != 4 || memcmp(riff, "RIFF", 4) != 0 ||
+      memcmp(wave, "WAVE", 4) != 0)
+    error = "Not a valid WAV file";
+  else if (!find_chunk(fp, "fmt ", &fmt_size) || fmt_size < 16 ||
+           fread(&format, 2, 1, fp) != 1 || fread(&channels, 2, 1, fp) != 1 ||
+           fread(sample_rate, 4, 1, fp) != 1 ||
+           fread(&byte_rate, 4, 1, fp) != 1 ||
+           fread(&block_align, 2, 1, fp) != 1 ||
+           fread(&bits_per_sample, 2, 1, fp) != 1)
+    error = "Could not read fmt chunk";
+  else if ((format != 1 && format != 0xFFFE) || bits_per_sample != 16 ||
+           channels < 1 || block_align != 2 * channels)
+    error = "Only 16-bit PCM is supported";
+  else if (fseek(fp, (long)(fmt_size - 16) + (fmt_size & 1), SEEK_CUR) != 0 ||
+           !find_chunk(fp, "data", &data_size))
+    error = "Could not find data chunk";
+
+  float *audio = NULL;
+  if (!error) {
+    uint64_t frames = data_size / block_align;
+    short pcm[4096];
+    int per_read = 4096 / channels;
+    audio = (float *)malloc((frames ? frames : 1) * sizeof(float));
+    if (!audio)
+      error = "Memory allocation failed";
+    uint64_t got = 0;
+    while (audio && got < frames) {
+      size_t want = frames - got < (uint64_t)per_read ? (size_t)(frames - got)
+                                                      : (size_t)per_read;
+      size_t n = fread(pcm, block_align, want, fp);
+      for (size_t i = 0; i < n; i++)
+        audio[got + i] = pcm[i * channels] / 32768.0f;
+      got += n;
+      if (n < want)
+        break;
+    }
+    *num_samples = got;
+  }
+  fclose(fp);
+
+  if (error) {
+    printf("%s: %s\n", path, error);
+    free(audio);
+    return NULL;
+  }
+  return audio;
+}
+
+// --- Segment Workers ---
+
+static void *worker_main(void *arg) {
+  Worker *w = (Worker *)arg;
+  SyllableDetector *detector = syllable_create(w->config);
+  if (!detector) {
+    w->failed = 1;
+    return NULL;
+  }
+  for (int i = w->first; i < w->num_segments; i += w->stride) {
+    Segment *seg = &w->segments[i];
+    seg->count = syllable_process_segment(
+        detector, w->audio, w->num_samples, seg->start, seg->end,
+        w->preroll_ms, seg->events, seg->capacity);
+  }
+  syllable_destroy(detector);
+  return NULL;
+}
+
+// Single-detector reference run
+static int run_sequential(const SyllableConfig *config, const float *audio,
+                          uint64_t num_samples, SyllableEvent *events,
+                          int capacity) {
+  SyllableDetector *detector = syllable_create(config);
+  if (!detector)
+    return -1;
+
+  int count = 0;
+  SyllableEvent chunk[64];
+  for (uint64_t pos = 0; pos < num_samples; pos += 4096) {
+    int n = num_samples - pos < 4096 ? (int)(num_samples - pos) : 4096;
+    int got = syllable_process(detector, audio + pos, n, chunk, 64);
+    for (int k = 0; k < got && count < capacity; k++)
+      events[count++] = chunk[k];
+  }
+  int got;
+  while ((got = syllable_flush(detector, chunk, 64)) > 0) {
+    for (int k = 0; k < got && count < capacity; k++)
+      events[count++] = chunk[k];
+  }
+  syllable_destroy(detector);
+  return count;
+}
+
+// --- Divergence Report ---
+
+static void report_divergence(const SyllableEvent *seq, int seq_count,
+                              const SyllableEvent *par, int par_count,
+                              const Segment *segments, int num_segments,
+                              unsigned int sample_rate) {
+  uint64_t tolerance = (uint64_t)(MATCH_TOLERANCE_MS * 0.001 * sample_rate);
+  int exact = 0, matched = 0, missing = 0, extra = 0;
+  int accent_diff = 0, near_boundary = 0;
+  double max_dt = 0.0, max_prominence_diff = 0.0, max_fusion_diff = 0.0;
+
+  int i = 0, j = 0;
+  while (i < seq_count || j < par_count) {
+    uint64_t ts = i < seq_count ? seq[i].timestamp_samples : UINT64_MAX;
+    uint64_t tp = j < par_count ? par[j].timestamp_samples : UINT64_MAX;
+    uint64_t dt = ts > tp ? ts - tp : tp - ts;
+
+    if (i < seq_count && j < par_count && dt <= tolerance) {
+      matched++;
+      exact += dt == 0;
+      if ((double)dt / sample_rate > max_dt)
+        max_dt = (double)dt / sample_rate;
+      double dp = fabs(seq[i].prominence_score - par[j].prominence_score);
+      double df = fabs(seq[i].fusion_score - par[j].fusion_score);
+      if (dp > max_prominence_diff)
+        max_prominence_diff = dp;
+      if (df > max_fusion_diff)
+        max_fusion_diff = df;
+      accent_diff += seq[i].is_accented != par[j].is_accented;
+      i++;
+      j++;
+      continue;
+    }
+
+    // Unmatched onset: report it with its distance to the nearest boundary
+    int is_missing = ts < tp;
+    uint64_t t = is_missing ? ts : tp;
+    uint64_t nearest = UINT64_MAX;
+    for (int s = 1; s < num_segments; s++) {
+      uint64_t b = segments[s].start;
+      uint64_t d = t > b ? t - b : b - t;
+      if (d < nearest)
+        nearest = d;
+    }
+    if (nearest <= (uint64_t)sample_rate)
+      near_boundary++;
+    if (missing + extra < 10)
+      printf("  %s onset at %.3f s (%.3f s from a boundary)\n",
+             is_missing ? "missing" : "extra  ", (double)t / sample_rate,
+             nearest == UINT64_MAX ? 0.0 : (double)nearest / sample_rate);
+    if (is_missing) {
+      missing++;
+      i++;
+    } else {
+      extra++;
+      j++;
+    }
+  }
+
+  printf("\n=== Divergence from Sequential ===\n");
+  printf("Events: %d sequential, %d segmented\n", seq_count, par_count);
+  printf("Matched: %d (%d exact, tolerance %.1f ms, max offset %.2f ms)\n",
+         matched, exact, MATCH_TOLERANCE_MS, max_dt * 1000.0);
+  printf("Missing: %d, extra: %d (%d within 1 s of a boundary)\n", missing,
+         extra, near_boundary);
+  printf("Accent disagreements: %d\n", accent_diff);
+  printf("Max |prominence diff|: %.5f, max |fusion diff|: %.5f\n",
+         max_prominence_diff, max_fusion_diff);
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+  printf("Usage: %s [-j threads] [-s segments] [-p preroll_ms] [-c] "
+         "[-o events.tsv] input.wav\n"
+         "  -j N   Worker threads (default: online CPUs)\n"
+         "  -s N   Segments (default: one per thread)\n"
+         "  -p MS  Warm-up pre-roll per segment (default: from config)\n"
+         "  -c     Compare with a single-detector run\n"
+         "  -o F   Write the stitched events as TSV\n",
+         prog);
+}
+
+int main(int argc, char **argv) {
+  int num_threads = 0, num_segments = 0, compare = 0;
+  float preroll_ms = -1.0f;
+  const char *input = NULL, *output = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+      num_threads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+      num_segments = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+      preroll_ms = (float)atof(argv[++i]);
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      output = argv[++i];
+    else if (strcmp(argv[i], "-c") == 0)
+      compare = 1;
+    else if (argv[i][0] != '-' && !input)
+      input = argv[i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (!input) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  uint64_t num_samples = 0;
+  unsigned int sample_rate = 0;
+  float *audio = load_wav(input, &num_samples, &sample_rate);
+  if (!audio)
+    return 1;
+
+  if (num_threads <= 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = cpus > 0 ? (int)cpus : 1;
+  }
+  if (num_segments <= 0)
+    num_segments = num_threads;
+  if ((uint64_t)num_segments > num_samples / sample_rate + 1)
+    num_segments = (int)(num_samples / sample_rate + 1); // At least ~1 s each
+  if (num_threads > num_segments)
+    num_threads = num_segments;
+
+  SyllableConfig config = syllable_default_config((int)sample_rate);
+  if (preroll_ms < 0.0f)
+    preroll_ms = syllable_default_preroll_ms(&config);
+
+  printf("Processing %s: %.1f s at %u Hz\n", input,
+         (double)num_samples / sample_rate, sample_rate);
+  printf("Segments: %d on %d threads, pre-roll %.0f ms\n", num_segments,
+         num_threads, preroll_ms);
+
+  // One event array per segment, sized for the densest possible syllable rate
+  uint64_t min_dist =
+      (uint64_t)(config.min_syllable_dist_ms * 0.001f * sample_rate) + 1;
+  Segment *segments = (Segment *)calloc(num_segments, sizeof(Segment));
+  Worker *workers = (Worker *)calloc(num_threads, sizeof(Worker));
+  pthread_t *threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+  if (!segments || !workers || !threads) {
+    printf("Memory allocation failed.\n");
+    return 1;
+  }
+  int total_capacity = 0;
+  for (int s = 0; s < num_segments; s++) {
+    Segment *seg = &segments[s];
+    seg->start = num_samples * s / num_segments;
+    seg->end = num_samples * (s + 1) / num_segments;
+    seg->capacity = (int)((seg->end - seg->start) / min_dist) + 16;
+    seg->events =
+        (SyllableEvent *)malloc(seg->capacity * sizeof(SyllableEvent));
+    if (!seg->events) {
+      printf("Memory allocation failed.\n");
+      return 1;
+    }
+    total_capacity += seg->capacity;
+  }
+
+  double start = now_seconds();
+  for (int t = 0; t < num_threads; t++) {
+    Worker *w = &workers[t];
+    w->config = &config;
+    w->audio = audio;
+    w->num_samples = num_samples;
+    w->preroll_ms = preroll_ms;
+    w->segments = segments;
+    w->num_segments = num_segments;
+    w->first = t;
+    w->stride = num_threads;
+    w->running = pthread_create(&threads[t], NULL, worker_main, w) == 0;
+    if (!w->running)
+      worker_main(w); // Run this share on the main thread instead
+  }
+  for (int t = 0; t < num_threads; t++) {
+    if (workers[t].running)
+      pthread_join(threads[t], NULL);
+  }
+
+  // Concatenate in segment order and stitch
+  SyllableEvent *events =
+      (SyllableEvent *)malloc(total_capacity * sizeof(SyllableEvent));
+  if (!events) {
+    printf("Memory allocation failed.\n");
+    return 1;
+  }
+  int raw_count = 0;
+  for (int s = 0; s < num_segments; s++) {
+    memcpy(events + raw_count, segments[s].events,
+           segments[s].count * sizeof(SyllableEvent));
+    raw_count += segments[s].count;
+  }
+  int count = syllable_stitch_segments(&config, events, raw_count);
+  double parallel_time = now_seconds() - start;
+
+  for (int t = 0; t < num_threads; t++) {
+    if (workers[t].failed) {
+      printf("Failed to create detector.\n");
+      return 1;
+    }
+  }
+
+  printf("Events: %d (%d before stitching)\n", count, raw_count);
+  printf("Segmented: %.3f s, %.1fx real time\n", parallel_time,
+         (double)num_samples / sample_rate / parallel_time);
+
+  if (output) {
+    FILE *fp = fopen(output, "w");
+    if (!fp) {
+      printf("Could not open output file %s\n", output);
+    } else {
+      static const char *onset_type_names[] = {"V", "U", "M"};
+      fprintf(fp, "time\tpeak_rate\tfusion\tf0\tdelta_f0\tprominence\ttype\t"
+                  "accented\n");
+      for (int i = 0; i < count; i++)
+        fprintf(fp, "%.4f\t%.5f\t%.4f\t%.1f\t%.1f\t%.4f\t%s\t%d\n",
+                events[i].time_seconds, events[i].peak_rate,
+                events[i].fusion_score, events[i].f0, events[i].delta_f0,
+                events[i].prominence_score,
+                onset_type_names[events[i].onset_type],
+                events[i].is_accented);
+      fclose(fp);
+    }
+  }
+
+  if (compare) {
+    SyllableEvent *seq =
+        (SyllableEvent *)malloc(total_capacity * sizeof(SyllableEvent));
+    double seq_start = now_seconds();
+    int seq_count =
+        seq ? run_sequential(&config, audio, num_samples, seq, total_capacity)
+            : -1;
+    double seq_time = now_seconds() - seq_start;
+    if (seq_count < 0) {
+      printf("Sequential run failed.\n");
+    } else {
+      printf("Sequential: %.3f s (speedup %.2fx)\n", seq_time,
+             seq_time / parallel_time);
+      report_divergence(seq, seq_count, events, count, segments, num_segments,
+                        sample_rate);
+    }
+    free(seq);
+  }
+
+  for (int s = 0; s < num_segments; s++)
+    free(segments[s].events);
+  free(segments);
+  free(workers);
+  free(threads);
+  free(events);
+  free(audio);
+  return 0;
+}
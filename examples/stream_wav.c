@@ -0,0 +1,379 @@
+// stream_wav - Run a WAV file through the realtime streaming API
+//
+// Usage: stream_wav [-b frames] [-q queue_ms] [-x speed] [-c]
+//                   [-o events.tsv] input.wav
+//
+// Three threads play the roles of a realtime application: an "audio
+// callback" thread hands the file to syllable_push in periods of a fixed
+// size, paced like a sound card, a worker thread drains the queue with
+// syllable_pump, and the main thread collects events with
+// syllable_pop_events. Reports the time spent in the callback, the stream
+// counters and, with -c, whether the events match a plain syllable_process
+// run (they do unless samples were dropped).
+
+#include "syllable_detector.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define EVENT_CHUNK 64
+
+typedef struct {
+  SyllableDetector *detector;
+  const float *audio;
+  uint64_t num_samples;
+  unsigned int sample_rate;
+  int period;   // Frames per callback
+  double speed; // Playback speed (0: as fast as possible)
+
+  // Callback timing
+  double push_max_s;
+  double push_total_s;
+  uint64_t callbacks;
+
+  int done;     // Set by the callback thread after its last period
+  int finished; // Set by the worker thread after syllable_flush
+
+  // Events syllable_flush returns on the worker thread at the end
+  SyllableEvent tail[EVENT_CHUNK * 4];
+  int tail_count;
+} Stream;
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void sleep_until(double t) {
+  struct timespec ts;
+  ts.tv_sec = (time_t)t;
+  ts.tv_nsec = (long)((t - (double)ts.tv_sec) * 1e9);
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+// --- WAV Input ---
+
+static int find_chunk(FILE *fp, const char *id, unsigned int *size) {
+  char chunk_id[4];
+  unsigned int chunk_size;
+
+  while (fread(chunk_id, 1, 4, fp) == 4) {
+    if (fread(&chunk_size, 4, 1, fp) != 1)
+      return 0;
+    if (memcmp(chunk_id, id, 4) == 0) {
+      *size = chunk_size;
+      return 1;
+    }
+    // Chunks are padded to an even size
+    if (fseek(fp, (long)chunk_size + (chunk_size & 1), SEEK_CUR) != 0)
+      return 0;
+  }
+  return 0;
+}
+
+// Load a 16-bit PCM WAV file as float, keeping the first channel
+static float *load_wav(const char *path, uint64_t *num_samples,
+                       unsigned int *sample_rate) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    printf("Could not open input file %s\n", path);
+    return NULL;
+  }
+
+  char riff[4], wave[4];
+  unsigned int riff_size, fmt_size, data_size, byte_rate;
+  unsigned short format, channels, block_align, bits_per_sample;
+  const char *error = NULL;
+
+  if (fread(riff, 1, 4, fp) != 4 || fread(&riff_size, 4, 1, fp) != 1 ||
+      fread(wave, 1, 4, fp) != 4 || memcmp(riff, "RIFF", 4) != 0 ||
+      memcmp(wave, "WAVE", 4) != 0)
+    error = "Not a valid WAV file";
+  else if (!find_chunk(fp, "fmt ", &fmt_size) || fmt_size < 16 ||
+           fread(&format, 2, 1, fp) != 1 || fread(&channels, 2, 1, fp) != 1 ||
+           fread(sample_rate, 4, 1, fp) != 1 ||
+           fread(&byte_rate, 4, 1, fp) != 1 ||
+           fread(&block_align, 2, 1, fp) != 1 ||
+           fread(&bits_per_sample, 2, 1, fp) != 1)
+    error = "Could not read fmt chunk";
+  else if ((format != 1 && format != 0xFFFE) || bits_per_sample != 16 ||
+           channels < 1 || block_align != 2 * channels)
+    error = "Only 16-bit PCM is supported";
+  else if (fseek(fp, (long)(fmt_size - 16) + (fmt_size & 1), SEEK_CUR) != 0 ||
+           !find_chunk(fp, "data", &data_size))
+    error = "Could not find data chunk";
+
+  float *audio = NULL;
+  if (!error) {
+    uint64_t frames = data_size / block_align;
+    short pcm[4096];
+    int per_read = 4096 / channels;
+    audio = (float *)malloc((frames ? frames : 1) * sizeof(float));
+    if (!audio)
+      error = "Memory allocation failed";
+    uint64_t got = 0;
+    while (audio && got < frames) {
+      size_t want = frames - got < (uint64_t)per_read ? (size_t)(frames - got)
+                                                      : (size_t)per_read;
+      size_t n = fread(pcm, block_align, want, fp);
+      for (size_t i = 0; i < n; i++)
+        audio[got + i] = pcm[i * channels] / 32768.0f;
+      got += n;
+      if (n < want)
+        break;
+    }
+    *num_samples = got;
+  }
+  fclose(fp);
+
+  if (error) {
+    printf("%s: %s\n", path, error);
+    free(audio);
+    return NULL;
+  }
+  return audio;
+}
+
+// --- Threads ---
+
+// The "sound card": one period every period / sample_rate seconds
+static void *callback_main(void *arg) {
+  Stream *s = (Stream *)arg;
+  double interval = s->speed > 0.0 ? s->period / (s->sample_rate * s->speed)
+                                   : 0.0;
+  double next = now_seconds();
+
+  for (uint64_t pos = 0; pos < s->num_samples; pos += s->period) {
+    if (interval > 0.0) {
+      next += interval;
+      sleep_until(next);
+    }
+    int n = s->num_samples - pos < (uint64_t)s->period
+                ? (int)(s->num_samples - pos)
+                : s->period;
+
+    double t0 = now_seconds();
+    syllable_push(s->detector, s->audio + pos, n);
+    double t = now_seconds() - t0;
+
+    s->push_total_s += t;
+    if (t > s->push_max_s)
+      s->push_max_s = t;
+    s->callbacks++;
+  }
+  __atomic_store_n(&s->done, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+// Drain the queue, resting 1 ms whenever it runs dry
+static void *worker_main(void *arg) {
+  Stream *s = (Stream *)arg;
+  for (;;) {
+    int done = __atomic_load_n(&s->done, __ATOMIC_ACQUIRE);
+    if (syllable_pump(s->detector, 0) > 0)
+      continue;
+    if (done)
+      break;
+    sleep_until(now_seconds() + 0.001);
+  }
+  // Everything is in: flush the syllables still awaiting context
+  s->tail_count = syllable_flush(s->detector, s->tail,
+                                 (int)(sizeof(s->tail) / sizeof(s->tail[0])));
+  __atomic_store_n(&s->finished, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+// Plain offline run, for -c
+static int run_offline(const SyllableConfig *config, const float *audio,
+                       uint64_t num_samples, SyllableEvent *events,
+                       int capacity) {
+  SyllableDetector *detector = syllable_create(config);
+  if (!detector)
+    return -1;
+
+  int count = 0;
+  SyllableEvent chunk[EVENT_CHUNK];
+  for (uint64_t pos = 0; pos < num_samples; pos += 4096) {
+    int n = num_samples - pos < 4096 ? (int)(num_samples - pos) : 4096;
+    int got = syllable_process(detector, audio + pos, n, chunk, EVENT_CHUNK);
+    for (int k = 0; k < got && count < capacity; k++)
+      events[count++] = chunk[k];
+  }
+  int got;
+  while ((got = syllable_flush(detector, chunk, EVENT_CHUNK)) > 0) {
+    for (int k = 0; k < got && count < capacity; k++)
+      events[count++] = chunk[k];
+  }
+  syllable_destroy(detector);
+  return count;
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+  printf("Usage: %s [-b frames] [-q queue_ms] [-x speed] [-c] "
+         "[-o events.tsv] input.wav\n"
+         "  -b N   Frames per audio callback (default: 256)\n"
+         "  -q MS  Audio queue length (default: 500)\n"
+         "  -x X   Playback speed, 0 for as fast as possible (default: 1)\n"
+         "  -c     Compare with a plain syllable_process run\n"
+         "  -o F   Write the events as TSV\n",
+         prog);
+}
+
+int main(int argc, char **argv) {
+  int period = 256, compare = 0;
+  float queue_ms = 500.0f;
+  double speed = 1.0;
+  const char *input = NULL, *output = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+      period = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-q") == 0 && i + 1 < argc)
+      queue_ms = (float)atof(argv[++i]);
+    else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+      speed = atof(argv[++i]);
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      output = argv[++i];
+    else if (strcmp(argv[i], "-c") == 0)
+      compare = 1;
+    else if (argv[i][0] != '-' && !input)
+      input = argv[i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (!input || period < 1 || queue_ms <= 0.0f || speed < 0.0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  uint64_t num_samples = 0;
+  unsigned int sample_rate = 0;
+  float *audio = load_wav(input, &num_samples, &sample_rate);
+  if (!audio)
+    return 1;
+
+  SyllableConfig config = syllable_default_config((int)sample_rate);
+  config.stream_buffer_ms = queue_ms;
+
+  // Sized for the densest possible syllable rate
+  uint64_t min_dist =
+      (uint64_t)(config.min_syllable_dist_ms * 0.001f * sample_rate) + 1;
+  int capacity = (int)(num_samples / min_dist) + 16;
+  SyllableEvent *events =
+      (SyllableEvent *)malloc(capacity * sizeof(SyllableEvent));
+  Stream *s = (Stream *)calloc(1, sizeof(Stream));
+  if (!events || !s) {
+    printf("Memory allocation failed.\n");
+    return 1;
+  }
+  s->detector = syllable_create(&config);
+  if (!s->detector) {
+    printf("Failed to create detector.\n");
+    return 1;
+  }
+  s->audio = audio;
+  s->num_samples = num_samples;
+  s->sample_rate = sample_rate;
+  s->period = period;
+  s->speed = speed;
+
+  printf("Streaming %s: %.1f s at %u Hz, %d-frame periods, %.0f ms queue\n",
+         input, (double)num_samples / sample_rate, sample_rate, period,
+         queue_ms);
+
+  double start = now_seconds();
+  pthread_t callback_thread, worker_thread;
+  if (pthread_create(&worker_thread, NULL, worker_main, s) != 0 ||
+      pthread_create(&callback_thread, NULL, callback_main, s) != 0) {
+    printf("Could not start threads.\n");
+    return 1;
+  }
+
+  // Collect events as they are published, until the worker has finished
+  int count = 0;
+  int finished = 0;
+  SyllableEvent chunk[EVENT_CHUNK];
+  while (!finished) {
+    finished = __atomic_load_n(&s->finished, __ATOMIC_ACQUIRE);
+    int got;
+    while ((got = syllable_pop_events(s->detector, chunk, EVENT_CHUNK)) > 0) {
+      for (int k = 0; k < got && count < capacity; k++)
+        events[count++] = chunk[k];
+    }
+    if (!finished)
+      sleep_until(now_seconds() + 0.01);
+  }
+  pthread_join(callback_thread, NULL);
+  pthread_join(worker_thread, NULL);
+  for (int k = 0; k < s->tail_count && count < capacity; k++)
+    events[count++] = s->tail[k];
+  double elapsed = now_seconds() - start;
+
+  SyllableStreamStats stats;
+  syllable_get_stream_stats(s->detector, &stats);
+  printf("Events: %d in %.3f s (%.1fx real time)\n", count, elapsed,
+         (double)num_samples / sample_rate / elapsed);
+  printf("Callback: %llu calls, push mean %.2f us, max %.2f us\n",
+         (unsigned long long)s->callbacks,
+         s->callbacks ? s->push_total_s / s->callbacks * 1e6 : 0.0,
+         s->push_max_s * 1e6);
+  printf("Queue: %llu pushed, %llu processed, peak %llu samples "
+         "(%.1f ms)\n",
+         (unsigned long long)stats.samples_pushed,
+         (unsigned long long)stats.samples_processed,
+         (unsigned long long)stats.peak_fill,
+         stats.peak_fill * 1000.0 / sample_rate);
+  printf("Overruns: %llu samples, underruns: %llu pumps, events dropped: "
+         "%llu\n",
+         (unsigned long long)stats.overruns,
+         (unsigned long long)stats.underruns,
+         (unsigned long long)stats.events_dropped);
+
+  if (output) {
+    FILE *fp = fopen(output, "w");
+    if (!fp) {
+      printf("Could not open output file %s\n", output);
+    } else {
+      static const char *onset_type_names[] = {"V", "U", "M"};
+      fprintf(fp, "time\tpeak_rate\tfusion\tf0\tdelta_f0\tprominence\ttype\t"
+                  "accented\n");
+      for (int i = 0; i < count; i++)
+        fprintf(fp, "%.4f\t%.5f\t%.4f\t%.1f\t%.1f\t%.4f\t%s\t%d\n",
+                events[i].time_seconds, events[i].peak_rate,
+                events[i].fusion_score, events[i].f0, events[i].delta_f0,
+                events[i].prominence_score,
+                onset_type_names[events[i].onset_type],
+                events[i].is_accented);
+      fclose(fp);
+    }
+  }
+
+  if (compare) {
+    SyllableEvent *ref =
+        (SyllableEvent *)malloc(capacity * sizeof(SyllableEvent));
+    int ref_count =
+        ref ? run_offline(&config, audio, num_samples, ref, capacity) : -1;
+    if (ref_count < 0)
+      printf("Offline run failed.\n");
+    else
+      printf("Offline: %d events, %s\n", ref_count,
+             ref_count == count &&
+                     memcmp(ref, events, count * sizeof(SyllableEvent)) == 0
+                 ? "identical"
+                 : "different");
+    free(ref);
+  }
+
+  syllable_destroy(s->detector);
+  free(s);
+  free(events);
+  free(audio);
+  return 0;
+}
@@ -21,10 +21,18 @@ echo Building Wasm...
     ..\..\src\syllable_detector.c ^
     ..\..\src\dsp\agc.c ^
     ..\..\src\dsp\biquad.c ^
+    ..\..\src\dsp\decimator.c ^
     ..\..\src\dsp\envelope.c ^
     ..\..\src\dsp\high_freq_energy.c ^
     ..\..\src\dsp\mfcc.c ^
+    ..\..\src\dsp\resampler.c ^
+    ..\..\src\dsp\running_median.c ^
+    ..\..\src\dsp\simd_dispatch.c ^
+    ..\..\src\dsp\simd_kernels_baseline.c ^
+    ..\..\src\dsp\simd_kernels_scalar.c ^
     ..\..\src\dsp\spectral_flux.c ^
+    ..\..\src\dsp\spsc_ring.c ^
+    ..\..\src\dsp\stft.c ^
     ..\..\src\dsp\wavelet.c ^
     ..\..\src\dsp\zff.c ^
     ..\..\extern\kissfft\kiss_fft.c ^
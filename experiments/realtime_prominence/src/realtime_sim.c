@@ -143,6 +143,11 @@ int main(int argc, char *argv[]) {
     fclose(fp);
     return 1;
   }
+  if (header.num_channels < 1 || header.num_channels > 2) {
+    fprintf(stderr, "Only mono and stereo are supported\n");
+    fclose(fp);
+    return 1;
+  }
 
   printf("\n");
   printf("========================================================\n");
@@ -194,34 +199,30 @@ int main(int argc, char *argv[]) {
   int chunk_delay_ms = (int)(1000.0 * CHUNK_SIZE / header.sample_rate / speed);
 
   while (!feof(fp)) {
-    /* Read chunk */
+    /* Read and process chunk */
     size_t samples_read;
+    int num_events;
     if (header.bits_per_sample == 16) {
       samples_read = fread(raw_buffer, sizeof(int16_t) * header.num_channels,
                            CHUNK_SIZE, fp);
-      /* Convert to float, mono */
-      for (size_t i = 0; i < samples_read; i++) {
-        if (header.num_channels == 2) {
-          buffer[i] = (raw_buffer[i * 2] + raw_buffer[i * 2 + 1]) / 65536.0f;
-        } else {
-          buffer[i] = raw_buffer[i] / 32768.0f;
-        }
-      }
+      if (samples_read == 0)
+        break;
+      /* Mono mix of the PCM, converted inside the detector */
+      num_events = syllable_process_i16_interleaved(
+          detector, raw_buffer, (int)samples_read, header.num_channels, -1,
+          events, MAX_EVENTS);
     } else if (header.bits_per_sample == 32) {
       /* Assume float */
       samples_read = fread(buffer, sizeof(float), CHUNK_SIZE, fp);
+      if (samples_read == 0)
+        break;
+      num_events = syllable_process(detector, buffer, (int)samples_read,
+                                    events, MAX_EVENTS);
     } else {
       fprintf(stderr, "Unsupported bit depth: %d\n", header.bits_per_sample);
       break;
     }
 
-    if (samples_read == 0)
-      break;
-
-    /* Process */
-    int num_events = syllable_process(detector, buffer, (int)samples_read,
-                                      events, MAX_EVENTS);
-
     /* Print events */
     for (int i = 0; i < num_events; i++) {
       print_event(&events[i]);
@@ -20,9 +20,35 @@ extern "C" {
 
 // --- Configuration ---
 
+// Wavelet filter bank implementation (see src/dsp/wavelet.h)
+typedef enum {
+  WAVELET_ENGINE_CONVOLUTION = 0, // Exact Morlet convolution, O(kernel) per
+                                  // sample per scale
+  WAVELET_ENGINE_RECURSIVE = 1    // Recursive Gaussian approximation, O(1) per
+                                  // sample per scale
+} SyllableWaveletEngine;
+
+// What a new syllable does when the prominence buffer is full, i.e. when
+// events_out has been too small to take the waiting events out
+typedef enum {
+  EVENT_OVERFLOW_DROP_OLDEST = 0, // Take the slot of the oldest waiting event
+  EVENT_OVERFLOW_GROW = 1 // Double the buffer. Allocates outside the single
+                          // block (see user_malloc), so not realtime-safe;
+                          // drops the oldest event if allocation fails
+} SyllableEventOverflow;
+
 typedef struct {
   int sample_rate;
 
+  // Analysis rate. With a rate other than sample_rate, the input is first
+  // resampled to it (polyphase FIR), and every stage runs there: time
+  // constants, FFT sizes and kernel lengths, and so cost and results, are
+  // those of a sample_rate == analysis_rate_hz detector. Event and trace
+  // timestamps stay in input samples, with the resampler's delay (16 samples
+  // of the lower rate) taken out. Ratios whose reduced numerator exceeds 1024
+  // are not supported, and syllable_create fails for them.
+  int analysis_rate_hz; // e.g. 16000; 0 analyzes at sample_rate (default: 0)
+
   // ZFF Config
   float zff_trend_window_ms; // Window for removing low-frequency trend
                              // (default: 10.0)
@@ -31,6 +57,16 @@ typedef struct {
   float peak_rate_band_min; // Bandpass min Hz (default: 500.0)
   float peak_rate_band_max; // Bandpass max Hz (default: 3200.0)
 
+  // Low-rate front-end. ZFF, the PeakRate envelope and TEO/LER only use the
+  // bottom few kHz, so they can run on the input decimated by an integer
+  // factor (e.g. 48 kHz -> 8 kHz) and be interpolated back to the input rate;
+  // events keep input-sample timestamps, and F0 epochs are placed between
+  // samples. Adds about 9 low-rate samples of latency to those features,
+  // which is subtracted from event timestamps.
+  float front_end_rate_hz; // Lowest rate for that path, raised as needed to
+                           // keep peak_rate_band_max in band; 0 runs it at
+                           // the input rate (default: 0)
+
   // Detection Logic
   float min_syllable_dist_ms; // Minimum distance between syllables (default:
                               // 100.0)
@@ -46,8 +82,13 @@ typedef struct {
   float hysteresis_on_factor;  // Multiplier for ON threshold (default: 1.3)
   float hysteresis_off_factor; // Multiplier for OFF threshold (default: 0.7)
 
-  // Prominence Context
-  int context_size; // Number of syllables to look ahead/behind (default: 2)
+  // Prominence Context. The prominence buffer holds the syllables awaiting
+  // their context plus up to event_backlog more awaiting events_out space;
+  // events dropped from it are counted (syllable_get_event_overflows).
+  int context_size;   // Number of syllables to look ahead/behind (default: 2)
+  int event_backlog;  // Waiting events beyond the context (default: 13)
+  int event_overflow; // SyllableEventOverflow (default:
+                      // EVENT_OVERFLOW_DROP_OLDEST)
 
   // --- Multi-Feature Detection (NEW) ---
 
@@ -64,6 +105,15 @@ typedef struct {
   // High-frequency energy config
   float high_freq_cutoff_hz; // High-pass cutoff for HFE (default: 2000.0)
 
+  // Wavelet config
+  float wavelet_min_freq_hz; // Lowest wavelet scale, at least 50 (default:
+                             // 2000.0)
+  float wavelet_max_freq_hz; // Highest wavelet scale (default: 6000.0)
+  int wavelet_num_scales;    // Log-spaced scales in between (default: 3)
+  int wavelet_engine;        // SyllableWaveletEngine (default:
+                             // WAVELET_ENGINE_CONVOLUTION)
+  int wavelet_multirate;     // Run lower octaves at halved rates (default: 0)
+
   // Feature Fusion weights (should sum to ~1.0)
   float weight_peak_rate;     // Weight for PeakRate (default: 0.25)
   float weight_spectral_flux; // Weight for Spectral Flux (default: 0.20)
@@ -75,6 +125,11 @@ typedef struct {
   // Fusion blend ratio: fusion = alpha * max + (1-alpha) * weighted_avg
   float fusion_blend_alpha; // Blend ratio for max/avg (default: 0.6)
 
+  // Fusion score statistics (syllable_get_fusion_stats): exact median and
+  // MAD over the last fusion_window_size scores, one taken every 16 samples
+  int fusion_window_size; // Scores in the window; 0 leaves it out
+                          // (default: 0)
+
   // Unvoiced onset detection
   float
       unvoiced_onset_threshold; // Threshold for unvoiced onsets (default: 0.5)
@@ -88,7 +143,15 @@ typedef struct {
   float calibration_duration_ms; // Calibration duration in ms (default: 2000.0)
   float snr_threshold_db;        // SNR threshold in dB (default: 6.0)
 
-  // User Memory (Optional, set to NULL to use malloc/free)
+  // --- Streaming (syllable_push / syllable_pump, see below) ---
+  float stream_buffer_ms;    // Audio queue length; 0 leaves streaming out
+                             // (default: 0)
+  int stream_event_capacity; // Events the event queue holds (default: 64)
+
+  // User Memory (Optional, set to NULL to use malloc/free). syllable_create
+  // makes exactly one user_malloc call, for a block holding the detector and
+  // every buffer it uses; syllable_destroy returns it with one user_free.
+  // Only EVENT_OVERFLOW_GROW allocates again, when the buffer grows.
   void *(*user_malloc)(size_t);
   void (*user_free)(void *);
 } SyllableConfig;
@@ -145,16 +208,315 @@ SYLLABLE_API int syllable_process(SyllableDetector *detector,
                                   const float *input, int num_samples,
                                   SyllableEvent *events_out, int max_events);
 
+// Integer PCM variants of syllable_process. Samples are scaled to [-1, 1)
+// (divided by 2^(bits - 1)) block by block as they enter the first pipeline
+// stage, so no float copy of the input is ever made; events are the same as
+// syllable_process on the scaled samples. 24-bit samples are packed
+// little-endian, 3 bytes each.
+SYLLABLE_API int syllable_process_i16(SyllableDetector *detector,
+                                      const int16_t *input, int num_samples,
+                                      SyllableEvent *events_out,
+                                      int max_events);
+SYLLABLE_API int syllable_process_i24(SyllableDetector *detector,
+                                      const uint8_t *input, int num_samples,
+                                      SyllableEvent *events_out,
+                                      int max_events);
+SYLLABLE_API int syllable_process_i32(SyllableDetector *detector,
+                                      const int32_t *input, int num_samples,
+                                      SyllableEvent *events_out,
+                                      int max_events);
+
+// Interleaved multi-channel PCM (num_frames frames of num_channels samples).
+// Analyzes channel 'channel', or the mean of all channels if channel is -1.
+// Returns 0 without processing if the channel is out of range.
+SYLLABLE_API int syllable_process_i16_interleaved(
+    SyllableDetector *detector, const int16_t *input, int num_frames,
+    int num_channels, int channel, SyllableEvent *events_out, int max_events);
+SYLLABLE_API int syllable_process_i24_interleaved(
+    SyllableDetector *detector, const uint8_t *input, int num_frames,
+    int num_channels, int channel, SyllableEvent *events_out, int max_events);
+SYLLABLE_API int syllable_process_i32_interleaved(
+    SyllableDetector *detector, const int32_t *input, int num_frames,
+    int num_channels, int channel, SyllableEvent *events_out, int max_events);
+
 // Flush any remaining events in the buffer (e.g. at end of file)
 SYLLABLE_API int syllable_flush(SyllableDetector *detector,
                                 SyllableEvent *events_out, int max_events);
 
+// Events dropped because the prominence buffer was full, since creation (or
+// the last reset)
+SYLLABLE_API uint64_t
+syllable_get_event_overflows(const SyllableDetector *detector);
+
 // Destroy the instance
 SYLLABLE_API void syllable_destroy(SyllableDetector *detector);
 
 // Helper to get default config
 SYLLABLE_API SyllableConfig syllable_default_config(int sample_rate);
 
+// --- Batch API ---
+
+// N independent streams sharing one configuration. The per-sample filters
+// (AGC, ZFF, PeakRate band envelope, TEO/LER, high-frequency energy) run in
+// lockstep across streams, one stream per SIMD lane; everything else runs per
+// stream. Events are identical to N separate detectors fed the same audio.
+typedef struct SyllableDetectorBatch SyllableDetectorBatch;
+
+// Create a batch of num_streams detectors with the same config
+SYLLABLE_API SyllableDetectorBatch *
+syllable_batch_create(const SyllableConfig *config, int num_streams);
+
+// Reset every stream (e.g. for a new set of files)
+SYLLABLE_API void syllable_batch_reset(SyllableDetectorBatch *batch);
+
+// Process num_samples samples of every stream. inputs[s] is stream s's
+// block; its events go to events_out[s] (capacity max_events each) and their
+// count to num_events[s]. Returns the total number of events.
+SYLLABLE_API int syllable_batch_process(SyllableDetectorBatch *batch,
+                                        const float *const *inputs,
+                                        int num_samples,
+                                        SyllableEvent *const *events_out,
+                                        int max_events, int *num_events);
+
+// Flush every stream's remaining events (same output layout as
+// syllable_batch_process)
+SYLLABLE_API int syllable_batch_flush(SyllableDetectorBatch *batch,
+                                      SyllableEvent *const *events_out,
+                                      int max_events, int *num_events);
+
+// Destroy the batch and all of its streams
+SYLLABLE_API void syllable_batch_destroy(SyllableDetectorBatch *batch);
+
+// --- Realtime Streaming ---
+
+// syllable_process does a varying, sometimes large amount of work per call
+// (an FFT hop lands on some blocks and not on others), so it must not run on
+// a hard-realtime audio thread. With stream_buffer_ms set, the detector owns
+// two wait-free single-producer / single-consumer queues that decouple it:
+//
+//   audio callback -> syllable_push -> audio queue -> syllable_pump
+//   syllable_pump -> event queue -> syllable_pop_events
+//
+// Each of the three calls may run on its own thread (one thread per call).
+// syllable_push only copies samples: no DSP, locks, allocation or system
+// calls, and work proportional to num_samples. syllable_pump runs the
+// pipeline on whatever audio is queued, from a worker thread or from the
+// caller's own loop. Every other call on the detector (syllable_flush at the
+// end of a stream, syllable_reset, ...) belongs on the syllable_pump thread,
+// and syllable_reset, which also empties both queues, only while nothing is
+// pushed or popped.
+
+typedef struct {
+  uint64_t samples_pushed;    // Samples syllable_push queued
+  uint64_t samples_processed; // Samples syllable_pump analyzed
+  uint64_t overruns;          // Samples syllable_push dropped: queue full
+  uint64_t underruns;         // syllable_pump calls that found no audio
+  uint64_t peak_fill;         // Most samples queued at once
+  uint64_t events_published;  // Events syllable_pump queued
+  uint64_t events_dropped;    // Events syllable_pump dropped: queue full
+} SyllableStreamStats;
+
+// Audio callback side: queue num_samples samples. Those that do not fit are
+// dropped and counted as overruns. Returns the number queued (0 without
+// streaming).
+SYLLABLE_API int syllable_push(SyllableDetector *detector, const float *input,
+                               int num_samples);
+
+// Worker side: analyze up to max_samples queued samples (all of them if
+// max_samples <= 0) and queue the events that complete. Returns the number
+// of samples analyzed.
+SYLLABLE_API int syllable_pump(SyllableDetector *detector, int max_samples);
+
+// Event consumer side: dequeue up to max_events events. Returns their count.
+SYLLABLE_API int syllable_pop_events(SyllableDetector *detector,
+                                     SyllableEvent *events_out,
+                                     int max_events);
+
+// Counters since creation (or the last reset), from any thread. Returns 1,
+// or 0 with out zeroed without streaming.
+SYLLABLE_API int syllable_get_stream_stats(const SyllableDetector *detector,
+                                           SyllableStreamStats *out);
+
+// --- Segmented Offline Analysis ---
+
+// A long recording held in memory can be split into segments analyzed
+// independently (e.g. on separate threads, one detector each) and stitched
+// back together. Each segment starts with a warm-up pre-roll that is processed
+// without reporting events, so that the adaptive state (AGC, feature
+// statistics, ZFF trend, F0 baseline) has converged when the segment begins.
+// Offline (non-real-time) configurations only.
+
+// Pre-roll long enough for the adaptive state of config to converge, in ms.
+// The Spectral Flux and MFCC statistics adapt once per hop and dominate: at
+// the defaults this is 5 * 500 ms * hop_size, about 11 minutes at 16 kHz.
+// Every segment processes that much audio again before its own, so for
+// recordings under an hour or so it costs more than splitting saves.
+// Shorter pre-rolls trade accuracy for less overlap: with 3-10 s, over 90%
+// of the onsets away from segment boundaries match a single run within
+// 20 ms, and event counts differ by a few percent.
+SYLLABLE_API float syllable_default_preroll_ms(const SyllableConfig *config);
+
+// Reset the detector and analyze samples [seg_start, seg_end) of audio
+// (num_samples long), warming up on up to preroll_ms before seg_start and
+// running past seg_end until syllables starting in the segment are complete.
+// Writes the events whose onset lies in the segment (timestamps relative to
+// the start of audio), up to max_events, and returns their count. delta_f0,
+// prominence and accents are provisional until syllable_stitch_segments.
+// Event callbacks stay installed but receive nothing from this call: events
+// always go to events_out.
+SYLLABLE_API int syllable_process_segment(SyllableDetector *detector,
+                                          const float *audio,
+                                          uint64_t num_samples,
+                                          uint64_t seg_start, uint64_t seg_end,
+                                          float preroll_ms,
+                                          SyllableEvent *events_out,
+                                          int max_events);
+
+// Merge segment events in place. events holds every segment's events in
+// segment order. Duplicates reported on both sides of a boundary are dropped,
+// and delta_f0, prominence and accents are recomputed over the merged list as
+// a single detector computes them. Returns the merged count (0, with events
+// untouched, if memory for scoring runs out).
+SYLLABLE_API int syllable_stitch_segments(const SyllableConfig *config,
+                                          SyllableEvent *events,
+                                          int num_events);
+
+// --- Event Callbacks ---
+
+// Instead of filling events_out, the detector can hand each event to a
+// callback the moment its prominence context is complete, straight from its
+// internal buffer, and/or collect the events of each call for a batch
+// callback. While either callback is installed, syllable_process (and its
+// PCM variants), syllable_flush and syllable_pump deliver every event through
+// the callbacks, never write events_out (which may be NULL) nor the event
+// queue of syllable_pop_events, and return the number of events delivered.
+// Callbacks run on the thread making the call and survive syllable_reset.
+
+// Called once per event. The event is only valid for the duration of the
+// call.
+typedef void (*SyllableEventFn)(void *user_data, const SyllableEvent *event);
+
+// Called at the end of each call that completed events, with those events in
+// order (in several calls of at most 16 events if there are more). The array
+// is only valid for the duration of the call.
+typedef void (*SyllableEventBatchFn)(void *user_data,
+                                     const SyllableEvent *events, int count);
+
+// Install (or, with a NULL callback, remove) the per-event callback
+SYLLABLE_API void syllable_set_event_callback(SyllableDetector *detector,
+                                              SyllableEventFn callback,
+                                              void *user_data);
+
+// Install (or, with a NULL callback, remove) the batch callback. With both
+// callbacks installed, each event goes to the per-event callback first.
+SYLLABLE_API void
+syllable_set_event_batch_callback(SyllableDetector *detector,
+                                  SyllableEventBatchFn callback,
+                                  void *user_data);
+
+// --- Feature Trace ---
+
+// The detector's internal features can be exported once per analysis hop
+// (hop_size_ms), e.g. to log them or to train on them. With Spectral Flux and
+// MFCC both disabled there is no STFT, and hops are counted from the moment
+// the trace is enabled.
+
+#define SYLLABLE_MFCC_COEFFS 13
+
+// Feature values at the last sample of one hop, as used by the fusion stage.
+// Features of disabled stages read 0.
+typedef struct {
+  uint64_t timestamp_samples; // Sample index of the last sample of the hop
+
+  float peak_rate;          // Envelope slope (PeakRate)
+  float spectral_flux;      // Spectral Flux of the hop's frame
+  float spectral_flatness;  // Spectral flatness of the frame
+  float flatness_weber;     // Flatness relative to its running baseline
+  float high_freq_energy;   // High-frequency energy
+  float mfcc[SYLLABLE_MFCC_COEFFS]; // MFCCs of the frame (mfcc_get_coeffs)
+  float mfcc_delta;         // MFCC change magnitude
+  float wavelet_score;      // Wavelet transient score
+  float teo;                // Teager energy, z-score against its running mean
+  float ler;                // Local (short/long-term) energy ratio
+  float f0;                 // Fundamental frequency (ZFF), 0 until voiced
+  float fusion_score;       // Combined detection score
+  int is_voiced;            // ZFF voicing decision
+} SyllableFeatureFrame;
+
+// Called from inside syllable_process (and its PCM variants) once per hop.
+// The frame is only valid for the duration of the call.
+typedef void (*SyllableFeatureTraceFn)(void *user_data,
+                                       const SyllableFeatureFrame *frame);
+
+// Install (or, with a NULL callback, remove) the feature trace. A detector
+// without a trace does no trace work at all. The trace survives
+// syllable_reset.
+SYLLABLE_API void syllable_set_feature_trace(SyllableDetector *detector,
+                                             SyllableFeatureTraceFn callback,
+                                             void *user_data);
+
+// --- Fusion Score Statistics ---
+
+// Median and MAD (median absolute deviation) of the fusion scores in the
+// window set by fusion_window_size. Returns the number of scores they cover,
+// or 0 with both set to 0 while the window is empty or left out.
+SYLLABLE_API int syllable_get_fusion_stats(const SyllableDetector *detector,
+                                           float *median, float *mad);
+
+// --- Performance Counters ---
+
+// Time spent in each stage of syllable_process, for finding the stage that
+// breaks a CPU budget. Counting is compiled in only when the library is built
+// with SYLLABLE_PERF_COUNTERS (CMake option of the same name); otherwise
+// nothing is measured and the functions below report no counters.
+// Instrumented builds read the clock three times per sample in the decision
+// stages (tens of cycles per sample), so compare stages rather than totals.
+
+typedef enum {
+  SYLLABLE_STAGE_AGC = 0,       // 0. AGC (block)
+  SYLLABLE_STAGE_ZFF,           // 1. ZFF filter (block)
+  SYLLABLE_STAGE_PEAK_RATE,     // 2. PeakRate bandpass + envelope (block)
+  SYLLABLE_STAGE_TEO_LER,       // TEO / LER (block)
+  SYLLABLE_STAGE_HIGH_FREQ,     // 3. High-frequency energy (block)
+  SYLLABLE_STAGE_SPECTRAL,      // 3. STFT, Spectral Flux, MFCC (block)
+  SYLLABLE_STAGE_WAVELET,       // 3. Wavelet (block)
+  SYLLABLE_STAGE_TRACKING,      // Voicing/F0, PeakRate, feature stats (sample)
+  SYLLABLE_STAGE_FUSION,        // 4. Fusion score and thresholds (sample)
+  SYLLABLE_STAGE_STATE_MACHINE, // 5. State machine, event emission (sample)
+  SYLLABLE_STAGE_DECIMATION,    // Low-rate front-end decimation and
+                                // interpolation (block)
+  SYLLABLE_STAGE_RESAMPLE,      // Input resampling to the analysis rate
+                                // (block)
+  SYLLABLE_NUM_STAGES
+} SyllablePerfStage;
+
+typedef struct {
+  uint64_t ticks[SYLLABLE_NUM_STAGES]; // Time spent per stage
+  uint64_t calls[SYLLABLE_NUM_STAGES]; // Blocks or samples, as marked above
+  uint64_t samples;                    // Samples processed (analysis rate)
+  int ticks_are_cycles; // 1: CPU timestamp counter cycles, 0: nanoseconds
+} SyllablePerfCounters;
+
+// Copy the counters accumulated since creation (or the last reset) to out.
+// Returns 1, or 0 with out zeroed when counters are not compiled in.
+SYLLABLE_API int syllable_get_perf_counters(const SyllableDetector *detector,
+                                            SyllablePerfCounters *out);
+
+// Zero the counters (syllable_reset leaves them alone)
+SYLLABLE_API void syllable_reset_perf_counters(SyllableDetector *detector);
+
+// Short name of a stage, e.g. "agc", for reports
+SYLLABLE_API const char *syllable_perf_stage_name(SyllablePerfStage stage);
+
+// --- SIMD Kernels ---
+
+// Instruction set the detector's SIMD kernels were chosen for at creation:
+// "scalar", "sse2", "neon", "avx2" or "avx512". The widest the CPU supports,
+// unless the SYLLABLE_SIMD environment variable caps it (same names, or
+// "baseline") to test a narrower path.
+SYLLABLE_API const char *
+syllable_get_simd_path(const SyllableDetector *detector);
+
 // --- Real-Time Mode API (NEW) ---
 
 /**
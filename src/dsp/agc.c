@@ -1,4 +1,5 @@
 #include "agc.h"
+#include "lanes.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -14,26 +15,14 @@ struct AgcState {
 
   // Gain smoothing
   float gain_coeff;
-
-  void *(*alloc_fn)(size_t);
-  void (*free_fn)(void *);
 };
 
-static void *default_malloc(size_t size) { return malloc(size); }
-static void default_free(void *ptr) { free(ptr); }
-
 AgcState *agc_create(int sample_rate, float target_db, float max_gain_db,
-                     void *(*alloc_fn)(size_t)) {
-  if (!alloc_fn)
-    alloc_fn = default_malloc;
-
-  AgcState *agc = (AgcState *)alloc_fn(sizeof(AgcState));
-  if (!agc)
+                     DspArena *arena) {
+  AgcState *agc = (AgcState *)dsp_arena_alloc(arena, sizeof(AgcState));
+  if (!dsp_arena_ok(arena))
     return NULL;
 
-  agc->alloc_fn = alloc_fn;
-  agc->free_fn = default_free;
-
   // Convert dB to linear
   agc->target_level = powf(10.0f, target_db / 20.0f);
   agc->max_gain = powf(10.0f, max_gain_db / 20.0f);
@@ -55,15 +44,6 @@ AgcState *agc_create(int sample_rate, float target_db, float max_gain_db,
   return agc;
 }
 
-void agc_destroy(AgcState *agc, void (*free_fn)(void *)) {
-  if (!agc)
-    return;
-  if (free_fn)
-    free_fn(agc);
-  else
-    free(agc);
-}
-
 void agc_reset(AgcState *agc) {
   agc->current_gain = 1.0f;
   agc->envelope = 0.0f;
@@ -97,4 +77,80 @@ float agc_process(AgcState *agc, float sample) {
   return sample * agc->current_gain;
 }
 
+void agc_process_block(AgcState *agc, const float *in, float *out, int n) {
+  // Same recurrence as agc_process, with the state held in locals
+  float envelope = agc->envelope;
+  float gain = agc->current_gain;
+  const float attack = agc->attack_coeff;
+  const float release = agc->release_coeff;
+  const float gain_coeff = agc->gain_coeff;
+  const float target_level = agc->target_level;
+  const float max_gain = agc->max_gain;
+
+  for (int i = 0; i < n; i++) {
+    float sample = in[i];
+    float abs_sample = fabsf(sample);
+
+    if (abs_sample > envelope) {
+      envelope += attack * (abs_sample - envelope);
+    } else {
+      envelope += release * (abs_sample - envelope);
+    }
+
+    float env_safe = (envelope > 1e-6f) ? envelope : 1e-6f;
+    float target_gain = target_level / env_safe;
+
+    if (target_gain > max_gain)
+      target_gain = max_gain;
+    if (target_gain < 0.1f)
+      target_gain = 0.1f;
+
+    gain += gain_coeff * (target_gain - gain);
+    out[i] = sample * gain;
+  }
+
+  agc->envelope = envelope;
+  agc->current_gain = gain;
+}
+
+void agc_process_lanes(AgcState *const *agc, int lanes, const float *in,
+                       float *out, int n) {
+  float envelope[DSP_MAX_LANES], gain[DSP_MAX_LANES];
+  float attack[DSP_MAX_LANES], release[DSP_MAX_LANES];
+  float gain_coeff[DSP_MAX_LANES], target_level[DSP_MAX_LANES];
+  float max_gain[DSP_MAX_LANES];
+  for (int l = 0; l < lanes; l++) {
+    envelope[l] = agc[l]->envelope;
+    gain[l] = agc[l]->current_gain;
+    attack[l] = agc[l]->attack_coeff;
+    release[l] = agc[l]->release_coeff;
+    gain_coeff[l] = agc[l]->gain_coeff;
+    target_level[l] = agc[l]->target_level;
+    max_gain[l] = agc[l]->max_gain;
+  }
+  for (int i = 0; i < n; i++) {
+    const float *xi = in + i * lanes;
+    float *yi = out + i * lanes;
+    for (int l = 0; l < lanes; l++) {
+      float sample = xi[l];
+      float abs_sample = fabsf(sample);
+      float env = envelope[l];
+      float coeff = abs_sample > env ? attack[l] : release[l];
+      env += coeff * (abs_sample - env);
+      float env_safe = (env > 1e-6f) ? env : 1e-6f;
+      float target_gain = target_level[l] / env_safe;
+      target_gain = target_gain > max_gain[l] ? max_gain[l] : target_gain;
+      target_gain = target_gain < 0.1f ? 0.1f : target_gain;
+      float g = gain[l] + gain_coeff[l] * (target_gain - gain[l]);
+      envelope[l] = env;
+      gain[l] = g;
+      yi[l] = sample * g;
+    }
+  }
+  for (int l = 0; l < lanes; l++) {
+    agc[l]->envelope = envelope[l];
+    agc[l]->current_gain = gain[l];
+  }
+}
+
 float agc_get_gain(AgcState *agc) { return agc->current_gain; }
@@ -1,6 +1,7 @@
 #ifndef AGC_H
 #define AGC_H
 
+#include "arena.h"
 #include <stddef.h>
 
 #ifdef __cplusplus
@@ -12,11 +13,9 @@ typedef struct AgcState AgcState;
 // Create AGC instance
 // target_db: Target RMS level in dB (e.g., -20.0)
 // max_gain_db: Maximum amplification in dB (e.g., 30.0)
+// arena: Memory for the instance (see arena.h); NULL while measuring
 AgcState *agc_create(int sample_rate, float target_db, float max_gain_db,
-                     void *(*alloc_fn)(size_t));
-
-// Destroy AGC instance
-void agc_destroy(AgcState *agc, void (*free_fn)(void *));
+                     DspArena *arena);
 
 // Reset AGC state
 void agc_reset(AgcState *agc);
@@ -25,6 +24,14 @@ void agc_reset(AgcState *agc);
 // Returns the gain-adjusted sample
 float agc_process(AgcState *agc, float sample);
 
+// Process a block of samples (in and out may alias)
+void agc_process_block(AgcState *agc, const float *in, float *out, int n);
+
+// agc_process_block over lanes <= DSP_MAX_LANES instances, samples
+// interleaved by lane (see lanes.h); in and out may alias
+void agc_process_lanes(AgcState *const *agc, int lanes, const float *in,
+                       float *out, int n);
+
 // Get current gain (linear)
 float agc_get_gain(AgcState *agc);
 
@@ -0,0 +1,62 @@
+/*
+ * arena.h - Single-block memory arena for a detector and its DSP modules
+ *
+ * Every buffer of a detector (module states, FFT configurations and
+ * twiddles, kernels, rings, filterbanks) is carved out of one block obtained
+ * from a single user_malloc call. Buffers are DSP_ARENA_ALIGN aligned, so no
+ * two of them share a cache line.
+ *
+ * The block is sized by running the same layout twice. An arena without
+ * memory measures: allocations only advance `used` and return NULL. Module
+ * creates therefore take every allocation before writing anything, and
+ * return NULL unless dsp_arena_ok() afterwards; the second run, on a block of
+ * the measured size, then lays out exactly the same offsets. The owner of the
+ * block zeroes it, so buffers start zeroed.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Cache line */
+#define DSP_ARENA_ALIGN 64
+
+typedef struct {
+  unsigned char *base; /* NULL while measuring */
+  size_t size;
+  size_t used; /* Bytes taken so far, alignment padding included */
+} DspArena;
+
+/* Arena over block (block_size bytes, any alignment); a NULL block measures */
+static inline void dsp_arena_init(DspArena *a, void *block, size_t block_size) {
+  size_t pad = (size_t)(-(uintptr_t)block) & (DSP_ARENA_ALIGN - 1);
+  a->base = block ? (unsigned char *)block + pad : NULL;
+  a->size = block && block_size > pad ? block_size - pad : 0;
+  a->used = 0;
+}
+
+/* Block size needed for an arena that measured a->used bytes (leaves room to
+ * align the start of the block) */
+static inline size_t dsp_arena_block_size(const DspArena *a) {
+  return a->used + DSP_ARENA_ALIGN - 1;
+}
+
+/* Take bytes from the arena. Returns NULL while measuring or once the arena
+ * is exhausted. */
+static inline void *dsp_arena_alloc(DspArena *a, size_t bytes) {
+  size_t offset = (a->used + DSP_ARENA_ALIGN - 1) &
+                  ~(size_t)(DSP_ARENA_ALIGN - 1);
+  a->used = offset + bytes;
+  if (!a->base || a->used > a->size)
+    return NULL;
+  return a->base + offset;
+}
+
+/* 1 if every allocation so far was served (0 while measuring) */
+static inline int dsp_arena_ok(const DspArena *a) {
+  return a->base && a->used <= a->size;
+}
+
+#endif /* ARENA_H */
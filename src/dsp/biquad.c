@@ -1,4 +1,5 @@
 #include "biquad.h"
+#include "lanes.h"
 #include <math.h>
 
 #ifndef M_PI
@@ -55,3 +56,70 @@ float biquad_process(Biquad *f, float in) {
 
   return out;
 }
+
+void biquad_process_block(Biquad *f, const float *in, float *out, int n) {
+  const float b0 = f->b0, b1 = f->b1, b2 = f->b2, a1 = f->a1, a2 = f->a2;
+  float x1 = f->x1, x2 = f->x2, y1 = f->y1, y2 = f->y2;
+
+  for (int i = 0; i < n; i++) {
+    float x = in[i];
+    float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+
+    // Avoid denormals
+    if (fabsf(y) < 1.0e-15f)
+      y = 0.0f;
+
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    out[i] = y;
+  }
+
+  f->x1 = x1;
+  f->x2 = x2;
+  f->y1 = y1;
+  f->y2 = y2;
+}
+
+void biquad_process_lanes(Biquad *const *f, int lanes, const float *in,
+                          float *out, int n) {
+  float b0[DSP_MAX_LANES], b1[DSP_MAX_LANES], b2[DSP_MAX_LANES];
+  float a1[DSP_MAX_LANES], a2[DSP_MAX_LANES];
+  float x1[DSP_MAX_LANES], x2[DSP_MAX_LANES];
+  float y1[DSP_MAX_LANES], y2[DSP_MAX_LANES];
+  for (int l = 0; l < lanes; l++) {
+    b0[l] = f[l]->b0;
+    b1[l] = f[l]->b1;
+    b2[l] = f[l]->b2;
+    a1[l] = f[l]->a1;
+    a2[l] = f[l]->a2;
+    x1[l] = f[l]->x1;
+    x2[l] = f[l]->x2;
+    y1[l] = f[l]->y1;
+    y2[l] = f[l]->y2;
+  }
+  for (int i = 0; i < n; i++) {
+    const float *xi = in + i * lanes;
+    float *yi = out + i * lanes;
+    for (int l = 0; l < lanes; l++) {
+      float x = xi[l];
+      float y =
+          b0[l] * x + b1[l] * x1[l] + b2[l] * x2[l] - a1[l] * y1[l] -
+          a2[l] * y2[l];
+      // Avoid denormals
+      y = fabsf(y) < 1.0e-15f ? 0.0f : y;
+      x2[l] = x1[l];
+      x1[l] = x;
+      y2[l] = y1[l];
+      y1[l] = y;
+      yi[l] = y;
+    }
+  }
+  for (int l = 0; l < lanes; l++) {
+    f[l]->x1 = x1[l];
+    f[l]->x2 = x2[l];
+    f[l]->y1 = y1[l];
+    f[l]->y2 = y2[l];
+  }
+}
@@ -10,5 +10,10 @@ void biquad_reset(Biquad *f);
 void biquad_config_bandpass(Biquad *f, float sample_rate, float center_freq,
                             float q_factor);
 float biquad_process(Biquad *f, float in);
+void biquad_process_block(Biquad *f, const float *in, float *out, int n);
+// biquad_process_block over lanes <= DSP_MAX_LANES filters, samples
+// interleaved by lane (see lanes.h); in and out may alias
+void biquad_process_lanes(Biquad *const *f, int lanes, const float *in,
+                          float *out, int n);
 
 #endif
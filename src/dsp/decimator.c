@@ -0,0 +1,158 @@
+/*
+ * decimator.c - Integer-factor decimation and linear re-interpolation
+ *
+ * history[] holds the last taps - 1 input samples followed by the current
+ * block, so every output's window is contiguous and oldest first. The filter
+ * is symmetric and needs no reversal to line up with it.
+ */
+
+#include "decimator.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Kaiser window shape for about -50 dB stopband */
+#define DECIMATOR_KAISER_BETA 4.55
+
+struct Decimator {
+  int factor;
+  float inv_factor;
+  int num_taps; /* factor * DECIMATOR_TAPS_PER_PHASE */
+  int max_block;
+  const SimdKernels *simd;
+  float *taps;    /* [num_taps] */
+  float *history; /* [num_taps - 1 + max_block] */
+
+  int phase;       /* Input samples into the current output period */
+  int block_phase; /* phase before the last decimator_process_block */
+};
+
+/* Modified Bessel function of the first kind, order 0 (power series) */
+static double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 32; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+/* Low-pass at half the output rate: sinc(n / factor), Kaiser windowed, unity
+ * gain at DC */
+static void design_lowpass(float *h, int num_taps, int factor) {
+  double center = 0.5 * (num_taps - 1);
+  double norm = bessel_i0(DECIMATOR_KAISER_BETA);
+  double sum = 0.0;
+  for (int i = 0; i < num_taps; i++) {
+    double m = (i - center) / factor;
+    double ideal = m == 0.0 ? 1.0 : sin(M_PI * m) / (M_PI * m);
+    double r = (i - center) / center;
+    double kaiser = bessel_i0(DECIMATOR_KAISER_BETA * sqrt(1.0 - r * r)) / norm;
+    h[i] = (float)(ideal * kaiser);
+    sum += ideal * kaiser;
+  }
+  for (int i = 0; i < num_taps; i++)
+    h[i] = (float)(h[i] / sum);
+}
+
+Decimator *decimator_create(int factor, int max_block,
+                            const SimdKernels *simd, DspArena *arena) {
+  if (factor < 2 || max_block < 1)
+    return NULL;
+  int num_taps = factor * DECIMATOR_TAPS_PER_PHASE;
+
+  Decimator *dec = (Decimator *)dsp_arena_alloc(arena, sizeof(Decimator));
+  float *taps = (float *)dsp_arena_alloc(arena, num_taps * sizeof(float));
+  float *history = (float *)dsp_arena_alloc(
+      arena, (size_t)(num_taps - 1 + max_block) * sizeof(float));
+  if (!dsp_arena_ok(arena))
+    return NULL;
+
+  dec->factor = factor;
+  dec->inv_factor = 1.0f / factor;
+  dec->num_taps = num_taps;
+  dec->max_block = max_block;
+  dec->simd = simd;
+  dec->taps = taps;
+  dec->history = history;
+  design_lowpass(taps, num_taps, factor);
+  decimator_reset(dec);
+  return dec;
+}
+
+int decimator_process_block(Decimator *dec, const float *in, int n,
+                            float *out) {
+  const int keep = dec->num_taps - 1;
+  float *h = dec->history;
+  memcpy(h + keep, in, (size_t)n * sizeof(float));
+
+  /* Outputs complete their period at block offsets j; the window of the one
+   * at j ends at h[keep + j], so it starts at h[j] */
+  int count = 0;
+  for (int j = dec->factor - 1 - dec->phase; j < n; j += dec->factor)
+    out[count++] = dec->simd->dot_product(dec->taps, h + j, dec->num_taps);
+
+  dec->block_phase = dec->phase;
+  dec->phase = (dec->phase + n) % dec->factor;
+  memmove(h, h + n, (size_t)keep * sizeof(float));
+  return count;
+}
+
+void decimator_interpolate(const Decimator *dec, int count,
+                           const float *const *low, float (*tail)[2],
+                           float *const *out, int n) {
+  const int factor = dec->factor;
+  float from[DECIMATOR_MAX_SIGNALS], to[DECIMATOR_MAX_SIGNALS];
+  float step[DECIMATOR_MAX_SIGNALS];
+  for (int s = 0; s < count; s++) {
+    from[s] = tail[s][0];
+    to[s] = tail[s][1];
+  }
+
+  /* One ramp per period and signal, all signals together, so that the inner
+   * loops have no branch */
+  int r = dec->block_phase;
+  int k = 0; /* Low-rate values consumed */
+  for (int i = 0; i < n;) {
+    int len = factor - r < n - i ? factor - r : n - i;
+    for (int s = 0; s < count; s++)
+      step[s] = (to[s] - from[s]) * dec->inv_factor;
+    for (int j = 0; j < len; j++) {
+      float w = (float)(r + 1 + j);
+      for (int s = 0; s < count; s++)
+        out[s][i + j] = from[s] + w * step[s];
+    }
+    i += len;
+    if (r + len == factor) {
+      /* The period ended: the value computed from it is the next target */
+      for (int s = 0; s < count; s++) {
+        from[s] = to[s];
+        to[s] = low[s][k];
+      }
+      k++;
+    }
+    r = 0;
+  }
+
+  for (int s = 0; s < count; s++) {
+    tail[s][0] = from[s];
+    tail[s][1] = to[s];
+  }
+}
+
+int decimator_factor(const Decimator *dec) { return dec->factor; }
+
+int decimator_delay(const Decimator *dec) {
+  return dec->factor + dec->num_taps / 2;
+}
+
+void decimator_reset(Decimator *dec) {
+  memset(dec->history, 0,
+         (size_t)(dec->num_taps - 1 + dec->max_block) * sizeof(float));
+  dec->phase = 0;
+  dec->block_phase = 0;
+}
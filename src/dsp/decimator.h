@@ -0,0 +1,95 @@
+/*
+ * decimator.h - Integer-factor decimation and linear re-interpolation
+ *
+ * Feeds the low-rate front-end of the detector: the envelope, ZFF and
+ * TEO/LER stages only look at the bottom few kHz of the signal, so they can
+ * run on the input decimated by an integer factor and have their outputs
+ * interpolated back to one value per input sample.
+ *
+ * The anti-aliasing filter is a Kaiser-windowed sinc of
+ * DECIMATOR_TAPS_PER_PHASE taps per phase (factor * that many in all), with
+ * its passband to DECIMATOR_PASSBAND and its stopband (about -50 dB) from
+ * 1 - DECIMATOR_PASSBAND of the output rate, so anything aliased lands above
+ * the passband. Only the kept outputs are computed (polyphase), each as one
+ * SIMD dot product over the block's input history.
+ *
+ * Interpolation runs one low-rate sample behind, like the multi-rate wavelet
+ * levels: over the input samples of each low-rate period the output ramps
+ * from the next-to-last to the last low-rate value produced before it. The
+ * front-end therefore lags the input by the filter delay plus one low-rate
+ * period (decimator_delay).
+ */
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include "arena.h"
+#include "simd_dispatch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DECIMATOR_TAPS_PER_PHASE 16
+
+/* Highest frequency kept intact, as a fraction of the output rate */
+#define DECIMATOR_PASSBAND 0.4f
+
+/* Most signals one decimator_interpolate call handles */
+#define DECIMATOR_MAX_SIGNALS 8
+
+typedef struct Decimator Decimator;
+
+/*
+ * Create a decimator
+ *
+ * @param factor     Input samples per output sample (>= 2)
+ * @param max_block  Longest block decimator_process_block will be given
+ * @param simd       Kernels to run with (see simd_dispatch.h)
+ * @param arena      Memory for the filter and history (see arena.h); NULL
+ *                   return while measuring
+ */
+Decimator *decimator_create(int factor, int max_block,
+                            const SimdKernels *simd, DspArena *arena);
+
+/*
+ * Decimate n (<= max_block) input samples, writing one output per factor
+ * input samples. Outputs fall on whole periods counted from creation (or
+ * reset), so a period may straddle blocks.
+ *
+ * @return           Number of outputs written, at most n / factor + 1
+ */
+int decimator_process_block(Decimator *dec, const float *in, int n,
+                            float *out);
+
+/*
+ * Interpolate count (<= DECIMATOR_MAX_SIGNALS) low-rate signals back to the
+ * n input samples of the block last passed to decimator_process_block. low[s]
+ * holds signal s computed from that block's outputs, one value per output;
+ * tail[s] holds its last two low-rate values before the block (zero after a
+ * reset) and is advanced past it. Results go to out[s].
+ */
+void decimator_interpolate(const Decimator *dec, int count,
+                           const float *const *low, float (*tail)[2],
+                           float *const *out, int n);
+
+/*
+ * Input samples per output sample
+ */
+int decimator_factor(const Decimator *dec);
+
+/*
+ * Lag of the interpolated output behind the input, in input samples
+ */
+int decimator_delay(const Decimator *dec);
+
+/*
+ * Clear the filter history and restart the output period
+ */
+void decimator_reset(Decimator *dec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DECIMATOR_H */
@@ -1,4 +1,5 @@
 #include "envelope.h"
+#include "lanes.h"
 #include <math.h>
 
 void envelope_init(EnvelopeFollower *e, float sample_rate, float attack_ms,
@@ -34,3 +35,47 @@ float envelope_process(EnvelopeFollower *e, float in) {
 
   return e->output;
 }
+
+void envelope_process_block(EnvelopeFollower *e, const float *in, float *out,
+                            int n) {
+  const float attack = e->attack_coeff;
+  const float release = e->release_coeff;
+  float output = e->output;
+
+  for (int i = 0; i < n; i++) {
+    float abs_in = fabsf(in[i]);
+
+    if (abs_in > output) {
+      output = attack * output + (1.0f - attack) * abs_in;
+    } else {
+      output = release * output + (1.0f - release) * abs_in;
+    }
+    out[i] = output;
+  }
+
+  e->output = output;
+}
+
+void envelope_process_lanes(EnvelopeFollower *const *e, int lanes,
+                            const float *in, float *out, int n) {
+  float attack[DSP_MAX_LANES], release[DSP_MAX_LANES], output[DSP_MAX_LANES];
+  for (int l = 0; l < lanes; l++) {
+    attack[l] = e[l]->attack_coeff;
+    release[l] = e[l]->release_coeff;
+    output[l] = e[l]->output;
+  }
+  for (int i = 0; i < n; i++) {
+    const float *xi = in + i * lanes;
+    float *yi = out + i * lanes;
+    for (int l = 0; l < lanes; l++) {
+      float abs_in = fabsf(xi[l]);
+      float o = output[l];
+      float coeff = abs_in > o ? attack[l] : release[l];
+      o = coeff * o + (1.0f - coeff) * abs_in;
+      output[l] = o;
+      yi[l] = o;
+    }
+  }
+  for (int l = 0; l < lanes; l++)
+    e[l]->output = output[l];
+}
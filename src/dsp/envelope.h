@@ -10,5 +10,11 @@ typedef struct {
 void envelope_init(EnvelopeFollower *e, float sample_rate, float attack_ms,
                    float release_ms);
 float envelope_process(EnvelopeFollower *e, float in);
+void envelope_process_block(EnvelopeFollower *e, const float *in, float *out,
+                            int n);
+// envelope_process_block over lanes <= DSP_MAX_LANES followers, samples
+// interleaved by lane (see lanes.h); in and out may alias
+void envelope_process_lanes(EnvelopeFollower *const *e, int lanes,
+                            const float *in, float *out, int n);
 
 #endif
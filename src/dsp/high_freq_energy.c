@@ -8,6 +8,7 @@
  */
 
 #include "high_freq_energy.h"
+#include "lanes.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -62,11 +63,10 @@ static void design_highpass(HighFreqEnergy *hfe) {
 }
 
 HighFreqEnergy *hfe_create(int sample_rate, float cutoff_hz, float window_ms,
-                           void *(*custom_alloc)(size_t)) {
-  void *(*alloc)(size_t) = custom_alloc ? custom_alloc : malloc;
-
-  HighFreqEnergy *hfe = (HighFreqEnergy *)alloc(sizeof(HighFreqEnergy));
-  if (!hfe)
+                           DspArena *arena) {
+  HighFreqEnergy *hfe =
+      (HighFreqEnergy *)dsp_arena_alloc(arena, sizeof(HighFreqEnergy));
+  if (!dsp_arena_ok(arena))
     return NULL;
 
   memset(hfe, 0, sizeof(HighFreqEnergy));
@@ -102,13 +102,6 @@ void hfe_reset(HighFreqEnergy *hfe) {
   hfe->peak_energy = 0.0f;
 }
 
-void hfe_destroy(HighFreqEnergy *hfe, void (*custom_free)(void *)) {
-  if (!hfe)
-    return;
-  void (*free_fn)(void *) = custom_free ? custom_free : free;
-  free_fn(hfe);
-}
-
 float hfe_process(HighFreqEnergy *hfe, float input) {
   /* Apply high-pass filter (Direct Form II Transposed) */
   float filtered = hfe->b0 * input + hfe->b1 * hfe->x1 + hfe->b2 * hfe->x2 -
@@ -140,6 +133,106 @@ float hfe_process(HighFreqEnergy *hfe, float input) {
   return hfe->energy;
 }
 
+void hfe_process_block(HighFreqEnergy *hfe, const float *input, float *out,
+                       int n) {
+  const float b0 = hfe->b0, b1 = hfe->b1, b2 = hfe->b2;
+  const float a1 = hfe->a1, a2 = hfe->a2;
+  const float attack = hfe->attack_coef, release = hfe->release_coef;
+  const float peak_decay = hfe->peak_decay;
+  float x1 = hfe->x1, x2 = hfe->x2, y1 = hfe->y1, y2 = hfe->y2;
+  float energy = hfe->energy, peak = hfe->peak_energy;
+
+  for (int i = 0; i < n; i++) {
+    float x = input[i];
+    float filtered = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = filtered;
+
+    float inst_energy = filtered * filtered;
+    if (inst_energy > energy) {
+      energy += attack * (inst_energy - energy);
+    } else {
+      energy += release * (inst_energy - energy);
+    }
+
+    if (energy > peak) {
+      peak = energy;
+    } else {
+      peak -= peak_decay * peak;
+    }
+
+    out[i] = energy;
+  }
+
+  hfe->x1 = x1;
+  hfe->x2 = x2;
+  hfe->y1 = y1;
+  hfe->y2 = y2;
+  hfe->energy = energy;
+  hfe->peak_energy = peak;
+}
+
+void hfe_process_lanes(HighFreqEnergy *const *hfe, int lanes,
+                       const float *input, float *out, int n) {
+  float b0[DSP_MAX_LANES], b1[DSP_MAX_LANES], b2[DSP_MAX_LANES];
+  float a1[DSP_MAX_LANES], a2[DSP_MAX_LANES];
+  float attack[DSP_MAX_LANES], release[DSP_MAX_LANES];
+  float peak_decay[DSP_MAX_LANES];
+  float x1[DSP_MAX_LANES], x2[DSP_MAX_LANES];
+  float y1[DSP_MAX_LANES], y2[DSP_MAX_LANES];
+  float energy[DSP_MAX_LANES], peak[DSP_MAX_LANES];
+  for (int l = 0; l < lanes; l++) {
+    b0[l] = hfe[l]->b0;
+    b1[l] = hfe[l]->b1;
+    b2[l] = hfe[l]->b2;
+    a1[l] = hfe[l]->a1;
+    a2[l] = hfe[l]->a2;
+    attack[l] = hfe[l]->attack_coef;
+    release[l] = hfe[l]->release_coef;
+    peak_decay[l] = hfe[l]->peak_decay;
+    x1[l] = hfe[l]->x1;
+    x2[l] = hfe[l]->x2;
+    y1[l] = hfe[l]->y1;
+    y2[l] = hfe[l]->y2;
+    energy[l] = hfe[l]->energy;
+    peak[l] = hfe[l]->peak_energy;
+  }
+  for (int i = 0; i < n; i++) {
+    const float *xi = input + i * lanes;
+    float *yi = out + i * lanes;
+    for (int l = 0; l < lanes; l++) {
+      float x = xi[l];
+      float filtered = b0[l] * x + b1[l] * x1[l] + b2[l] * x2[l] -
+                       a1[l] * y1[l] - a2[l] * y2[l];
+      x2[l] = x1[l];
+      x1[l] = x;
+      y2[l] = y1[l];
+      y1[l] = filtered;
+
+      float inst_energy = filtered * filtered;
+      float e = energy[l];
+      float coef = inst_energy > e ? attack[l] : release[l];
+      e += coef * (inst_energy - e);
+      float p = peak[l];
+      float decayed = p - peak_decay[l] * p;
+      p = e > p ? e : decayed;
+      energy[l] = e;
+      peak[l] = p;
+      yi[l] = e;
+    }
+  }
+  for (int l = 0; l < lanes; l++) {
+    hfe[l]->x1 = x1[l];
+    hfe[l]->x2 = x2[l];
+    hfe[l]->y1 = y1[l];
+    hfe[l]->y2 = y2[l];
+    hfe[l]->energy = energy[l];
+    hfe[l]->peak_energy = peak[l];
+  }
+}
+
 float hfe_get_current(const HighFreqEnergy *hfe) {
   return hfe ? hfe->energy : 0.0f;
 }
@@ -8,6 +8,7 @@
 #ifndef HIGH_FREQ_ENERGY_H
 #define HIGH_FREQ_ENERGY_H
 
+#include "arena.h"
 #include <stddef.h>
 
 #ifdef __cplusplus
@@ -22,16 +23,30 @@ typedef struct HighFreqEnergy HighFreqEnergy;
  * @param sample_rate   Audio sample rate (Hz)
  * @param cutoff_hz     High-pass filter cutoff (default: 2000)
  * @param window_ms     Energy integration window in ms (default: 10)
- * @param custom_alloc  Custom allocator (NULL for malloc)
+ * @param arena         Memory for the tracker (see arena.h); NULL return
+ *                      while measuring
  */
 HighFreqEnergy *hfe_create(int sample_rate, float cutoff_hz, float window_ms,
-                           void *(*custom_alloc)(size_t));
+                           DspArena *arena);
 
 /*
  * Process a single sample, returns smoothed high-freq energy
  */
 float hfe_process(HighFreqEnergy *hfe, float input);
 
+/*
+ * Process a block of samples, writing the smoothed energy for each sample
+ */
+void hfe_process_block(HighFreqEnergy *hfe, const float *input, float *out,
+                       int n);
+
+/*
+ * hfe_process_block over lanes <= DSP_MAX_LANES trackers, samples
+ * interleaved by lane (see lanes.h); input and out may alias
+ */
+void hfe_process_lanes(HighFreqEnergy *const *hfe, int lanes,
+                       const float *input, float *out, int n);
+
 /*
  * Get current energy value without processing
  */
@@ -42,11 +57,6 @@ float hfe_get_current(const HighFreqEnergy *hfe);
  */
 void hfe_reset(HighFreqEnergy *hfe);
 
-/*
- * Destroy and free resources
- */
-void hfe_destroy(HighFreqEnergy *hfe, void (*custom_free)(void *));
-
 #ifdef __cplusplus
 }
 #endif
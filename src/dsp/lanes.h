@@ -0,0 +1,19 @@
+/*
+ * lanes.h - Lane-parallel processing of independent streams
+ *
+ * The *_process_lanes variants of the per-sample DSP modules run up to
+ * DSP_MAX_LANES independent instances (one per stream) in lockstep. Samples
+ * are interleaved by lane, in[i * lanes + l] being sample i of stream l, so
+ * the inner loop over lanes vectorizes across streams while each stream's
+ * recurrence stays sequential. Every lane performs exactly the arithmetic of
+ * the module's *_process_block, so results are bit-identical to processing
+ * the streams one by one.
+ */
+
+#ifndef LANES_H
+#define LANES_H
+
+/* One AVX-512 register of floats */
+#define DSP_MAX_LANES 16
+
+#endif /* LANES_H */
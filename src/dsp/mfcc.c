@@ -1,11 +1,12 @@
 /*
  * mfcc.c - MFCC implementation optimized for onset/syllable detection
  *
- * Pipeline:
- *   1. Windowing (Hann)
- *   2. FFT → Power spectrum
- *   3. Mel filterbank → Log energy
- *   4. DCT → MFCC coefficients
+ * Pipeline (separate SIMD passes per frame, each over a small buffer):
+ *   1. Power spectrum of the bins covered by the filterbank (from the shared
+ *      STFT front-end's complex spectrum)
+ *   2. Mel filterbank (sparse, CSR): one dot product per filter row
+ *   3. Log energy over all filters
+ *   4. DCT: one dot product per coefficient
  *   5. Delta computation → L2 norm
  *
  * The delta-MFCC magnitude is particularly useful for detecting
@@ -13,9 +14,6 @@
  */
 
 #include "mfcc.h"
-#include "../../extern/kissfft/kiss_fft.h"
-#include "../../extern/kissfft/kiss_fftr.h"
-#include "simd_utils.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,27 +25,19 @@
 struct MFCC {
   int sample_rate;
   int fft_size;
-  int hop_size;
   int n_bins;
-
-  /* FFT */
-  kiss_fftr_cfg fft_cfg;
-
-  /* Buffers */
-  float *input_buffer;
-  int input_write_pos;
-  int samples_since_hop;
-
-  float *window;
-  float *windowed_frame;
-  kiss_fft_cpx *spectrum;
-  float *power_spectrum;
-
-  /* Mel filterbank */
-  float *mel_energies;
-  float **mel_filters;   /* [MFCC_NUM_FILTERS][n_bins] */
-  int *mel_filter_start; /* Start bin for each filter */
-  int *mel_filter_end;   /* End bin for each filter */
+  const SimdKernels *simd;
+
+  /* Mel filterbank, stored as compressed sparse rows: the weights of filter
+   * f are mel_weights[mel_offset[f] .. mel_offset[f + 1]) and apply to bins
+   * from mel_filter_start[f] on */
+  float mel_energies[MFCC_NUM_FILTERS];
+  float *mel_weights;
+  int mel_offset[MFCC_NUM_FILTERS + 1];
+  int mel_filter_start[MFCC_NUM_FILTERS];
+  int mel_bin_lo; /* Bins covered by any filter: [mel_bin_lo, mel_bin_hi] */
+  int mel_bin_hi;
+  float *power; /* Power of the covered bins */
 
   /* DCT matrix for MFCC */
   float *dct_matrix; /* [MFCC_NUM_COEFFS][MFCC_NUM_FILTERS] */
@@ -56,9 +46,6 @@ struct MFCC {
   float coeffs[MFCC_NUM_COEFFS];
   float prev_coeffs[MFCC_NUM_COEFFS];
   float delta_magnitude;
-
-  /* Memory */
-  void *(*alloc_fn)(size_t);
 };
 
 /* Convert frequency to Mel scale */
@@ -71,50 +58,50 @@ static float mel_to_hz(float mel) {
   return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
 }
 
-/* Initialize Mel filterbank */
-static int init_mel_filterbank(MFCC *m) {
-  float mel_low = hz_to_mel(80.0f);                         /* 80 Hz low edge */
-  float mel_high = hz_to_mel((float)m->sample_rate / 2.0f); /* Nyquist */
+/* Mel filter edges as FFT bin indices */
+static void mel_filter_bins(int sample_rate, int fft_size, int *hz_points) {
+  int n_bins = fft_size / 2 + 1;
+  float mel_low = hz_to_mel(80.0f);                      /* 80 Hz low edge */
+  float mel_high = hz_to_mel((float)sample_rate / 2.0f); /* Nyquist */
 
-  /* Mel points equally spaced */
-  float mel_points[MFCC_NUM_FILTERS + 2];
+  /* Mel points equally spaced, converted to Hz and then to FFT bin indices */
+  float bin_width = (float)sample_rate / fft_size;
   for (int i = 0; i < MFCC_NUM_FILTERS + 2; i++) {
-    mel_points[i] = mel_low + (mel_high - mel_low) * i / (MFCC_NUM_FILTERS + 1);
-  }
-
-  /* Convert to Hz and then to FFT bin indices */
-  int hz_points[MFCC_NUM_FILTERS + 2];
-  float bin_width = (float)m->sample_rate / m->fft_size;
-  for (int i = 0; i < MFCC_NUM_FILTERS + 2; i++) {
-    float hz = mel_to_hz(mel_points[i]);
+    float mel = mel_low + (mel_high - mel_low) * i / (MFCC_NUM_FILTERS + 1);
+    float hz = mel_to_hz(mel);
     hz_points[i] = (int)(hz / bin_width + 0.5f);
-    if (hz_points[i] >= m->n_bins)
-      hz_points[i] = m->n_bins - 1;
+    if (hz_points[i] >= n_bins)
+      hz_points[i] = n_bins - 1;
   }
+}
+
+/* Fill the triangular filters (weights sized by mel_filter_bins) */
+static void init_mel_filterbank(MFCC *m, const int *hz_points) {
+  m->mel_bin_lo = hz_points[0];
+  m->mel_bin_hi = hz_points[0];
 
-  /* Create triangular filters */
+  int nnz = 0;
   for (int f = 0; f < MFCC_NUM_FILTERS; f++) {
     int start = hz_points[f];
     int center = hz_points[f + 1];
     int end = hz_points[f + 2];
 
     m->mel_filter_start[f] = start;
-    m->mel_filter_end[f] = end;
+    m->mel_offset[f] = nnz;
+    if (end > m->mel_bin_hi)
+      m->mel_bin_hi = end;
 
-    for (int k = 0; k < m->n_bins; k++) {
-      if (k < start || k > end) {
-        m->mel_filters[f][k] = 0.0f;
-      } else if (k <= center) {
+    for (int k = start; k <= end; k++) {
+      if (k <= center) {
         /* Rising slope */
-        m->mel_filters[f][k] = (float)(k - start) / (center - start + 1);
+        m->mel_weights[nnz++] = (float)(k - start) / (center - start + 1);
       } else {
         /* Falling slope */
-        m->mel_filters[f][k] = (float)(end - k) / (end - center + 1);
+        m->mel_weights[nnz++] = (float)(end - k) / (end - center + 1);
       }
     }
   }
-
-  return 0;
+  m->mel_offset[MFCC_NUM_FILTERS] = nnz;
 }
 
 /* Initialize DCT matrix */
@@ -129,167 +116,84 @@ static void init_dct_matrix(MFCC *m) {
   }
 }
 
-MFCC *mfcc_create(int sample_rate, int fft_size, int hop_size,
-                  void *(*custom_alloc)(size_t)) {
-  void *(*alloc)(size_t) = custom_alloc ? custom_alloc : malloc;
+MFCC *mfcc_create(int sample_rate, int fft_size, const SimdKernels *simd,
+                  DspArena *arena) {
+  /* Size the sparse filterbank: each filter covers [start, end] */
+  int hz_points[MFCC_NUM_FILTERS + 2];
+  mel_filter_bins(sample_rate, fft_size, hz_points);
+  int nnz = 0;
+  for (int f = 0; f < MFCC_NUM_FILTERS; f++)
+    nnz += hz_points[f + 2] - hz_points[f] + 1;
 
-  MFCC *m = (MFCC *)alloc(sizeof(MFCC));
-  if (!m)
+  /* Buffers */
+  MFCC *m = (MFCC *)dsp_arena_alloc(arena, sizeof(MFCC));
+  float *dct_matrix = (float *)dsp_arena_alloc(
+      arena, MFCC_NUM_COEFFS * MFCC_NUM_FILTERS * sizeof(float));
+  float *mel_weights = (float *)dsp_arena_alloc(arena, nnz * sizeof(float));
+  float *power = (float *)dsp_arena_alloc(
+      arena,
+      (hz_points[MFCC_NUM_FILTERS + 1] - hz_points[0] + 1) * sizeof(float));
+  if (!dsp_arena_ok(arena))
     return NULL;
 
   memset(m, 0, sizeof(MFCC));
   m->sample_rate = sample_rate;
   m->fft_size = fft_size;
-  m->hop_size = hop_size;
   m->n_bins = fft_size / 2 + 1;
-  m->alloc_fn = alloc;
-
-  /* FFT */
-  m->fft_cfg = kiss_fftr_alloc(fft_size, 0, NULL, NULL);
-  if (!m->fft_cfg)
-    goto fail;
-
-  /* Buffers */
-  m->input_buffer = (float *)alloc(fft_size * sizeof(float));
-  m->window = (float *)alloc(fft_size * sizeof(float));
-  m->windowed_frame = (float *)alloc(fft_size * sizeof(float));
-  m->spectrum = (kiss_fft_cpx *)alloc(m->n_bins * sizeof(kiss_fft_cpx));
-  m->power_spectrum = (float *)alloc(m->n_bins * sizeof(float));
-  m->mel_energies = (float *)alloc(MFCC_NUM_FILTERS * sizeof(float));
-  m->dct_matrix =
-      (float *)alloc(MFCC_NUM_COEFFS * MFCC_NUM_FILTERS * sizeof(float));
-
-  /* Mel filterbank */
-  m->mel_filters = (float **)alloc(MFCC_NUM_FILTERS * sizeof(float *));
-  m->mel_filter_start = (int *)alloc(MFCC_NUM_FILTERS * sizeof(int));
-  m->mel_filter_end = (int *)alloc(MFCC_NUM_FILTERS * sizeof(int));
-
-  if (!m->input_buffer || !m->window || !m->windowed_frame || !m->spectrum ||
-      !m->power_spectrum || !m->mel_energies || !m->dct_matrix ||
-      !m->mel_filters || !m->mel_filter_start || !m->mel_filter_end) {
-    goto fail;
-  }
-
-  for (int f = 0; f < MFCC_NUM_FILTERS; f++) {
-    m->mel_filters[f] = (float *)alloc(m->n_bins * sizeof(float));
-    if (!m->mel_filters[f])
-      goto fail;
-  }
+  m->simd = simd;
+  m->dct_matrix = dct_matrix;
+  m->mel_weights = mel_weights;
+  m->power = power;
 
   /* Initialize */
-  memset(m->input_buffer, 0, fft_size * sizeof(float));
   memset(m->coeffs, 0, sizeof(m->coeffs));
   memset(m->prev_coeffs, 0, sizeof(m->prev_coeffs));
 
-  /* Hann window */
-  for (int i = 0; i < fft_size; i++) {
-    m->window[i] =
-        0.5f * (1.0f - cosf(2.0f * (float)M_PI * i / (fft_size - 1)));
-  }
-
-  init_mel_filterbank(m);
+  init_mel_filterbank(m, hz_points);
   init_dct_matrix(m);
 
   return m;
-
-fail:
-  mfcc_destroy(m, alloc == malloc ? free : NULL);
-  return NULL;
 }
 
 void mfcc_reset(MFCC *m) {
   if (!m)
     return;
 
-  memset(m->input_buffer, 0, m->fft_size * sizeof(float));
   memset(m->coeffs, 0, sizeof(m->coeffs));
   memset(m->prev_coeffs, 0, sizeof(m->prev_coeffs));
-  m->input_write_pos = 0;
-  m->samples_since_hop = 0;
   m->delta_magnitude = 0.0f;
 }
 
-void mfcc_destroy(MFCC *m, void (*custom_free)(void *)) {
-  if (!m)
-    return;
+float mfcc_process_frame(MFCC *m, const float *spectrum) {
+  /* Not one fused kernel: neighbouring triangles share bins, so the power is
+   * computed once into m->power and each later pass reads the previous
+   * one's output, which stays in L1 */
 
-  void (*free_fn)(void *) = custom_free ? custom_free : free;
-
-  if (m->fft_cfg)
-    kiss_fftr_free(m->fft_cfg);
-  if (m->input_buffer)
-    free_fn(m->input_buffer);
-  if (m->window)
-    free_fn(m->window);
-  if (m->windowed_frame)
-    free_fn(m->windowed_frame);
-  if (m->spectrum)
-    free_fn(m->spectrum);
-  if (m->power_spectrum)
-    free_fn(m->power_spectrum);
-  if (m->mel_energies)
-    free_fn(m->mel_energies);
-  if (m->dct_matrix)
-    free_fn(m->dct_matrix);
-
-  if (m->mel_filters) {
-    for (int f = 0; f < MFCC_NUM_FILTERS; f++) {
-      if (m->mel_filters[f])
-        free_fn(m->mel_filters[f]);
-    }
-    free_fn(m->mel_filters);
-  }
-  if (m->mel_filter_start)
-    free_fn(m->mel_filter_start);
-  if (m->mel_filter_end)
-    free_fn(m->mel_filter_end);
-
-  free_fn(m);
-}
-
-/* Compute MFCC for current frame */
-static void compute_mfcc(MFCC *m) {
-  /* Rearrange ring buffer */
-  int read_start = m->input_write_pos;
-  for (int i = 0; i < m->fft_size; i++) {
-    int idx = (read_start + i) % m->fft_size;
-    m->windowed_frame[i] = m->input_buffer[idx];
-  }
-
-  /* Apply window */
-  simd_apply_window_f32(m->windowed_frame, m->window, m->fft_size);
-
-  /* FFT */
-  kiss_fftr(m->fft_cfg, m->windowed_frame, m->spectrum);
-
-  /* Power spectrum */
-  for (int k = 0; k < m->n_bins; k++) {
-    float r = m->spectrum[k].r;
-    float im = m->spectrum[k].i;
-    m->power_spectrum[k] = r * r + im * im;
-  }
+  /* Power of the bins any filter reads (SIMD optimized) */
+  int lo = m->mel_bin_lo;
+  m->simd->power(spectrum + 2 * lo, m->power, m->mel_bin_hi - lo + 1);
 
-  /* Apply Mel filterbank */
+  /* Apply Mel filterbank: one contiguous dot product per sparse row */
   for (int f = 0; f < MFCC_NUM_FILTERS; f++) {
-    float energy = 0.0f;
-    int start = m->mel_filter_start[f];
-    int end = m->mel_filter_end[f];
+    int offset = m->mel_offset[f];
+    float energy = m->simd->dot_product(
+        m->mel_weights + offset, m->power + (m->mel_filter_start[f] - lo),
+        m->mel_offset[f + 1] - offset);
 
-    for (int k = start; k <= end; k++) {
-      energy += m->power_spectrum[k] * m->mel_filters[f][k];
-    }
-
-    /* Log compression (add small epsilon for numerical stability) */
-    m->mel_energies[f] = logf(energy + 1e-10f);
+    /* Small epsilon for numerical stability of the log */
+    m->mel_energies[f] = energy + 1e-10f;
   }
 
+  /* Log compression (SIMD optimized) */
+  m->simd->log(m->mel_energies, m->mel_energies, MFCC_NUM_FILTERS);
+
   /* Save previous coefficients for delta */
   memcpy(m->prev_coeffs, m->coeffs, sizeof(m->coeffs));
 
   /* DCT to get MFCC (SIMD optimized dot products) */
   for (int i = 0; i < MFCC_NUM_COEFFS; i++) {
-    m->coeffs[i] = simd_dot_product_f32(&m->dct_matrix[i * MFCC_NUM_FILTERS],
-                                        m->mel_energies, MFCC_NUM_FILTERS);
+    m->coeffs[i] = m->simd->dot_product(&m->dct_matrix[i * MFCC_NUM_FILTERS],
+                                         m->mel_energies, MFCC_NUM_FILTERS);
   }
 
   /* Compute delta magnitude (L2 norm of difference) */
@@ -299,28 +203,8 @@ static void compute_mfcc(MFCC *m) {
     delta_sum += d * d;
   }
   m->delta_magnitude = sqrtf(delta_sum);
-}
-
-int mfcc_process(MFCC *m, const float *input, int num_samples, float *delta_out,
-                 int max_delta) {
-  int delta_count = 0;
-
-  for (int i = 0; i < num_samples; i++) {
-    m->input_buffer[m->input_write_pos] = input[i];
-    m->input_write_pos = (m->input_write_pos + 1) % m->fft_size;
-    m->samples_since_hop++;
-
-    if (m->samples_since_hop >= m->hop_size) {
-      m->samples_since_hop = 0;
-      compute_mfcc(m);
-
-      if (delta_out && delta_count < max_delta) {
-        delta_out[delta_count++] = m->delta_magnitude;
-      }
-    }
-  }
 
-  return delta_count;
+  return m->delta_magnitude;
 }
 
 void mfcc_get_coeffs(const MFCC *m, float *coeffs_out) {
@@ -8,6 +8,8 @@
 #ifndef MFCC_H
 #define MFCC_H
 
+#include "arena.h"
+#include "simd_dispatch.h"
 #include <stddef.h>
 
 #ifdef __cplusplus
@@ -25,26 +27,28 @@ typedef struct MFCC MFCC;
 /*
  * Create MFCC calculator
  *
+ * MFCC consumes the complex spectra produced by the shared STFT front-end
+ * (see stft.h) and only squares the bins its filterbank reads; it does not
+ * own an FFT of its own.
+ *
  * @param sample_rate   Audio sample rate (Hz)
- * @param fft_size      FFT size (must match spectral_flux if sharing)
- * @param hop_size      Hop size in samples
- * @param custom_alloc  Custom allocator (NULL for malloc)
+ * @param fft_size      FFT size of the front-end feeding it
+ * @param simd          Kernels to run with (see simd_dispatch.h)
+ * @param arena         Memory for the calculator (see arena.h); NULL return
+ *                      while measuring
  */
-MFCC *mfcc_create(int sample_rate, int fft_size, int hop_size,
-                  void *(*custom_alloc)(size_t));
+MFCC *mfcc_create(int sample_rate, int fft_size, const SimdKernels *simd,
+                  DspArena *arena);
 
 /*
- * Process samples and compute delta-MFCC magnitude
+ * Compute MFCCs and delta-MFCC magnitude for one analysis frame
  *
  * @param mfcc          MFCC object
- * @param input         Input audio samples
- * @param num_samples   Number of samples
- * @param delta_out     Output buffer for delta-MFCC L2 norms (one per hop)
- * @param max_delta     Maximum output values
- * @return              Number of values written
+ * @param spectrum      Complex spectrum as interleaved [r0,i0,r1,i1,...],
+ *                      fft_size/2 + 1 bins (see stft_get_spectrum)
+ * @return              Delta-MFCC L2 norm for this frame
  */
-int mfcc_process(MFCC *mfcc, const float *input, int num_samples,
-                 float *delta_out, int max_delta);
+float mfcc_process_frame(MFCC *mfcc, const float *spectrum);
 
 /*
  * Get current MFCC coefficients
@@ -64,11 +68,6 @@ float mfcc_get_delta_magnitude(const MFCC *mfcc);
  */
 void mfcc_reset(MFCC *mfcc);
 
-/*
- * Destroy and free resources
- */
-void mfcc_destroy(MFCC *mfcc, void (*custom_free)(void *));
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,186 @@
+/*
+ * resampler.c - Rational-ratio polyphase resampler
+ *
+ * Output k stands for time k * down on the upsampled grid. Its newest input
+ * is x[k * down / up], and its phase (k * down) % up picks the filter taps
+ * that fall on input samples. Each phase is stored reversed, oldest input
+ * first, and history[] holds the last taps_per_phase - 1 input samples ahead
+ * of the current block, so every output's window is contiguous.
+ */
+
+#include "resampler.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Kaiser window shape for about -50 dB stopband */
+#define RESAMPLER_KAISER_BETA 4.55
+
+struct Resampler {
+  int up;   /* Outputs per down inputs (reduced) */
+  int down; /* Inputs per up outputs (reduced) */
+  int taps_per_phase;
+  int max_block;
+  const SimdKernels *simd;
+  float *taps;    /* [up][taps_per_phase], each phase oldest input first */
+  float *history; /* [taps_per_phase - 1 + max_block] */
+
+  int next_in;    /* Newest input of the next output, from the block start */
+  int next_phase; /* Filter phase of the next output */
+};
+
+static int gcd_int(int a, int b) {
+  while (b) {
+    int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/* Reduce in_rate -> out_rate to up / down; 0 if unsupported */
+static int reduce_ratio(int in_rate, int out_rate, int *up, int *down) {
+  if (in_rate <= 0 || out_rate <= 0 || in_rate == out_rate)
+    return 0;
+  int g = gcd_int(in_rate, out_rate);
+  *up = out_rate / g;
+  *down = in_rate / g;
+  return *up <= RESAMPLER_MAX_PHASES;
+}
+
+/* Taps per phase: RESAMPLER_TAPS_PER_PERIOD periods of the lower rate */
+static int phase_length(int up, int down) {
+  int period = up > down ? up : down;
+  return (RESAMPLER_TAPS_PER_PERIOD * period + up - 1) / up;
+}
+
+/* Modified Bessel function of the first kind, order 0 (power series) */
+static double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 32; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+/* Low-pass on the upsampled grid, cut off midway between the passband and
+ * the Nyquist frequency of the lower rate, Kaiser windowed. Each phase is
+ * scaled to unity gain at DC, so a constant input resamples exactly. */
+static void design_filter(float *taps, int up, int down, int per_phase) {
+  int len = up * per_phase;
+  double period = up > down ? up : down;
+  double cutoff = 0.5 * (RESAMPLER_PASSBAND + 0.5);
+  double center = 0.5 * (len - 1);
+  double norm = bessel_i0(RESAMPLER_KAISER_BETA);
+
+  for (int p = 0; p < up; p++) {
+    float *phase = taps + (size_t)p * per_phase;
+    double sum = 0.0;
+    for (int j = 0; j < per_phase; j++) {
+      int i = p + j * up; /* Delay of the tap on the upsampled grid */
+      double m = 2.0 * cutoff * (i - center) / period;
+      double ideal = m == 0.0 ? 1.0 : sin(M_PI * m) / (M_PI * m);
+      double r = (i - center) / center;
+      double kaiser =
+          bessel_i0(RESAMPLER_KAISER_BETA * sqrt(1.0 - r * r)) / norm;
+      phase[per_phase - 1 - j] = (float)(ideal * kaiser);
+      sum += ideal * kaiser;
+    }
+    for (int j = 0; j < per_phase; j++)
+      phase[j] = (float)(phase[j] / sum);
+  }
+}
+
+int resampler_max_input(int in_rate, int out_rate, int max_output) {
+  int up, down;
+  if (!reduce_ratio(in_rate, out_rate, &up, &down))
+    return 0;
+  /* n inputs span n * up grid steps, holding at most ceil(n * up / down)
+   * outputs */
+  return (int)((int64_t)max_output * down / up);
+}
+
+Resampler *resampler_create(int in_rate, int out_rate, int max_block,
+                            const SimdKernels *simd, DspArena *arena) {
+  int up, down;
+  if (!reduce_ratio(in_rate, out_rate, &up, &down) || max_block < 1)
+    return NULL;
+  int per_phase = phase_length(up, down);
+
+  Resampler *rs = (Resampler *)dsp_arena_alloc(arena, sizeof(Resampler));
+  float *taps = (float *)dsp_arena_alloc(
+      arena, (size_t)up * per_phase * sizeof(float));
+  float *history = (float *)dsp_arena_alloc(
+      arena, (size_t)(per_phase - 1 + max_block) * sizeof(float));
+  if (!dsp_arena_ok(arena))
+    return NULL;
+
+  rs->up = up;
+  rs->down = down;
+  rs->taps_per_phase = per_phase;
+  rs->max_block = max_block;
+  rs->simd = simd;
+  rs->taps = taps;
+  rs->history = history;
+  design_filter(taps, up, down, per_phase);
+  resampler_reset(rs);
+  return rs;
+}
+
+int resampler_process_block(Resampler *rs, const float *in, int n,
+                            float *out) {
+  const int keep = rs->taps_per_phase - 1;
+  const int step_in = rs->down / rs->up;
+  const int step_phase = rs->down % rs->up;
+  float *h = rs->history;
+  memcpy(h + keep, in, (size_t)n * sizeof(float));
+
+  /* The window of the output whose newest input is in[i] ends at
+   * h[keep + i], so it starts at h[i] */
+  int count = 0;
+  int i = rs->next_in;
+  int phase = rs->next_phase;
+  while (i < n) {
+    out[count++] = rs->simd->dot_product(
+        rs->taps + (size_t)phase * rs->taps_per_phase, h + i,
+        rs->taps_per_phase);
+    i += step_in;
+    phase += step_phase;
+    if (phase >= rs->up) {
+      phase -= rs->up;
+      i++;
+    }
+  }
+
+  rs->next_in = i - n;
+  rs->next_phase = phase;
+  memmove(h, h + n, (size_t)keep * sizeof(float));
+  return count;
+}
+
+uint64_t resampler_input_position(const Resampler *rs, uint64_t index) {
+  /* Output index is at grid time index * down; the filter delays it by half
+   * its length. Both doubled to stay in integers, then rounded. */
+  uint64_t len = (uint64_t)rs->up * rs->taps_per_phase;
+  uint64_t t2 = 2 * index * (uint64_t)rs->down + (uint64_t)rs->up;
+  if (t2 < len - 1)
+    return 0;
+  return (t2 - (len - 1)) / (2 * (uint64_t)rs->up);
+}
+
+void resampler_ratio(const Resampler *rs, int *up, int *down) {
+  *up = rs->up;
+  *down = rs->down;
+}
+
+void resampler_reset(Resampler *rs) {
+  memset(rs->history, 0,
+         (size_t)(rs->taps_per_phase - 1 + rs->max_block) * sizeof(float));
+  rs->next_in = 0;
+  rs->next_phase = 0;
+}
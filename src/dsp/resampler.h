@@ -0,0 +1,89 @@
+/*
+ * resampler.h - Rational-ratio polyphase resampler
+ *
+ * Converts the input to the detector's analysis rate, so that every stage
+ * after it runs with the same time constants, FFT sizes and kernel lengths
+ * whatever rate the audio arrives at.
+ *
+ * The rate ratio is reduced to up / down: the input is conceptually
+ * upsampled by up, low-pass filtered and kept every down samples. The filter
+ * is a Kaiser-windowed sinc spanning RESAMPLER_TAPS_PER_PERIOD periods of the
+ * lower of the two rates, flat to RESAMPLER_PASSBAND of it and about -50 dB
+ * from half of it on, so nothing aliases or images below the Nyquist
+ * frequency of the lower rate. It is split into up phases of equal length, and
+ * each output is one SIMD dot product of one phase with the input history.
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include "arena.h"
+#include "simd_dispatch.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RESAMPLER_TAPS_PER_PERIOD 32
+
+/* Highest frequency kept intact, as a fraction of the lower rate */
+#define RESAMPLER_PASSBAND 0.4f
+
+/* Most filter phases (up, in the reduced ratio) a resampler accepts */
+#define RESAMPLER_MAX_PHASES 1024
+
+typedef struct Resampler Resampler;
+
+/*
+ * Longest input block whose output never exceeds max_output samples, or 0
+ * if the ratio is not supported (see resampler_create)
+ */
+int resampler_max_input(int in_rate, int out_rate, int max_output);
+
+/*
+ * Create a resampler
+ *
+ * @param in_rate    Input sample rate (Hz)
+ * @param out_rate   Output sample rate (Hz), different from in_rate; the
+ *                   reduced ratio may have at most RESAMPLER_MAX_PHASES as
+ *                   numerator (e.g. 44100 -> 16000 is 160 / 441)
+ * @param max_block  Longest block resampler_process_block will be given
+ * @param simd       Kernels to run with (see simd_dispatch.h)
+ * @param arena      Memory for the filter and history (see arena.h); NULL
+ *                   return while measuring
+ */
+Resampler *resampler_create(int in_rate, int out_rate, int max_block,
+                            const SimdKernels *simd, DspArena *arena);
+
+/*
+ * Resample n (<= max_block) input samples. Outputs fall on a fixed grid
+ * counted from creation (or reset), whatever the block lengths.
+ *
+ * @return           Number of outputs written, at most ceil(n * up / down)
+ */
+int resampler_process_block(Resampler *rs, const float *in, int n,
+                            float *out);
+
+/*
+ * Input sample that output number index (counted from creation or reset)
+ * stands for, net of the filter delay and rounded; 0 for outputs before the
+ * first input sample
+ */
+uint64_t resampler_input_position(const Resampler *rs, uint64_t index);
+
+/*
+ * Reduced rate ratio: up outputs for every down inputs
+ */
+void resampler_ratio(const Resampler *rs, int *up, int *down);
+
+/*
+ * Clear the input history and restart the output grid
+ */
+void resampler_reset(Resampler *rs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESAMPLER_H */
@@ -0,0 +1,248 @@
+/*
+ * running_median.c - Exact median and MAD over a sliding window
+ *
+ * The window is an indexable skip list: every link also records how many
+ * level-0 steps it spans, so the k-th smallest value is found in O(log n)
+ * by walking down the levels. Node i holds ring slot i, so the oldest value
+ * is always the node about to be reused and no free list is needed. Ties
+ * are ordered by arrival, which makes every key distinct and lets a removal
+ * find its node by search alone.
+ *
+ * For a median m splitting the window at p (p values below m), the
+ * deviations |x - m| form two ascending runs: m - x[p - 1 - t] to the left
+ * and x[p + t] - m to the right, where x[i] is the i-th smallest value. The
+ * MAD is an order statistic of their union, found by the usual binary
+ * search over how many values the left run contributes, with x[i] looked up
+ * in the list (O(log^2 n) in all).
+ */
+
+#include "running_median.h"
+#include <stdint.h>
+
+/* Link to the end of the list (past the largest value) */
+#define NIL (-1)
+
+#define RUNNING_MEDIAN_MAX_LEVELS 24
+
+struct RunningMedian {
+  int capacity;
+  int levels;    /* Links per node */
+  int count;
+  int oldest;    /* Ring slot (= node) of the oldest value once full */
+  int head;      /* Node capacity: the list head, before every value */
+  uint32_t rng;  /* Node heights, reseeded on reset */
+  uint64_t seq;  /* Arrival number of the next value */
+  float *value;  /* Per node */
+  uint64_t *arrival;
+  int *next;     /* next[node * levels + l]: successor at level l */
+  int *width;    /* Level-0 steps the same link spans */
+};
+
+/* Whether node a sorts before the key (v, s) */
+static int node_before(const RunningMedian *rm, int a, float v, uint64_t s) {
+  if (a == NIL)
+    return 0;
+  return rm->value[a] < v || (rm->value[a] == v && rm->arrival[a] < s);
+}
+
+/* Height of a new node: each further level with probability 1/2 */
+static int random_height(RunningMedian *rm) {
+  uint32_t x = rm->rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  rm->rng = x;
+  int h = 1;
+  while (h < rm->levels && (x & 1)) {
+    x >>= 1;
+    h++;
+  }
+  return h;
+}
+
+RunningMedian *running_median_create(int capacity, DspArena *arena) {
+  if (capacity < 1)
+    capacity = 1;
+  int levels = 1;
+  while (levels < RUNNING_MEDIAN_MAX_LEVELS && (1 << (levels - 1)) < capacity)
+    levels++;
+
+  size_t nodes = (size_t)capacity + 1;
+  RunningMedian *rm =
+      (RunningMedian *)dsp_arena_alloc(arena, sizeof(RunningMedian));
+  float *value = (float *)dsp_arena_alloc(arena, nodes * sizeof(float));
+  uint64_t *arrival =
+      (uint64_t *)dsp_arena_alloc(arena, nodes * sizeof(uint64_t));
+  int *next = (int *)dsp_arena_alloc(arena, nodes * levels * sizeof(int));
+  int *width = (int *)dsp_arena_alloc(arena, nodes * levels * sizeof(int));
+  if (!dsp_arena_ok(arena))
+    return NULL;
+
+  rm->capacity = capacity;
+  rm->levels = levels;
+  rm->head = capacity;
+  rm->value = value;
+  rm->arrival = arrival;
+  rm->next = next;
+  rm->width = width;
+  running_median_reset(rm);
+  return rm;
+}
+
+/* Unlink node, the oldest value */
+static void remove_node(RunningMedian *rm, int node) {
+  int L = rm->levels;
+  float v = rm->value[node];
+  uint64_t s = rm->arrival[node];
+  int x = rm->head;
+  for (int l = L - 1; l >= 0; l--) {
+    while (node_before(rm, rm->next[x * L + l], v, s))
+      x = rm->next[x * L + l];
+    if (rm->next[x * L + l] == node) {
+      rm->next[x * L + l] = rm->next[node * L + l];
+      rm->width[x * L + l] += rm->width[node * L + l] - 1;
+    } else {
+      rm->width[x * L + l]--;
+    }
+  }
+}
+
+/* Link node holding a new value */
+static void insert_node(RunningMedian *rm, int node) {
+  int L = rm->levels;
+  float v = rm->value[node];
+  uint64_t s = rm->arrival[node];
+  int h = random_height(rm);
+  int update[RUNNING_MEDIAN_MAX_LEVELS];
+  int rank[RUNNING_MEDIAN_MAX_LEVELS]; /* Values up to update[l] */
+  int x = rm->head;
+  int r = 0;
+  for (int l = L - 1; l >= 0; l--) {
+    while (node_before(rm, rm->next[x * L + l], v, s)) {
+      r += rm->width[x * L + l];
+      x = rm->next[x * L + l];
+    }
+    update[l] = x;
+    rank[l] = r;
+  }
+
+  for (int l = 0; l < L; l++) {
+    int u = update[l] * L + l;
+    if (l < h) {
+      int before = r - rank[l]; /* Steps from update[l] to the new node - 1 */
+      rm->next[node * L + l] = rm->next[u];
+      rm->width[node * L + l] = rm->width[u] - before;
+      rm->next[u] = node;
+      rm->width[u] = before + 1;
+    } else {
+      rm->width[u]++;
+    }
+  }
+}
+
+void running_median_push(RunningMedian *rm, float value) {
+  int node;
+  if (rm->count < rm->capacity) {
+    node = rm->count++;
+  } else {
+    node = rm->oldest;
+    rm->oldest = node + 1 == rm->capacity ? 0 : node + 1;
+    remove_node(rm, node);
+  }
+  rm->value[node] = value;
+  rm->arrival[node] = rm->seq++;
+  insert_node(rm, node);
+}
+
+int running_median_count(const RunningMedian *rm) {
+  return rm ? rm->count : 0;
+}
+
+/* k-th smallest value (0-based, k < count) */
+static float kth_value(const RunningMedian *rm, int k) {
+  int L = rm->levels;
+  int x = rm->head;
+  int left = k + 1; /* Level-0 steps still to take */
+  for (int l = L - 1; l >= 0; l--) {
+    while (rm->next[x * L + l] != NIL && rm->width[x * L + l] <= left) {
+      left -= rm->width[x * L + l];
+      x = rm->next[x * L + l];
+    }
+  }
+  return rm->value[x];
+}
+
+/* Number of values below v */
+static int count_below(const RunningMedian *rm, float v) {
+  int L = rm->levels;
+  int x = rm->head;
+  int r = 0;
+  for (int l = L - 1; l >= 0; l--) {
+    int n;
+    while ((n = rm->next[x * L + l]) != NIL && rm->value[n] < v) {
+      r += rm->width[x * L + l];
+      x = n;
+    }
+  }
+  return r;
+}
+
+float running_median_get(const RunningMedian *rm) {
+  if (!rm || rm->count == 0)
+    return 0.0f;
+  int n = rm->count;
+  if (n & 1)
+    return kth_value(rm, n >> 1);
+  return 0.5f * (kth_value(rm, (n >> 1) - 1) + kth_value(rm, n >> 1));
+}
+
+/*
+ * k-th smallest (0-based) deviation from m, with p values below m
+ */
+static float kth_deviation(const RunningMedian *rm, int p, float m, int k) {
+  int left = p, right = rm->count - p;
+  int take = k + 1; /* Values taken from the union */
+  int lo = take > right ? take - right : 0;
+  int hi = take < left ? take : left;
+
+  for (;;) {
+    int a = (lo + hi) >> 1; /* Taken from the left run */
+    int b = take - a;       /* Taken from the right run */
+    if (a < left && b > 0 &&
+        kth_value(rm, p + b - 1) - m > m - kth_value(rm, p - 1 - a)) {
+      lo = a + 1; /* Left run's next value is smaller: take more of it */
+    } else if (a > 0 && b < right &&
+               m - kth_value(rm, p - a) > kth_value(rm, p + b) - m) {
+      hi = a - 1; /* Left run overshoots */
+    } else {
+      float dl = a > 0 ? m - kth_value(rm, p - a) : 0.0f;
+      float dr = b > 0 ? kth_value(rm, p + b - 1) - m : 0.0f;
+      return dl > dr ? dl : dr;
+    }
+  }
+}
+
+float running_median_mad(const RunningMedian *rm) {
+  if (!rm || rm->count == 0)
+    return 0.0f;
+  int n = rm->count;
+  float m = running_median_get(rm);
+  int p = count_below(rm, m);
+  if (n & 1)
+    return kth_deviation(rm, p, m, n >> 1);
+  return 0.5f * (kth_deviation(rm, p, m, (n >> 1) - 1) +
+                 kth_deviation(rm, p, m, n >> 1));
+}
+
+void running_median_reset(RunningMedian *rm) {
+  if (!rm)
+    return;
+  rm->count = 0;
+  rm->oldest = 0;
+  rm->seq = 0;
+  rm->rng = 0x2545f491u;
+  for (int l = 0; l < rm->levels; l++) {
+    rm->next[rm->head * rm->levels + l] = NIL;
+    rm->width[rm->head * rm->levels + l] = 1;
+  }
+}
@@ -0,0 +1,62 @@
+/*
+ * running_median.h - Exact median and MAD over a sliding window
+ *
+ * Keeps the last `capacity` values in an indexable skip list. A push
+ * replaces the oldest value in O(log n), the median is an O(log n) rank
+ * lookup, and the MAD (median absolute deviation from the median) a binary
+ * search over the two sorted runs of deviations either side of the median,
+ * O(log^2 n).
+ */
+
+#ifndef RUNNING_MEDIAN_H
+#define RUNNING_MEDIAN_H
+
+#include "arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct RunningMedian RunningMedian;
+
+/*
+ * Create a window of the last capacity values
+ *
+ * @param capacity  Window length (>= 1)
+ * @param arena     Memory for the window (see arena.h); NULL return while
+ *                  measuring
+ */
+RunningMedian *running_median_create(int capacity, DspArena *arena);
+
+/*
+ * Add a value, dropping the oldest once the window is full. Values must not
+ * be NaN.
+ */
+void running_median_push(RunningMedian *rm, float value);
+
+/*
+ * Number of values in the window
+ */
+int running_median_count(const RunningMedian *rm);
+
+/*
+ * Median of the window (mean of the middle two for an even count); 0 when
+ * empty
+ */
+float running_median_get(const RunningMedian *rm);
+
+/*
+ * Median absolute deviation from the median; 0 when empty
+ */
+float running_median_mad(const RunningMedian *rm);
+
+/*
+ * Empty the window
+ */
+void running_median_reset(RunningMedian *rm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RUNNING_MEDIAN_H */
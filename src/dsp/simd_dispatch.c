@@ -0,0 +1,162 @@
+/*
+ * simd_dispatch.c - CPU feature detection and kernel table selection
+ *
+ * The AVX2 and AVX-512 tables exist only when the build compiled them
+ * (SIMD_HAVE_AVX2_KERNELS / SIMD_HAVE_AVX512_KERNELS, set by CMakeLists.txt).
+ * A table is usable when the CPU reports the instructions (cpuid) and the OS
+ * saves the register state they need (xgetbv).
+ */
+
+#include "simd_dispatch.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||             \
+    defined(_M_IX86)
+#define SIMD_DISPATCH_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+extern const SimdKernels simd_kernels_scalar;
+extern const SimdKernels simd_kernels_baseline;
+#ifdef SIMD_HAVE_AVX2_KERNELS
+extern const SimdKernels simd_kernels_avx2;
+#endif
+#ifdef SIMD_HAVE_AVX512_KERNELS
+extern const SimdKernels simd_kernels_avx512;
+#endif
+
+#ifdef SIMD_DISPATCH_X86
+
+/* cpuid leaf (and subleaf) into regs[4] = eax, ebx, ecx, edx; 0 if the leaf
+ * is beyond the CPU's maximum */
+static int cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER)
+  int r[4];
+  __cpuid(r, 0);
+  if ((unsigned)r[0] < leaf)
+    return 0;
+  __cpuidex(r, (int)leaf, (int)subleaf);
+  for (int i = 0; i < 4; i++)
+    regs[i] = (unsigned)r[i];
+  return 1;
+#else
+  if (__get_cpuid_max(0, NULL) < leaf)
+    return 0;
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+  return 1;
+#endif
+}
+
+/* XCR0: register state the OS saves on context switches */
+static uint64_t xgetbv0(void) {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  unsigned lo, hi;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+/* Widest ISA both the CPU and the OS support */
+static SimdIsa detect_isa(void) {
+  unsigned r1[4], r7[4];
+  if (!cpuid(1, 0, r1))
+    return SIMD_ISA_SCALAR;
+  SimdIsa isa = (r1[3] & (1u << 26)) ? SIMD_ISA_SSE2 : SIMD_ISA_SCALAR;
+
+  int osxsave = (r1[2] & (1u << 27)) != 0;
+  int avx = (r1[2] & (1u << 28)) != 0;
+  int fma = (r1[2] & (1u << 12)) != 0;
+  if (!osxsave || !avx || !cpuid(7, 0, r7))
+    return isa;
+
+  uint64_t xcr0 = xgetbv0();
+  int ymm_state = (xcr0 & 0x6) == 0x6;   /* SSE, AVX */
+  int zmm_state = (xcr0 & 0xe6) == 0xe6; /* + opmask, ZMM_Hi256, Hi16_ZMM */
+  int avx2 = (r7[1] & (1u << 5)) != 0;
+  int avx512 = (r7[1] & (1u << 16)) && (r7[1] & (1u << 30)) &&
+               (r7[1] & (1u << 31)); /* F, BW, VL */
+
+  if (ymm_state && avx2 && fma) {
+    isa = SIMD_ISA_AVX2;
+    if (zmm_state && avx512)
+      isa = SIMD_ISA_AVX512;
+  }
+  return isa;
+}
+
+#endif /* SIMD_DISPATCH_X86 */
+
+/* Widest ISA this host runs */
+static SimdIsa host_isa(void) {
+#ifdef SIMD_DISPATCH_X86
+  return detect_isa();
+#else
+  /* Elsewhere the baseline is all there is, and always supported */
+  return simd_kernels_baseline.isa;
+#endif
+}
+
+/* Widest compiled table at or below isa */
+static const SimdKernels *table_for(SimdIsa isa) {
+#ifdef SIMD_HAVE_AVX512_KERNELS
+  if (isa >= SIMD_ISA_AVX512)
+    return &simd_kernels_avx512;
+#endif
+#ifdef SIMD_HAVE_AVX2_KERNELS
+  if (isa >= SIMD_ISA_AVX2)
+    return &simd_kernels_avx2;
+#endif
+  if (isa >= simd_kernels_baseline.isa)
+    return &simd_kernels_baseline;
+  return &simd_kernels_scalar;
+}
+
+const SimdKernels *simd_select_kernels(void) {
+  SimdIsa isa = host_isa();
+
+  const char *cap = getenv("SYLLABLE_SIMD");
+  if (cap) {
+    SimdIsa limit = isa;
+    if (strcmp(cap, "scalar") == 0)
+      limit = SIMD_ISA_SCALAR;
+    else if (strcmp(cap, "baseline") == 0 || strcmp(cap, "sse2") == 0 ||
+             strcmp(cap, "neon") == 0)
+      limit = simd_kernels_baseline.isa;
+    else if (strcmp(cap, "avx2") == 0)
+      limit = SIMD_ISA_AVX2;
+    else if (strcmp(cap, "avx512") == 0)
+      limit = SIMD_ISA_AVX512;
+    if (limit < isa)
+      isa = limit;
+  }
+  return table_for(isa);
+}
+
+const SimdKernels *simd_get_kernels(SimdIsa isa) {
+  if (isa > host_isa())
+    return NULL;
+  const SimdKernels *k = table_for(isa);
+  return k->isa == isa ? k : NULL;
+}
+
+const char *simd_isa_name(SimdIsa isa) {
+  switch (isa) {
+  case SIMD_ISA_SSE2:
+    return "sse2";
+  case SIMD_ISA_NEON:
+    return "neon";
+  case SIMD_ISA_AVX2:
+    return "avx2";
+  case SIMD_ISA_AVX512:
+    return "avx512";
+  default:
+    return "scalar";
+  }
+}
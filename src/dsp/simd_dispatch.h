@@ -0,0 +1,79 @@
+/*
+ * simd_dispatch.h - Runtime selection of the simd_utils.h kernels
+ *
+ * The library is compiled for the target's baseline ISA (SSE2 on x86-64).
+ * The kernels of simd_utils.h are compiled once more per instruction set,
+ * each simd_kernels_<isa>.c with its own flags, into SimdKernels tables.
+ * simd_select_kernels() picks the widest table the CPU and OS support;
+ * modules take the table at create time and call through it.
+ *
+ * For testing, the environment variable SYLLABLE_SIMD (scalar, baseline,
+ * sse2, neon, avx2 or avx512) caps the choice. A path the host cannot run
+ * falls back to the widest one it can. AVX-512 means F, BW and VL, as on
+ * every AVX-512 server core since Skylake.
+ */
+
+#ifndef SIMD_DISPATCH_H
+#define SIMD_DISPATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* In order of preference on their architecture */
+typedef enum {
+  SIMD_ISA_SCALAR = 0,
+  SIMD_ISA_SSE2,
+  SIMD_ISA_NEON,
+  SIMD_ISA_AVX2,
+  SIMD_ISA_AVX512
+} SimdIsa;
+
+/* The simd_utils.h functions of one ISA (see there for each contract) */
+typedef struct {
+  SimdIsa isa;
+  float (*dot_product)(const float *a, const float *b, size_t n);
+  void (*complex_dot)(const float *x, const float *br, const float *bi,
+                      size_t n, float *out_r, float *out_i);
+  float (*sum_squares)(const float *a, size_t n);
+  float (*hwr_diff_sum)(const float *a, const float *b, size_t n);
+  void (*apply_window)(float *data, const float *window, size_t n);
+  void (*window_copy)(const float *data, const float *window, float *out,
+                      size_t n);
+  void (*magnitude)(const float *cpx, float *mag, size_t n_complex);
+  void (*power)(const float *cpx, float *power, size_t n_complex);
+  void (*log)(const float *in, float *out, size_t n);
+  void (*exp)(const float *in, float *out, size_t n);
+  float (*spectral_stats)(const float *cpx, float *mag, size_t n_complex,
+                          float *log_sum, float *arith_sum, int *valid);
+  void (*i16_to_f32)(const int16_t *in, float *out, size_t n, float scale);
+  void (*i16_stereo_to_f32)(const int16_t *in, float *out, size_t n,
+                            int channel, float scale);
+  void (*i24_to_f32)(const uint8_t *in, float *out, size_t n, float scale);
+  void (*i32_to_f32)(const int32_t *in, float *out, size_t n, float scale);
+} SimdKernels;
+
+/*
+ * Kernels for this host: the widest supported table, capped by SYLLABLE_SIMD
+ */
+const SimdKernels *simd_select_kernels(void);
+
+/*
+ * Kernels of exactly one ISA, for tests and benchmarks; NULL when they were
+ * not built or this host cannot run them. SYLLABLE_SIMD does not apply.
+ */
+const SimdKernels *simd_get_kernels(SimdIsa isa);
+
+/*
+ * Lower-case name of an ISA ("scalar", "sse2", "neon", "avx2", "avx512")
+ */
+const char *simd_isa_name(SimdIsa isa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIMD_DISPATCH_H */
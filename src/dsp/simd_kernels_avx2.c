@@ -0,0 +1,7 @@
+/*
+ * simd_kernels_avx2.c - AVX2 + FMA kernels (built with -mavx2 -mfma or
+ * /arch:AVX2, see CMakeLists.txt)
+ */
+
+#define SIMD_KERNELS_TABLE simd_kernels_avx2
+#include "simd_kernels_impl.h"
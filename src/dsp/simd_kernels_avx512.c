@@ -0,0 +1,8 @@
+/*
+ * simd_kernels_avx512.c - AVX-512 (F, BW, VL) kernels, AVX2 + FMA where a
+ * kernel has no 512-bit path (built with -mavx512f -mavx512bw -mavx512vl
+ * -mavx2 -mfma or /arch:AVX512, see CMakeLists.txt)
+ */
+
+#define SIMD_KERNELS_TABLE simd_kernels_avx512
+#include "simd_kernels_impl.h"
@@ -0,0 +1,7 @@
+/*
+ * simd_kernels_baseline.c - Kernels for the target's baseline ISA (SSE2 on
+ * x86-64, NEON on AArch64), built with the library's own flags
+ */
+
+#define SIMD_KERNELS_TABLE simd_kernels_baseline
+#include "simd_kernels_impl.h"
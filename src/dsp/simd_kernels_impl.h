@@ -0,0 +1,42 @@
+/*
+ * simd_kernels_impl.h - Body of a per-ISA kernel table
+ *
+ * Included (once) by each simd_kernels_<isa>.c after it defines
+ * SIMD_KERNELS_TABLE. The table points at the simd_utils.h functions as
+ * compiled for that file's flags; being static inline, every file gets its
+ * own copies. No include guard on purpose.
+ */
+
+#include "simd_dispatch.h"
+#include "simd_utils.h"
+
+#if defined(SIMD_AVX512)
+#define SIMD_KERNELS_ISA SIMD_ISA_AVX512
+#elif defined(SIMD_AVX2)
+#define SIMD_KERNELS_ISA SIMD_ISA_AVX2
+#elif defined(SIMD_SSE2)
+#define SIMD_KERNELS_ISA SIMD_ISA_SSE2
+#elif defined(SIMD_NEON)
+#define SIMD_KERNELS_ISA SIMD_ISA_NEON
+#else
+#define SIMD_KERNELS_ISA SIMD_ISA_SCALAR
+#endif
+
+const SimdKernels SIMD_KERNELS_TABLE = {
+    SIMD_KERNELS_ISA,
+    simd_dot_product_f32,
+    simd_complex_dot_f32,
+    simd_sum_squares_f32,
+    simd_hwr_diff_sum_f32,
+    simd_apply_window_f32,
+    simd_window_copy_f32,
+    simd_magnitude_f32,
+    simd_power_f32,
+    simd_log_f32,
+    simd_exp_f32,
+    simd_spectral_stats_f32,
+    simd_i16_to_f32,
+    simd_i16_stereo_to_f32,
+    simd_i24_to_f32,
+    simd_i32_to_f32,
+};
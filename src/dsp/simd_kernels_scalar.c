@@ -0,0 +1,7 @@
+/*
+ * simd_kernels_scalar.c - Scalar kernels (reference path, any target)
+ */
+
+#define SIMD_FORCE_SCALAR
+#define SIMD_KERNELS_TABLE simd_kernels_scalar
+#include "simd_kernels_impl.h"
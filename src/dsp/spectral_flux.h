@@ -8,6 +8,8 @@
 #ifndef SPECTRAL_FLUX_H
 #define SPECTRAL_FLUX_H
 
+#include "arena.h"
+#include "simd_dispatch.h"
 #include <stddef.h>
 
 #ifdef __cplusplus
@@ -20,31 +22,31 @@ typedef struct SpectralFlux SpectralFlux;
 /*
  * Initialize Spectral Flux calculator
  *
- * @param sample_rate   Audio sample rate (Hz)
- * @param fft_size      FFT window size in samples (must be power of 2)
- * @param hop_size      Hop size in samples
- * @param custom_alloc  Custom allocator (NULL for default malloc)
- * @return              Initialized SpectralFlux object or NULL on failure
+ * Spectral Flux consumes the complex spectra produced by the shared STFT
+ * front-end (see stft.h); it does not own an FFT of its own.
+ *
+ * @param fft_size      FFT window size of the front-end feeding it
+ * @param simd          Kernels to run with (see simd_dispatch.h)
+ * @param arena         Memory for the object (see arena.h)
+ * @return              Initialized SpectralFlux object, or NULL while
+ *                      measuring or on failure
  */
-SpectralFlux *spectral_flux_create(int sample_rate, int fft_size, int hop_size,
-                                   void *(*custom_alloc)(size_t));
+SpectralFlux *spectral_flux_create(int fft_size, const SimdKernels *simd,
+                                   DspArena *arena);
 
 /*
- * Process audio samples and compute spectral flux
+ * Compute spectral flux and flatness for one analysis frame
  *
  * @param sf            SpectralFlux object
- * @param input         Input audio samples (mono, float)
- * @param num_samples   Number of input samples
- * @param flux_out      Output buffer for flux values (one per hop)
- * @param max_flux      Maximum number of flux values to output
- * @return              Number of flux values written
+ * @param spectrum      Complex spectrum as interleaved [r0,i0,r1,i1,...],
+ *                      fft_size/2 + 1 bins (see stft_get_spectrum); the DC
+ *                      bin is ignored
+ * @return              Flux value for this frame
  */
-int spectral_flux_process(SpectralFlux *sf, const float *input, int num_samples,
-                          float *flux_out, int max_flux);
+float spectral_flux_process_frame(SpectralFlux *sf, const float *spectrum);
 
 /*
- * Get the current instantaneous spectral flux value
- * (useful for sample-by-sample processing)
+ * Get the spectral flux value of the last frame
  */
 float spectral_flux_get_current(const SpectralFlux *sf);
 
@@ -53,11 +55,6 @@ float spectral_flux_get_current(const SpectralFlux *sf);
  */
 void spectral_flux_reset(SpectralFlux *sf);
 
-/*
- * Destroy and free resources
- */
-void spectral_flux_destroy(SpectralFlux *sf, void (*custom_free)(void *));
-
 /*
  * Get current Spectral Flatness (0 = harmonic/vowel, 1 = noise/consonant)
  */
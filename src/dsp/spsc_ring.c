@@ -0,0 +1,166 @@
+/*
+ * spsc_ring.c - Wait-free single-producer / single-consumer ring
+ *
+ * Every field has one writer: the producer owns RingProducer, the consumer
+ * RingConsumer. A side reads its own fields plainly and the other side's
+ * with an acquire load, and publishes its own with a release store, so
+ * element data written before a release is visible after the matching
+ * acquire. The counters are 64-bit and never wrap in practice.
+ */
+
+#include "spsc_ring.h"
+#include <string.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+
+/* Interlocked accesses are full barriers, and atomic on 32-bit x86 too */
+static uint64_t load_acquire(const uint64_t *p) {
+  return (uint64_t)_InterlockedCompareExchange64((volatile __int64 *)p, 0, 0);
+}
+
+static void store_release(uint64_t *p, uint64_t v) {
+  __int64 old = *(volatile __int64 *)p;
+  __int64 seen;
+  while ((seen = _InterlockedCompareExchange64((volatile __int64 *)p,
+                                               (__int64)v, old)) != old)
+    old = seen;
+}
+#else
+static uint64_t load_acquire(const uint64_t *p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint64_t *p, uint64_t v) {
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+#endif
+
+/* Producer state, alone on a cache line */
+typedef struct {
+  uint64_t head;      /* Next element to write */
+  uint64_t dropped;   /* Elements refused by writes into a full ring */
+  uint64_t peak_fill; /* Most elements held after a write */
+  unsigned char pad[DSP_ARENA_ALIGN - 3 * sizeof(uint64_t)];
+} RingProducer;
+
+/* Consumer state, alone on a cache line */
+typedef struct {
+  uint64_t tail;      /* Next element to read */
+  uint64_t underruns; /* spsc_ring_note_underrun calls */
+  unsigned char pad[DSP_ARENA_ALIGN - 2 * sizeof(uint64_t)];
+} RingConsumer;
+
+struct SpscRing {
+  RingProducer producer;
+  RingConsumer consumer;
+  unsigned char *data;
+  size_t elem_size;
+  size_t capacity;
+  size_t mask; /* capacity - 1 */
+};
+
+SpscRing *spsc_ring_create(size_t min_capacity, size_t elem_size,
+                           DspArena *arena) {
+  if (min_capacity < 1 || elem_size < 1)
+    return NULL;
+  size_t capacity = 1;
+  while (capacity < min_capacity)
+    capacity <<= 1;
+
+  SpscRing *r = (SpscRing *)dsp_arena_alloc(arena, sizeof(SpscRing));
+  unsigned char *data =
+      (unsigned char *)dsp_arena_alloc(arena, capacity * elem_size);
+  if (!dsp_arena_ok(arena))
+    return NULL;
+
+  r->data = data;
+  r->elem_size = elem_size;
+  r->capacity = capacity;
+  r->mask = capacity - 1;
+  spsc_ring_reset(r);
+  return r;
+}
+
+size_t spsc_ring_capacity(const SpscRing *r) { return r->capacity; }
+
+size_t spsc_ring_write(SpscRing *r, const void *src, size_t count) {
+  RingProducer *p = &r->producer;
+  size_t fill = (size_t)(p->head - load_acquire(&r->consumer.tail));
+  size_t space = r->capacity - fill;
+  size_t n = count < space ? count : space;
+
+  /* At most two copies: up to the end of storage, then from its start */
+  size_t at = (size_t)p->head & r->mask;
+  size_t first = r->capacity - at < n ? r->capacity - at : n;
+  memcpy(r->data + at * r->elem_size, src, first * r->elem_size);
+  memcpy(r->data, (const unsigned char *)src + first * r->elem_size,
+         (n - first) * r->elem_size);
+
+  if (n < count)
+    store_release(&p->dropped, p->dropped + (count - n));
+  if (fill + n > p->peak_fill)
+    store_release(&p->peak_fill, fill + n);
+  store_release(&p->head, p->head + n);
+  return n;
+}
+
+/* Readable elements */
+static size_t readable(const SpscRing *r) {
+  return (size_t)(load_acquire(&r->producer.head) - r->consumer.tail);
+}
+
+size_t spsc_ring_peek(SpscRing *r, void **data) {
+  size_t fill = readable(r);
+  size_t at = (size_t)r->consumer.tail & r->mask;
+  *data = r->data + at * r->elem_size;
+  return r->capacity - at < fill ? r->capacity - at : fill;
+}
+
+void spsc_ring_consume(SpscRing *r, size_t count) {
+  store_release(&r->consumer.tail, r->consumer.tail + count);
+}
+
+size_t spsc_ring_read(SpscRing *r, void *dst, size_t count) {
+  size_t fill = readable(r);
+  size_t n = count < fill ? count : fill;
+
+  /* At most two copies, as in spsc_ring_write */
+  size_t at = (size_t)r->consumer.tail & r->mask;
+  size_t first = r->capacity - at < n ? r->capacity - at : n;
+  memcpy(dst, r->data + at * r->elem_size, first * r->elem_size);
+  memcpy((unsigned char *)dst + first * r->elem_size, r->data,
+         (n - first) * r->elem_size);
+
+  spsc_ring_consume(r, n);
+  return n;
+}
+
+uint64_t spsc_ring_written(const SpscRing *r) {
+  return load_acquire(&r->producer.head);
+}
+
+uint64_t spsc_ring_consumed(const SpscRing *r) {
+  return load_acquire(&r->consumer.tail);
+}
+
+uint64_t spsc_ring_dropped(const SpscRing *r) {
+  return load_acquire(&r->producer.dropped);
+}
+
+uint64_t spsc_ring_peak_fill(const SpscRing *r) {
+  return load_acquire(&r->producer.peak_fill);
+}
+
+void spsc_ring_note_underrun(SpscRing *r) {
+  store_release(&r->consumer.underruns, r->consumer.underruns + 1);
+}
+
+uint64_t spsc_ring_underruns(const SpscRing *r) {
+  return load_acquire(&r->consumer.underruns);
+}
+
+void spsc_ring_reset(SpscRing *r) {
+  memset(&r->producer, 0, sizeof(r->producer));
+  memset(&r->consumer, 0, sizeof(r->consumer));
+}
@@ -0,0 +1,95 @@
+/*
+ * spsc_ring.h - Wait-free single-producer / single-consumer ring
+ *
+ * Hands fixed-size elements (audio samples, events) from one thread to
+ * another without locks: the producer only advances head and the consumer
+ * only advances tail, each published with a release store and read by the
+ * other side with an acquire load. Both indices count elements since the
+ * last reset and wrap through a power-of-two capacity; they live on separate
+ * cache lines so the two sides never contend.
+ *
+ * Every call does a bounded amount of work (at most two copies and two
+ * atomic accesses) and never blocks or allocates: a write into a full ring
+ * keeps what fits and counts the rest as dropped.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include "arena.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SpscRing SpscRing;
+
+/*
+ * Create a ring
+ *
+ * @param min_capacity  Elements it must hold; rounded up to a power of two
+ * @param elem_size     Bytes per element
+ * @param arena         Memory for the ring and its storage (see arena.h);
+ *                      NULL return while measuring
+ */
+SpscRing *spsc_ring_create(size_t min_capacity, size_t elem_size,
+                           DspArena *arena);
+
+/* Elements the ring holds */
+size_t spsc_ring_capacity(const SpscRing *r);
+
+/* --- Producer --- */
+
+/*
+ * Append up to count elements; those that do not fit are dropped and
+ * counted. Returns the number appended.
+ */
+size_t spsc_ring_write(SpscRing *r, const void *src, size_t count);
+
+/* --- Consumer --- */
+
+/*
+ * Oldest readable elements that are contiguous in storage: returns their
+ * count (0 if the ring is empty) and points *data at the first. They stay
+ * in the ring until spsc_ring_consume.
+ */
+size_t spsc_ring_peek(SpscRing *r, void **data);
+
+/* Release the count oldest elements (<= what spsc_ring_peek returned) */
+void spsc_ring_consume(SpscRing *r, size_t count);
+
+/* Copy out and release up to count elements. Returns the number read. */
+size_t spsc_ring_read(SpscRing *r, void *dst, size_t count);
+
+/* Count a read that found less than the consumer needed */
+void spsc_ring_note_underrun(SpscRing *r);
+
+/* --- Either side, or any other thread --- */
+
+/* Elements appended since the last reset */
+uint64_t spsc_ring_written(const SpscRing *r);
+
+/* Elements released since the last reset */
+uint64_t spsc_ring_consumed(const SpscRing *r);
+
+/* Elements dropped by writes into a full ring since the last reset */
+uint64_t spsc_ring_dropped(const SpscRing *r);
+
+/* Most elements held at once since the last reset (as seen by writes) */
+uint64_t spsc_ring_peak_fill(const SpscRing *r);
+
+/* spsc_ring_note_underrun calls since the last reset */
+uint64_t spsc_ring_underruns(const SpscRing *r);
+
+/*
+ * Empty the ring and zero its counters. Neither side may be using it.
+ */
+void spsc_ring_reset(SpscRing *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPSC_RING_H */
@@ -0,0 +1,160 @@
+/*
+ * stft.c - Shared short-time Fourier analysis front-end
+ *
+ * One ring buffer, one Hann window and one real FFT per hop, shared by all
+ * frame-based features. The ring is mirrored (every sample is written at
+ * pos and pos + fft_size), so the last fft_size samples are always one
+ * contiguous slice. Per hop:
+ *   1. Apply the Hann window straight from the ring into the FFT input
+ *   2. Real FFT
+ * The features derive whatever spectra they need from the complex one.
+ */
+
+#include "stft.h"
+#include "../../extern/kissfft/kiss_fft.h"
+#include "../../extern/kissfft/kiss_fftr.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct StftFrontEnd {
+  int fft_size;
+  int hop_size;
+  int n_bins; /* fft_size/2 + 1 */
+  const SimdKernels *simd;
+
+  /* FFT state */
+  kiss_fftr_cfg fft_cfg;
+
+  /* Buffers */
+  float *input_buffer; /* Mirrored ring buffer, 2 * fft_size samples */
+  int input_write_pos;
+  int samples_since_hop;
+  int frame_ready;
+
+  float *window;          /* Hann window */
+  float *windowed_frame;  /* Windowed frame for FFT */
+  kiss_fft_cpx *spectrum; /* Current spectrum */
+};
+
+StftFrontEnd *stft_create(int fft_size, int hop_size, const SimdKernels *simd,
+                          DspArena *arena) {
+  int n_bins = fft_size / 2 + 1;
+  size_t fft_bytes = 0;
+  kiss_fftr_alloc(fft_size, 0, NULL, &fft_bytes);
+
+  /* Allocate everything first (see arena.h) */
+  StftFrontEnd *st =
+      (StftFrontEnd *)dsp_arena_alloc(arena, sizeof(StftFrontEnd));
+  void *fft_mem = dsp_arena_alloc(arena, fft_bytes);
+  float *input_buffer =
+      (float *)dsp_arena_alloc(arena, 2 * fft_size * sizeof(float));
+  float *window = (float *)dsp_arena_alloc(arena, fft_size * sizeof(float));
+  float *windowed_frame =
+      (float *)dsp_arena_alloc(arena, fft_size * sizeof(float));
+  kiss_fft_cpx *spectrum =
+      (kiss_fft_cpx *)dsp_arena_alloc(arena, n_bins * sizeof(kiss_fft_cpx));
+  if (!dsp_arena_ok(arena))
+    return NULL;
+
+  memset(st, 0, sizeof(StftFrontEnd));
+  st->fft_size = fft_size;
+  st->hop_size = hop_size;
+  st->n_bins = n_bins;
+  st->simd = simd;
+
+  /* Initialize FFT (twiddles live in the arena) */
+  st->fft_cfg = kiss_fftr_alloc(fft_size, 0, fft_mem, &fft_bytes);
+  if (!st->fft_cfg)
+    return NULL;
+
+  st->input_buffer = input_buffer;
+  st->window = window;
+  st->windowed_frame = windowed_frame;
+  st->spectrum = spectrum;
+
+  /* Hann window */
+  for (int i = 0; i < fft_size; i++) {
+    st->window[i] =
+        0.5f * (1.0f - cosf(2.0f * (float)M_PI * i / (fft_size - 1)));
+  }
+
+  stft_reset(st);
+  return st;
+}
+
+void stft_reset(StftFrontEnd *st) {
+  if (!st)
+    return;
+
+  memset(st->input_buffer, 0, 2 * st->fft_size * sizeof(float));
+  st->input_write_pos = 0;
+  st->samples_since_hop = 0;
+  st->frame_ready = 0;
+}
+
+/* Append samples to both halves of the mirrored ring buffer */
+static void ring_write(StftFrontEnd *st, const float *input, int n) {
+  while (n > 0) {
+    int chunk = st->fft_size - st->input_write_pos;
+    if (chunk > n)
+      chunk = n;
+    float *dst = st->input_buffer + st->input_write_pos;
+    memcpy(dst, input, chunk * sizeof(float));
+    memcpy(dst + st->fft_size, input, chunk * sizeof(float));
+    st->input_write_pos += chunk;
+    if (st->input_write_pos == st->fft_size)
+      st->input_write_pos = 0;
+    input += chunk;
+    n -= chunk;
+  }
+}
+
+/* Analyse the fft_size samples ending at the write position */
+static void compute_frame(StftFrontEnd *st) {
+  /* The frame is the contiguous slice starting at the oldest sample; window
+   * it straight into the FFT input (SIMD optimized) */
+  const float *frame = st->input_buffer + st->input_write_pos;
+  st->simd->window_copy(frame, st->window, st->windowed_frame, st->fft_size);
+
+  /* FFT */
+  kiss_fftr(st->fft_cfg, st->windowed_frame, st->spectrum);
+}
+
+int stft_push(StftFrontEnd *st, const float *input, int num_samples) {
+  st->frame_ready = 0;
+
+  /* Copy everything up to the next hop boundary in one go */
+  int until_hop = st->hop_size - st->samples_since_hop;
+  if (until_hop < 1)
+    until_hop = 1;
+  int take = num_samples < until_hop ? num_samples : until_hop;
+
+  ring_write(st, input, take);
+  st->samples_since_hop += take;
+
+  /* Analyse a frame every hop_size samples */
+  if (st->samples_since_hop >= st->hop_size) {
+    st->samples_since_hop = 0;
+    compute_frame(st);
+    st->frame_ready = 1;
+  }
+
+  return take;
+}
+
+int stft_frame_ready(const StftFrontEnd *st) {
+  return st ? st->frame_ready : 0;
+}
+
+const float *stft_get_spectrum(const StftFrontEnd *st) {
+  /* kiss_fft_cpx is a {r, i} pair of floats */
+  return st ? (const float *)st->spectrum : NULL;
+}
+
+int stft_num_bins(const StftFrontEnd *st) { return st ? st->n_bins : 0; }
+
+int stft_hop_size(const StftFrontEnd *st) { return st ? st->hop_size : 0; }
@@ -0,0 +1,76 @@
+/*
+ * stft.h - Shared short-time Fourier analysis front-end
+ *
+ * Owns the input ring buffer, Hann window and real FFT used by the
+ * frame-based features. Once per hop it produces the complex spectrum of the
+ * most recent fft_size samples, which Spectral Flux and MFCC then consume
+ * without running their own FFT.
+ */
+
+#ifndef STFT_H
+#define STFT_H
+
+#include "arena.h"
+#include "simd_dispatch.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct StftFrontEnd StftFrontEnd;
+
+/*
+ * Create the analysis front-end
+ *
+ * @param fft_size      FFT window size in samples (must be power of 2)
+ * @param hop_size      Hop size in samples
+ * @param simd          Kernels to run with (see simd_dispatch.h)
+ * @param arena         Memory for the front-end (see arena.h); NULL return
+ *                      while measuring
+ */
+StftFrontEnd *stft_create(int fft_size, int hop_size, const SimdKernels *simd,
+                          DspArena *arena);
+
+/*
+ * Push samples up to and including the next hop boundary
+ *
+ * Consumes at most num_samples samples and stops right after the sample that
+ * completes a hop, in which case a new frame is analysed and
+ * stft_frame_ready() returns 1 until the next push.
+ *
+ * @return              Number of samples consumed
+ */
+int stft_push(StftFrontEnd *st, const float *input, int num_samples);
+
+/*
+ * Returns 1 if the last stft_push completed a frame
+ */
+int stft_frame_ready(const StftFrontEnd *st);
+
+/*
+ * Complex spectrum of the last frame as interleaved [r0,i0,r1,i1,...]
+ * (n_bins complex values, DC included)
+ */
+const float *stft_get_spectrum(const StftFrontEnd *st);
+
+/*
+ * Number of spectrum bins (fft_size/2 + 1)
+ */
+int stft_num_bins(const StftFrontEnd *st);
+
+/*
+ * Samples between frames
+ */
+int stft_hop_size(const StftFrontEnd *st);
+
+/*
+ * Reset internal state
+ */
+void stft_reset(StftFrontEnd *st);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STFT_H */
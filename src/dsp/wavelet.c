@@ -1,5 +1,6 @@
 #include "wavelet.h"
-#include "simd_utils.h"
+#include "../../extern/kissfft/kiss_fft.h"
+#include "../../extern/kissfft/kiss_fftr.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,23 +13,70 @@
 #define MAX_KERNEL_SIZE 128
 #define HISTORY_SIZE 256
 
-// Complex number for Morlet wavelet
+// Lowest scale frequency: keeps the log spacing finite and the recursive
+// engine's boxes bounded
+#define MIN_SCALE_FREQ_HZ 50.0f
+
+// Recursive engine: boxes per Gaussian and how often the demodulation phasor
+// is renormalized (samples)
+#define RECURSIVE_NUM_BOXES 4
+#define PHASOR_RENORM_INTERVAL 1024
+
+// Overlap-save cost model: one transform run costs about
+// FFT_COST_FACTOR * (num_scales + 1) * N * log2(N) taps of direct convolution
+#define FFT_COST_FACTOR 3
+
+// Multi-rate: a scale runs at the lowest octave rate r with
+// freq <= MULTIRATE_FREQ_LIMIT * r, which keeps its Morlet band (up to about
+// 1.5 * freq) inside the half-band passband (0.4 * r)
+#define MAX_LEVELS 8
+#define MULTIRATE_FREQ_LIMIT 0.25f
+
+// Half-band decimator: Kaiser-windowed sinc, passband to 0.2, stopband from
+// 0.3 of the input rate (about -50 dB)
+#define HALFBAND_TAPS 31
+#define HALFBAND_KAISER_BETA 5.0
+
+// Multi-rate blocks are processed in chunks of at most this many samples
+#define MULTIRATE_CHUNK 256
+
+// One moving average of the recursive engine, run as a running sum over a
+// complex delay line. Double precision keeps the running sum from drifting.
 typedef struct {
-  float r;
-  float i;
-} ComplexFloat;
+  int length;
+  int pos;
+  double *delay; // [2 * length], interleaved re/im
+  double sum_r;
+  double sum_i;
+} BoxStage;
 
 // A single scale (frequency) analyzer
 typedef struct {
   float freq_hz;
   float scale;
+  int level; // Octave level the scale runs at (0 = input rate)
   int kernel_size;
-  ComplexFloat *kernel; // [kernel_size]
 
-  // History buffer for convolution
-  // We only need history up to kernel_size
-  float *input_history;
-  int history_idx;
+  // Kernel stored time-reversed (oldest tap first) as split real/imag arrays,
+  // so it lines up with the oldest-first history window
+  float *kernel_r; // [kernel_size]
+  float *kernel_i; // [kernel_size]
+
+  // Kernel spectrum for overlap-save, scaled by 1/fft_size
+  kiss_fft_cpx *kernel_spectrum; // [fft_size]
+
+  // Recursive engine state
+  BoxStage boxes[RECURSIVE_NUM_BOXES];
+  double box_gain;           // 1 / ||B-spline|| (unit-energy kernel)
+  double rot_r, rot_i;       // exp(-i*w) per sample
+  double phasor_r, phasor_i; // exp(-i*w*n), demodulation phasor
+  int renorm_count;
+
+  // Decimated scales: energies at the level rate, interpolated linearly to
+  // the input rate one level sample behind
+  float interp_from;
+  float interp_step; // Energy change per input sample
+  int interp_pos;
 
   // Current values
   float current_magnitude;
@@ -36,50 +84,100 @@ typedef struct {
   float prev_energy;
 } WaveletScale;
 
+// One octave of the multi-rate ladder. Level 0 is the input; level d runs at
+// sample_rate / 2^d, fed by a half-band decimator from level d - 1.
+typedef struct {
+  int decimation; // Input samples per sample at this level (2^d)
+  float inv_decimation;
+
+  // Input history shared by the level's scales. Each sample is written at idx
+  // and at idx + max_kernel_size, so the last max_kernel_size samples are
+  // always contiguous, oldest first, at history + hist_idx.
+  float *history; // [2 * max_kernel_size]
+  int hist_idx;
+  int max_kernel_size;
+
+  // Half-band decimator input (mirrored like history), levels > 0 only
+  float hb_history[2 * HALFBAND_TAPS];
+  int hb_idx;
+  int hb_phase; // Keeps every other filtered sample
+
+  float latest;   // Most recent sample at this level
+  int has_sample; // Set when this level produced a sample this input step
+} WaveletLevel;
+
 struct WaveletDetector {
   int sample_rate;
   int num_scales;
+  SyllableWaveletEngine engine;
+  const SimdKernels *simd;
   WaveletScale *scales;
 
-  void *(*alloc_fn)(size_t);
-  void (*free_fn)(void *);
-
-  // Global history (circular buffer) optimized for SIMD convolution
-  float *global_history;
-  int global_hist_idx;
-  int max_kernel_size;
+  int num_levels; // 1 unless multi-rate
+  WaveletLevel levels[MAX_LEVELS];
+  float halfband[HALFBAND_TAPS];
+
+  // Multi-rate block scratch: per scale, the energy before the chunk followed
+  // by one energy per chunk sample
+  float *block_energy; // [num_scales * (MULTIRATE_CHUNK + 1)]
+
+  // Overlap-save block convolution (single-rate only)
+  int use_overlap_save;
+  int fft_size;
+  int fft_step;      // New samples per transform
+  int fft_min_block; // Shorter runs use direct convolution
+  kiss_fftr_cfg fft_fwd;
+  kiss_fft_cfg fft_inv;
+  float *fft_segment;         // [fft_size]
+  kiss_fft_cpx *fft_input;    // [fft_size / 2 + 1]
+  kiss_fft_cpx *fft_product;  // [fft_size]
+  kiss_fft_cpx *fft_response; // [fft_size]
 };
 
-// Generate complex Morlet wavelet kernel
-// psi(t) = pi^(-1/4) * exp(i*w0*t) * exp(-t^2/2)
-static void generate_morlet_kernel(WaveletScale *ws, int sample_rate) {
-  float w0 = 6.0f; // Standard frequency parameter for Morlet
-  float dt = 1.0f / sample_rate;
-
-  // Determine effective support of the wavelet (e.g., [-3sigma, 3sigma])
-  // Scale 's' relates to frequency f via f = w0 / (2*pi*s) -> s = w0 / (2*pi*f)
-  ws->scale = w0 / (2.0f * M_PI * ws->freq_hz);
+// Morlet scale of a frequency: f = w0 / (2*pi*s) -> s = w0 / (2*pi*f), with
+// the standard frequency parameter w0 = 6
+static float morlet_scale(float freq_hz) {
+  return 6.0f / (2.0f * M_PI * freq_hz);
+}
 
+// Taps of the Morlet kernel of a scale at the given sample rate
+static int morlet_kernel_size(float freq_hz, float sample_rate) {
   // Standard deviation in time domain is proportional to scale
   // We take a window of e.g. 6 * scale (buffer size)
   // Actually Morlet decay is exp(-t^2/2), so t=3 corresponds to significant
   // decay t is normalized by scale: exp(-(t/s)^2/2)
-  float duration = 6.0f * ws->scale;
-  ws->kernel_size = (int)(duration * sample_rate);
+  float duration = 6.0f * morlet_scale(freq_hz);
+  int kernel_size = (int)(duration * sample_rate);
 
   // Ensure odd size for symmetry
-  if (ws->kernel_size % 2 == 0)
-    ws->kernel_size++;
-  if (ws->kernel_size > MAX_KERNEL_SIZE)
-    ws->kernel_size = MAX_KERNEL_SIZE;
-  if (ws->kernel_size < 5)
-    ws->kernel_size = 5;
+  if (kernel_size % 2 == 0)
+    kernel_size++;
+  if (kernel_size > MAX_KERNEL_SIZE)
+    kernel_size = MAX_KERNEL_SIZE;
+  if (kernel_size < 5)
+    kernel_size = 5;
+  return kernel_size;
+}
 
-  ws->kernel = (ComplexFloat *)malloc(sizeof(ComplexFloat) * ws->kernel_size);
+// Generate complex Morlet wavelet kernel
+// psi(t) = pi^(-1/4) * exp(i*w0*t) * exp(-t^2/2)
+// sample_rate is the rate of the scale's level, decimation its factor.
+// taps holds 2 * morlet_kernel_size() floats (real, then imaginary part).
+static void generate_morlet_kernel(WaveletScale *ws, float sample_rate,
+                                   int decimation, float *taps) {
+  float dt = 1.0f / sample_rate;
+
+  // Determine effective support of the wavelet (e.g., [-3sigma, 3sigma])
+  ws->scale = morlet_scale(ws->freq_hz);
+  ws->kernel_size = morlet_kernel_size(ws->freq_hz, sample_rate);
+  ws->kernel_r = taps;
+  ws->kernel_i = taps + ws->kernel_size;
 
   int center = ws->kernel_size / 2;
   float energy_norm = 0.0f;
+  int last = ws->kernel_size - 1;
 
+  // Tap i applies to the sample i steps back: store it at last - i
   for (int i = 0; i < ws->kernel_size; i++) {
     float t = (i - center) * dt;
     float t_scaled = t / ws->scale;
@@ -90,173 +188,710 @@ static void generate_morlet_kernel(WaveletScale *ws, int sample_rate) {
     // Complex sinusoid: exp(i * 2*pi * f * t) = cos(...) + i*sin(...)
     float phase = 2.0f * M_PI * ws->freq_hz * t;
 
-    ws->kernel[i].r = envelope * cosf(phase);
-    ws->kernel[i].i = envelope * sinf(phase);
+    float kr = envelope * cosf(phase);
+    float ki = envelope * sinf(phase);
+    ws->kernel_r[last - i] = kr;
+    ws->kernel_i[last - i] = ki;
 
-    energy_norm +=
-        ws->kernel[i].r * ws->kernel[i].r + ws->kernel[i].i * ws->kernel[i].i;
+    energy_norm += kr * kr + ki * ki;
   }
 
   // Normalize kernel energy to 1
   energy_norm = sqrtf(energy_norm);
   for (int i = 0; i < ws->kernel_size; i++) {
-    ws->kernel[i].r /= energy_norm;
-    ws->kernel[i].i /= energy_norm;
+    ws->kernel_r[i] /= energy_norm;
+    ws->kernel_i[i] /= energy_norm;
   }
 
-  // Allocate history
-  ws->input_history = (float *)calloc(ws->kernel_size, sizeof(float));
-  ws->history_idx = 0;
+  // A unit-energy kernel's gain on a tone scales with sqrt(sample_rate):
+  // restore the input-rate gain on decimated levels
+  if (decimation > 1) {
+    float gain = sqrtf((float)decimation);
+    for (int i = 0; i < ws->kernel_size; i++) {
+      ws->kernel_r[i] *= gain;
+      ws->kernel_i[i] *= gain;
+    }
+  }
 }
 
-static void *default_malloc(size_t size) { return malloc(size); }
-static void default_free(void *ptr) { free(ptr); }
+// Size overlap-save: the FFT leaves room for at least 3 * max_kernel_size
+// new samples per transform (and is never less than 512 points). Returns the
+// FFT size, or 0 if short kernels (taps in total over num_scales scales) make
+// direct convolution cheaper even for full transform runs.
+static int overlap_save_size(int max_kernel_size, int num_scales, int taps,
+                             int *min_block) {
+  int overlap = max_kernel_size - 1;
+  int n = 512;
+  int log2n = 9;
+  while (n - overlap < 3 * max_kernel_size) {
+    n *= 2;
+    log2n++;
+  }
 
-WaveletDetector *wavelet_create(int sample_rate, float min_freq, float max_freq,
-                                int num_scales, void *(*alloc_fn)(size_t)) {
-  if (!alloc_fn)
-    alloc_fn = default_malloc;
+  *min_block =
+      FFT_COST_FACTOR * (num_scales + 1) * n * log2n / (taps > 0 ? taps : 1);
+  return *min_block > n - overlap ? 0 : n;
+}
 
-  WaveletDetector *wd = (WaveletDetector *)alloc_fn(sizeof(WaveletDetector));
-  if (!wd)
-    return NULL;
+// Precompute each kernel spectrum for overlap-save (buffers and transforms
+// already in place)
+static void setup_overlap_save(WaveletDetector *wd) {
+  // Kernel in natural tap order (tap k = k samples back), zero padded. The
+  // inverse FFT is unnormalized, so fold 1/n into the spectrum. The forward
+  // transform runs on the inverse plan: FFT(x) = conj(IFFT(conj(x))).
+  int n = wd->fft_size;
+  float inv_n = 1.0f / n;
+  for (int s = 0; s < wd->num_scales; s++) {
+    WaveletScale *ws = &wd->scales[s];
+    int last = ws->kernel_size - 1;
+    for (int k = 0; k < n; k++) {
+      wd->fft_product[k].r = k <= last ? ws->kernel_r[last - k] * inv_n : 0.0f;
+      wd->fft_product[k].i = k <= last ? -ws->kernel_i[last - k] * inv_n : 0.0f;
+    }
+    kiss_fft(wd->fft_inv, wd->fft_product, ws->kernel_spectrum);
+    for (int k = 0; k < n; k++)
+      ws->kernel_spectrum[k].i = -ws->kernel_spectrum[k].i;
+  }
+}
 
-  wd->sample_rate = sample_rate;
-  wd->num_scales = num_scales;
-  wd->alloc_fn = alloc_fn;
-  wd->free_fn =
-      default_free; // Should use user free if provided, but strict API doesn't
-                    // pass it. Assuming std free for internal allocs if user
-                    // alloc is NULL is safer, but mixed is bad.
-  // Improvement: Design assumes implementation handles sub-allocations.
-  // We will use standard malloc/free for internal structures to avoid
-  // complexity if user doesn't provide free_fn paired with alloc_fn. Actually,
-  // let's just use standard malloc/free for internals for simplicity unless
-  // critical.
+// Box lengths of the recursive approximation of a scale's Morlet wavelet.
+// The Gaussian envelope (sigma = scale * sample_rate samples) is replaced by
+// RECURSIVE_NUM_BOXES moving averages whose lengths are consecutive integers
+// chosen so the total variance, sum((L^2 - 1) / 12), is closest to sigma^2.
+// Returns the support of their cascade.
+static int recursive_box_lengths(float freq_hz, float sample_rate,
+                                 int *lengths) {
+  // Same scale as generate_morlet_kernel
+  double sigma = morlet_scale(freq_hz) * (double)sample_rate;
+  double var = sigma * sigma;
+  int n = RECURSIVE_NUM_BOXES;
+
+  int wl = (int)floor(sqrt(12.0 * var / n + 1.0));
+  if (wl < 1)
+    wl = 1;
+  int wu = wl + 1;
+  // Number of boxes using the shorter length
+  int m = (int)floor((n * ((double)wu * wu - 1.0) - 12.0 * var) /
+                         ((double)wu * wu - (double)wl * wl) +
+                     0.5);
+  if (m < 0)
+    m = 0;
+  if (m > n)
+    m = n;
+
+  int support = 1;
+  for (int s = 0; s < n; s++) {
+    lengths[s] = s < m ? wl : wu;
+    support += lengths[s] - 1;
+  }
+  return support;
+}
+
+// Set up the recursive approximation of a scale's Morlet wavelet (see
+// recursive_box_lengths). delays holds 2 * (sum of the box lengths) doubles,
+// spline and tmp the support of the cascade each.
+static void generate_recursive_boxes(WaveletScale *ws, float sample_rate,
+                                     int decimation, double *delays,
+                                     double *spline, double *tmp) {
+  ws->scale = morlet_scale(ws->freq_hz);
+
+  int lengths[RECURSIVE_NUM_BOXES];
+  int support = recursive_box_lengths(ws->freq_hz, sample_rate, lengths);
+  int n = RECURSIVE_NUM_BOXES;
+  for (int s = 0; s < n; s++) {
+    BoxStage *b = &ws->boxes[s];
+    b->length = lengths[s];
+    b->delay = delays;
+    delays += 2 * b->length;
+  }
+
+  // Energy of the B-spline: convolve the boxes once
+  int len = 1;
+  spline[0] = 1.0;
+  for (int s = 0; s < n; s++) {
+    int L = ws->boxes[s].length;
+    memset(tmp, 0, support * sizeof(double));
+    for (int i = 0; i < len; i++)
+      for (int k = 0; k < L; k++)
+        tmp[i + k] += spline[i];
+    len += L - 1;
+    memcpy(spline, tmp, len * sizeof(double));
+  }
+  double energy = 0.0;
+  for (int i = 0; i < len; i++)
+    energy += spline[i] * spline[i];
+  // Same decimation gain correction as generate_morlet_kernel
+  ws->box_gain = sqrt((double)decimation) / sqrt(energy);
+
+  double w = 2.0 * M_PI * ws->freq_hz / sample_rate;
+  ws->rot_r = cos(w);
+  ws->rot_i = -sin(w);
+}
 
-  wd->scales = (WaveletScale *)calloc(num_scales, sizeof(WaveletScale));
+// Zeroth-order modified Bessel function (series), for the Kaiser window
+static double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 32; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
 
-  wd->max_kernel_size = 0;
+// Half-band low-pass: h[c] = 0.5, h[c +- odd m] = sin(pi*m/2) / (pi*m),
+// Kaiser windowed, all other taps zero
+static void design_halfband(float *h) {
+  int c = HALFBAND_TAPS / 2;
+  double norm = bessel_i0(HALFBAND_KAISER_BETA);
+  double sum = 0.0;
+  double taps[HALFBAND_TAPS];
+  for (int i = 0; i < HALFBAND_TAPS; i++) {
+    int m = i - c;
+    double ideal = 0.5;
+    if (m != 0)
+      ideal = m % 2 ? sin(M_PI * m / 2.0) / (M_PI * m) : 0.0;
+    double r = (double)m / c;
+    double kaiser = bessel_i0(HALFBAND_KAISER_BETA * sqrt(1.0 - r * r)) / norm;
+    taps[i] = ideal * kaiser;
+    sum += taps[i];
+  }
+  // Unity gain at DC
+  for (int i = 0; i < HALFBAND_TAPS; i++)
+    h[i] = (float)(taps[i] / sum);
+}
+
+// Lowest octave level that still resolves a scale (0 unless multi-rate)
+static int scale_level(float freq, int sample_rate, int multirate) {
+  int level = 0;
+  while (multirate && level + 1 < MAX_LEVELS &&
+         freq <= MULTIRATE_FREQ_LIMIT * sample_rate / (2 << level))
+    level++;
+  return level;
+}
+
+WaveletDetector *wavelet_create(int sample_rate, float min_freq, float max_freq,
+                                int num_scales, SyllableWaveletEngine engine,
+                                int multirate, const SimdKernels *simd,
+                                DspArena *arena) {
+  // Keep the scales meaningful: at least one, positive, below Nyquist,
+  // ascending
+  if (num_scales < 1)
+    num_scales = 1;
+  if (max_freq > 0.45f * sample_rate)
+    max_freq = 0.45f * sample_rate;
+  if (!(min_freq >= MIN_SCALE_FREQ_HZ))
+    min_freq = MIN_SCALE_FREQ_HZ;
+  if (!(max_freq >= MIN_SCALE_FREQ_HZ))
+    max_freq = MIN_SCALE_FREQ_HZ;
+  if (min_freq > max_freq)
+    min_freq = max_freq;
 
   // Logarithmic frequency spacing
   float log_min = logf(min_freq);
   float log_max = logf(max_freq);
   float log_step = (log_max - log_min) / (num_scales > 1 ? num_scales - 1 : 1);
 
+  // Size every buffer from the parameters alone (see arena.h)
+  int num_levels = 1;
+  int max_kernel_size[MAX_LEVELS] = {0};
+  int taps = 0;        // Convolution engine: kernel taps over all scales
+  int delay_len = 0;   // Recursive engine: box delay line length, all scales
+  int max_support = 0; // Recursive engine: longest B-spline
   for (int i = 0; i < num_scales; i++) {
     float freq = expf(log_min + i * log_step);
-    wd->scales[i].freq_hz = freq;
-    generate_morlet_kernel(&wd->scales[i], sample_rate);
+    int level = scale_level(freq, sample_rate, multirate);
+    float rate = (float)sample_rate / (1 << level);
+    if (level + 1 > num_levels)
+      num_levels = level + 1;
+    if (engine == WAVELET_ENGINE_RECURSIVE) {
+      int lengths[RECURSIVE_NUM_BOXES];
+      int support = recursive_box_lengths(freq, rate, lengths);
+      for (int s = 0; s < RECURSIVE_NUM_BOXES; s++)
+        delay_len += 2 * lengths[s];
+      if (support > max_support)
+        max_support = support;
+    } else {
+      int kernel_size = morlet_kernel_size(freq, rate);
+      taps += kernel_size;
+      if (kernel_size > max_kernel_size[level])
+        max_kernel_size[level] = kernel_size;
+    }
+  }
+  int history_len = 0;
+  for (int d = 0; d < num_levels; d++)
+    history_len += 2 * max_kernel_size[d];
+
+  // Overlap-save only pays off for the long kernels of single-rate analysis.
+  // Without it, blocks fall back to direct convolution.
+  int fft_n = 0;
+  int fft_min_block = 0;
+  if (engine != WAVELET_ENGINE_RECURSIVE && num_levels == 1)
+    fft_n = overlap_save_size(max_kernel_size[0], num_scales, taps,
+                              &fft_min_block);
+  size_t fwd_bytes = 0;
+  size_t inv_bytes = 0;
+  if (fft_n) {
+    kiss_fftr_alloc(fft_n, 0, NULL, &fwd_bytes);
+    kiss_fft_alloc(fft_n, 1, NULL, &inv_bytes);
+  }
 
-    if (wd->scales[i].kernel_size > wd->max_kernel_size) {
-      wd->max_kernel_size = wd->scales[i].kernel_size;
+  WaveletDetector *wd =
+      (WaveletDetector *)dsp_arena_alloc(arena, sizeof(WaveletDetector));
+  WaveletScale *scales = (WaveletScale *)dsp_arena_alloc(
+      arena, num_scales * sizeof(WaveletScale));
+  float *kernels = (float *)dsp_arena_alloc(arena, 2 * taps * sizeof(float));
+  double *delays =
+      (double *)dsp_arena_alloc(arena, delay_len * sizeof(double));
+  double *spline =
+      (double *)dsp_arena_alloc(arena, 2 * max_support * sizeof(double));
+  float *histories =
+      (float *)dsp_arena_alloc(arena, history_len * sizeof(float));
+  float *block_energy = NULL;
+  if (num_levels > 1)
+    block_energy = (float *)dsp_arena_alloc(
+        arena, num_scales * (MULTIRATE_CHUNK + 1) * sizeof(float));
+  void *fwd_mem = NULL;
+  void *inv_mem = NULL;
+  float *fft_segment = NULL;
+  kiss_fft_cpx *fft_input = NULL;
+  kiss_fft_cpx *fft_product = NULL;
+  kiss_fft_cpx *fft_response = NULL;
+  kiss_fft_cpx *spectra = NULL;
+  if (fft_n) {
+    fwd_mem = dsp_arena_alloc(arena, fwd_bytes);
+    inv_mem = dsp_arena_alloc(arena, inv_bytes);
+    fft_segment = (float *)dsp_arena_alloc(arena, fft_n * sizeof(float));
+    fft_input = (kiss_fft_cpx *)dsp_arena_alloc(
+        arena, (fft_n / 2 + 1) * sizeof(kiss_fft_cpx));
+    fft_product =
+        (kiss_fft_cpx *)dsp_arena_alloc(arena, fft_n * sizeof(kiss_fft_cpx));
+    fft_response =
+        (kiss_fft_cpx *)dsp_arena_alloc(arena, fft_n * sizeof(kiss_fft_cpx));
+    spectra = (kiss_fft_cpx *)dsp_arena_alloc(
+        arena, num_scales * fft_n * sizeof(kiss_fft_cpx));
+  }
+  if (!dsp_arena_ok(arena))
+    return NULL;
+
+  memset(wd, 0, sizeof(WaveletDetector));
+  memset(scales, 0, num_scales * sizeof(WaveletScale));
+  wd->sample_rate = sample_rate;
+  wd->num_scales = num_scales;
+  wd->engine = engine;
+  wd->simd = simd;
+  wd->scales = scales;
+  wd->num_levels = num_levels;
+  wd->block_energy = block_energy;
+  design_halfband(wd->halfband);
+
+  for (int i = 0; i < num_scales; i++) {
+    WaveletScale *ws = &wd->scales[i];
+    float freq = expf(log_min + i * log_step);
+    ws->freq_hz = freq;
+    ws->level = scale_level(freq, sample_rate, multirate);
+
+    int decimation = 1 << ws->level;
+    float rate = (float)sample_rate / decimation;
+    if (engine == WAVELET_ENGINE_RECURSIVE) {
+      generate_recursive_boxes(ws, rate, decimation, delays, spline,
+                               spline + max_support);
+      for (int s = 0; s < RECURSIVE_NUM_BOXES; s++)
+        delays += 2 * ws->boxes[s].length;
+    } else {
+      generate_morlet_kernel(ws, rate, decimation, kernels);
+      kernels += 2 * ws->kernel_size;
+    }
+    if (fft_n)
+      ws->kernel_spectrum = spectra + i * fft_n;
+  }
+
+  for (int d = 0; d < num_levels; d++) {
+    WaveletLevel *lv = &wd->levels[d];
+    lv->decimation = 1 << d;
+    lv->inv_decimation = 1.0f / lv->decimation;
+    lv->max_kernel_size = max_kernel_size[d];
+    if (lv->max_kernel_size > 0) {
+      lv->history = histories;
+      histories += 2 * lv->max_kernel_size;
     }
   }
 
-  // Prepare global history buffer
-  wd->global_history = (float *)calloc(wd->max_kernel_size * 2, sizeof(float));
-  wd->global_hist_idx = 0;
+  if (fft_n) {
+    wd->fft_size = fft_n;
+    wd->fft_step = fft_n - (max_kernel_size[0] - 1);
+    wd->fft_min_block = fft_min_block;
+    wd->fft_fwd = kiss_fftr_alloc(fft_n, 0, fwd_mem, &fwd_bytes);
+    wd->fft_inv = kiss_fft_alloc(fft_n, 1, inv_mem, &inv_bytes);
+    wd->fft_segment = fft_segment;
+    wd->fft_input = fft_input;
+    wd->fft_product = fft_product;
+    wd->fft_response = fft_response;
+    if (!wd->fft_fwd || !wd->fft_inv)
+      return NULL;
+    setup_overlap_save(wd);
+    wd->use_overlap_save = 1;
+  }
 
+  wavelet_reset(wd);
   return wd;
 }
 
-void wavelet_destroy(WaveletDetector *wd, void (*free_fn)(void *)) {
-  if (!wd)
-    return;
-
+void wavelet_reset(WaveletDetector *wd) {
   for (int i = 0; i < wd->num_scales; i++) {
-    free(wd->scales[i].kernel);
-    free(wd->scales[i].input_history);
+    WaveletScale *ws = &wd->scales[i];
+    for (int s = 0; s < RECURSIVE_NUM_BOXES; s++) {
+      BoxStage *b = &ws->boxes[s];
+      if (b->delay)
+        memset(b->delay, 0, 2 * b->length * sizeof(double));
+      b->pos = 0;
+      b->sum_r = 0.0;
+      b->sum_i = 0.0;
+    }
+    ws->phasor_r = 1.0;
+    ws->phasor_i = 0.0;
+    ws->renorm_count = 0;
+    ws->interp_from = 0.0f;
+    ws->interp_step = 0.0f;
+    ws->interp_pos = 0;
+    ws->current_magnitude = 0.0f;
+    ws->current_energy = 0.0f;
+    ws->prev_energy = 0.0f;
   }
-  free(wd->scales);
-  free(wd->global_history);
+  for (int d = 0; d < wd->num_levels; d++) {
+    WaveletLevel *lv = &wd->levels[d];
+    if (lv->history)
+      memset(lv->history, 0, lv->max_kernel_size * 2 * sizeof(float));
+    lv->hist_idx = 0;
+    memset(lv->hb_history, 0, sizeof(lv->hb_history));
+    lv->hb_idx = 0;
+    lv->hb_phase = 0;
+    lv->latest = 0.0f;
+    lv->has_sample = 0;
+  }
+}
 
-  if (free_fn)
-    free_fn(wd);
-  else
-    free(wd);
+static inline float update_scale_energy(WaveletScale *ws, float magnitude) {
+  ws->prev_energy = ws->current_energy;
+  ws->current_magnitude = magnitude;
+  ws->current_energy = magnitude * magnitude;
+  return ws->current_energy;
 }
 
-void wavelet_reset(WaveletDetector *wd) {
-  for (int i = 0; i < wd->num_scales; i++) {
-    memset(wd->scales[i].input_history, 0,
-           wd->scales[i].kernel_size * sizeof(float));
-    wd->scales[i].history_idx = 0;
-    wd->scales[i].current_magnitude = 0.0f;
-    wd->scales[i].current_energy = 0.0f;
-    wd->scales[i].prev_energy = 0.0f;
-  }
-  memset(wd->global_history, 0, wd->max_kernel_size * 2 * sizeof(float));
-  wd->global_hist_idx = 0;
+// Relative energy increase of a scale (Weber's Law), 0 if not increasing
+static inline float scale_transient(const WaveletScale *ws) {
+  float diff = ws->current_energy - ws->prev_energy;
+  if (diff > 0)
+    return diff / (ws->prev_energy + 1e-6f); // epsilon avoids div by zero
+  return 0.0f;
 }
 
-// Convolution logic
-// Returns energy of the wavelet response
-float wavelet_process_scale(WaveletScale *ws, float new_sample) {
-  // Update history buffer (circular)
-  ws->input_history[ws->history_idx] = new_sample;
-  int current_idx = ws->history_idx;
-  ws->history_idx = (ws->history_idx + 1) % ws->kernel_size;
+// Append a sample to a level's mirrored history
+static inline void history_push(WaveletLevel *lv, float sample) {
+  lv->history[lv->hist_idx] = sample;
+  lv->history[lv->hist_idx + lv->max_kernel_size] = sample;
+  if (++lv->hist_idx == lv->max_kernel_size)
+    lv->hist_idx = 0;
+}
 
-  // Convolution: sum(x[n] * kernel[K-1-n])
-  // x[0] is newest sample (at current_idx)
+// Feed one sample of the level above into a level's half-band decimator.
+// Returns 1 (with the output in lv->latest) on every other input sample.
+static int halfband_push(const WaveletDetector *wd, WaveletLevel *lv,
+                         float sample) {
+  lv->hb_history[lv->hb_idx] = sample;
+  lv->hb_history[lv->hb_idx + HALFBAND_TAPS] = sample;
+  if (++lv->hb_idx == HALFBAND_TAPS)
+    lv->hb_idx = 0;
+
+  lv->hb_phase ^= 1;
+  if (!lv->hb_phase)
+    return 0;
+
+  // Symmetric taps, so no need to reverse them
+  lv->latest = wd->simd->dot_product(lv->hb_history + lv->hb_idx, wd->halfband,
+                                     HALFBAND_TAPS);
+  return 1;
+}
 
-  float r_sum = 0.0f;
-  float i_sum = 0.0f;
+// Convolution logic
+// Returns the wavelet response magnitude for the newest sample of the level
+static float convolve_scale(const WaveletDetector *wd, const WaveletLevel *lv,
+                            const WaveletScale *ws) {
+  // The kernel_size newest samples, oldest first, against the time-reversed
+  // kernel: sum(x[n-k] * kernel[k])
+  const float *window =
+      lv->history + lv->hist_idx + lv->max_kernel_size - ws->kernel_size;
+
+  float r_sum, i_sum;
+  wd->simd->complex_dot(window, ws->kernel_r, ws->kernel_i, ws->kernel_size,
+                        &r_sum, &i_sum);
+
+  return sqrtf(r_sum * r_sum + i_sum * i_sum);
+}
 
-  int k_size = ws->kernel_size;
+// Recursive engine: same output as convolve_scale, with the Morlet
+// kernel replaced by exp(i*w*k) * B(k), B being the B-spline of the boxes.
+// Demodulating first turns that into plain moving averages:
+//   sum_k x[n-k] exp(i*w*k) B(k) = exp(i*w*n) * sum_k z[n-k] B(k),
+//   z[m] = x[m] exp(-i*w*m)
+// and the exp(i*w*n) factor drops out of the magnitude.
+static float recursive_scale(WaveletScale *ws, float new_sample) {
+  double zr = new_sample * ws->phasor_r;
+  double zi = new_sample * ws->phasor_i;
+
+  // Advance the phasor; renormalize now and then so rounding cannot make it
+  // grow or decay
+  double pr = ws->phasor_r * ws->rot_r - ws->phasor_i * ws->rot_i;
+  double pi = ws->phasor_r * ws->rot_i + ws->phasor_i * ws->rot_r;
+  if (++ws->renorm_count >= PHASOR_RENORM_INTERVAL) {
+    double norm = 1.0 / sqrt(pr * pr + pi * pi);
+    pr *= norm;
+    pi *= norm;
+    ws->renorm_count = 0;
+  }
+  ws->phasor_r = pr;
+  ws->phasor_i = pi;
+
+  // Cascade of running sums
+  for (int s = 0; s < RECURSIVE_NUM_BOXES; s++) {
+    BoxStage *b = &ws->boxes[s];
+    double *slot = b->delay + 2 * b->pos;
+    b->sum_r += zr - slot[0];
+    b->sum_i += zi - slot[1];
+    slot[0] = zr;
+    slot[1] = zi;
+    if (++b->pos == b->length)
+      b->pos = 0;
+    zr = b->sum_r;
+    zi = b->sum_i;
+  }
 
-  // Basic scalar convolution (can be SIMD optimized)
-  for (int k = 0; k < k_size; k++) {
-    // Access history in reverse time (newest to oldest)
-    int h_idx = current_idx - k;
-    if (h_idx < 0)
-      h_idx += k_size;
+  return (float)(sqrt(zr * zr + zi * zi) * ws->box_gain);
+}
 
-    float val = ws->input_history[h_idx];
-    r_sum += val * ws->kernel[k].r;
-    i_sum += val * ws->kernel[k].i;
+// Advance the octave ladder by one input sample. Level 0 takes every sample;
+// each lower level every other sample of the level above, until one of them
+// has nothing new.
+static void ladder_push(WaveletDetector *wd, float sample, int recursive) {
+  WaveletLevel *top = &wd->levels[0];
+  top->latest = sample;
+  top->has_sample = 1;
+  for (int d = 1; d < wd->num_levels; d++) {
+    WaveletLevel *above = &wd->levels[d - 1];
+    WaveletLevel *lv = &wd->levels[d];
+    lv->has_sample =
+        above->has_sample && halfband_push(wd, lv, above->latest);
   }
+  if (!recursive) {
+    for (int d = 0; d < wd->num_levels; d++) {
+      WaveletLevel *lv = &wd->levels[d];
+      if (lv->has_sample && lv->history)
+        history_push(lv, lv->latest);
+    }
+  }
+}
 
-  float magnitude = sqrtf(r_sum * r_sum + i_sum * i_sum);
+// Input-rate energy of a scale for the sample just pushed into the ladder
+static inline float scale_next_energy(WaveletDetector *wd, WaveletScale *ws,
+                                      int recursive) {
+  WaveletLevel *lv = &wd->levels[ws->level];
 
-  ws->prev_energy = ws->current_energy;
-  ws->current_magnitude = magnitude;
-  ws->current_energy = magnitude * magnitude;
+  if (ws->level == 0) {
+    ws->current_magnitude = recursive ? recursive_scale(ws, lv->latest)
+                                      : convolve_scale(wd, lv, ws);
+    return ws->current_magnitude * ws->current_magnitude;
+  }
 
-  return ws->current_energy;
+  // Decimated: ramp from where the last ramp got to towards the newest level
+  // sample's energy
+  if (lv->has_sample) {
+    float now = ws->interp_from + ws->interp_step * (float)ws->interp_pos;
+    ws->current_magnitude = recursive ? recursive_scale(ws, lv->latest)
+                                      : convolve_scale(wd, lv, ws);
+    float target = ws->current_magnitude * ws->current_magnitude;
+    ws->interp_from = now;
+    ws->interp_step = (target - now) * lv->inv_decimation;
+    ws->interp_pos = 0;
+  }
+  ws->interp_pos++;
+  return ws->interp_from + ws->interp_step * (float)ws->interp_pos;
 }
 
-float wavelet_process(WaveletDetector *wd, float sample) {
-  float total_transient_score = 0.0f;
-  int vote_count = 0;
+// One input sample through the octave ladder and every scale. Returns the
+// transient score.
+static float process_sample(WaveletDetector *wd, float sample) {
+  int recursive = wd->engine == WAVELET_ENGINE_RECURSIVE;
+  ladder_push(wd, sample, recursive);
 
-  // Process each scale
+  float score = 0.0f;
   for (int i = 0; i < wd->num_scales; i++) {
-    float energy = wavelet_process_scale(&wd->scales[i], sample);
+    WaveletScale *ws = &wd->scales[i];
+    float energy = scale_next_energy(wd, ws, recursive);
+    ws->prev_energy = ws->current_energy;
+    ws->current_energy = energy;
 
     // Transient detection logic:
     // Look for rapid increase in energy (spectral flux in wavelet domain)
-    // dE/dt > threshold
-
-    float diff = energy - wd->scales[i].prev_energy;
-    if (diff > 0) {
-      // Normalize by previous energy (Weber's Law) - Robustness Feature
-      // To avoid div by zero, add epsilon
-      float relative_change = diff / (wd->scales[i].prev_energy + 1e-6f);
-
-      // Weight high frequencies more for transients?
-      // Or just sum relative changes
-      total_transient_score += relative_change;
-      vote_count++;
+    score += scale_transient(ws);
+  }
+
+  // Average relative change score, normalized by total scales
+  return score / wd->num_scales;
+}
+
+// Multi-rate block of at most MULTIRATE_CHUNK samples. The ladder runs sample
+// by sample and leaves per-sample energies; the transient scores are then
+// accumulated scale by scale in a branch-free loop. Same results as
+// process_sample.
+static void process_chunk_multirate(WaveletDetector *wd, const float *in,
+                                    float *out, int n) {
+  int recursive = wd->engine == WAVELET_ENGINE_RECURSIVE;
+  int stride = MULTIRATE_CHUNK + 1;
+
+  for (int i = 0; i < wd->num_scales; i++)
+    wd->block_energy[i * stride] = wd->scales[i].current_energy;
+
+  for (int j = 0; j < n; j++) {
+    ladder_push(wd, in[j], recursive);
+    for (int i = 0; i < wd->num_scales; i++)
+      wd->block_energy[i * stride + 1 + j] =
+          scale_next_energy(wd, &wd->scales[i], recursive);
+  }
+
+  for (int j = 0; j < n; j++)
+    out[j] = 0.0f;
+
+  for (int i = 0; i < wd->num_scales; i++) {
+    const float *e = wd->block_energy + i * stride;
+    for (int j = 0; j < n; j++) {
+      float diff = e[j + 1] - e[j];
+      float rel = diff / (e[j] + 1e-6f);
+      out[j] += diff > 0 ? rel : 0.0f;
     }
+    wd->scales[i].prev_energy = e[n - 1];
+    wd->scales[i].current_energy = e[n];
   }
 
-  // Average relative change score
-  if (vote_count > 0) {
-    return total_transient_score / wd->num_scales; // Normalize by total scales
+  for (int j = 0; j < n; j++)
+    out[j] /= wd->num_scales;
+}
+
+// Overlap-save convolution of up to fft_step samples: one forward FFT of the
+// segment shared by all scales, then one spectral product and inverse FFT per
+// scale. Each output sample only sees the max_kernel_size - 1 samples of
+// history in front of it, so there is no circular wrap-around.
+static void convolve_overlap_save(WaveletDetector *wd, const float *in,
+                                  float *out, int n) {
+  int size = wd->fft_size;
+  int half = size / 2;
+  WaveletLevel *lv = &wd->levels[0];
+  int overlap = lv->max_kernel_size - 1;
+  float *seg = wd->fft_segment;
+  kiss_fft_cpx *x = wd->fft_input;
+  kiss_fft_cpx *prod = wd->fft_product;
+
+  // Segment: the overlap samples before the run, the run, zero padding
+  memcpy(seg, lv->history + lv->hist_idx + 1, overlap * sizeof(float));
+  memcpy(seg + overlap, in, n * sizeof(float));
+  memset(seg + overlap + n, 0, (size - overlap - n) * sizeof(float));
+  kiss_fftr(wd->fft_fwd, seg, x);
+
+  for (int j = 0; j < n; j++)
+    out[j] = 0.0f;
+
+  for (int i = 0; i < wd->num_scales; i++) {
+    WaveletScale *ws = &wd->scales[i];
+    const kiss_fft_cpx *h = ws->kernel_spectrum;
+
+    // The segment is real: the upper half of its spectrum is the conjugate
+    // mirror of the lower half
+    for (int k = 0; k <= half; k++) {
+      prod[k].r = x[k].r * h[k].r - x[k].i * h[k].i;
+      prod[k].i = x[k].r * h[k].i + x[k].i * h[k].r;
+    }
+    for (int k = half + 1; k < size; k++) {
+      const kiss_fft_cpx *m = &x[size - k];
+      prod[k].r = m->r * h[k].r + m->i * h[k].i;
+      prod[k].i = m->r * h[k].i - m->i * h[k].r;
+    }
+    kiss_fft(wd->fft_inv, prod, wd->fft_response);
+
+    const kiss_fft_cpx *y = wd->fft_response + overlap;
+    for (int j = 0; j < n; j++) {
+      update_scale_energy(ws, sqrtf(y[j].r * y[j].r + y[j].i * y[j].i));
+      out[j] += scale_transient(ws);
+    }
   }
-  return 0.0f;
+
+  for (int j = 0; j < n; j++) {
+    out[j] /= wd->num_scales;
+    history_push(lv, in[j]);
+  }
+}
+
+float wavelet_process(WaveletDetector *wd, float sample) {
+  return process_sample(wd, sample);
+}
+
+void wavelet_process_block(WaveletDetector *wd, const float *in, float *out,
+                           int n) {
+  if (wd->use_overlap_save) {
+    // Overlap-save while enough samples remain, direct convolution for the
+    // rest
+    while (n > 0) {
+      int run = n;
+      if (run >= wd->fft_min_block) {
+        if (run > wd->fft_step)
+          run = wd->fft_step;
+        convolve_overlap_save(wd, in, out, run);
+      } else {
+        for (int j = 0; j < run; j++)
+          out[j] = process_sample(wd, in[j]);
+      }
+      in += run;
+      out += run;
+      n -= run;
+    }
+    return;
+  }
+
+  if (wd->num_levels > 1 && wd->block_energy) {
+    while (n > 0) {
+      int run = n < MULTIRATE_CHUNK ? n : MULTIRATE_CHUNK;
+      process_chunk_multirate(wd, in, out, run);
+      in += run;
+      out += run;
+      n -= run;
+    }
+    return;
+  }
+
+  if (wd->engine == WAVELET_ENGINE_RECURSIVE && wd->num_levels == 1) {
+    for (int j = 0; j < n; j++)
+      out[j] = 0.0f;
+
+    // Single-rate recursive engine: scale by scale, so each scale's state
+    // stays hot for the whole block. Sums accumulate in the same scale order
+    // as wavelet_process.
+    for (int i = 0; i < wd->num_scales; i++) {
+      WaveletScale *ws = &wd->scales[i];
+      for (int j = 0; j < n; j++) {
+        update_scale_energy(ws, recursive_scale(ws, in[j]));
+        out[j] += scale_transient(ws);
+      }
+    }
+
+    for (int j = 0; j < n; j++)
+      out[j] /= wd->num_scales;
+    return;
+  }
+
+  for (int j = 0; j < n; j++)
+    out[j] = process_sample(wd, in[j]);
+}
+
+int wavelet_decimation(const WaveletDetector *wd) {
+  return 1 << (wd->num_levels - 1);
 }
 
 float wavelet_get_energy(WaveletDetector *wd, int scale_idx) {
@@ -1,6 +1,8 @@
 #ifndef WAVELET_H
 #define WAVELET_H
 
+#include "arena.h"
+#include "simd_dispatch.h"
 #include "syllable_detector.h" // For config or types if needed
 #include <stddef.h>
 #include <stdint.h>
@@ -9,6 +11,45 @@
 // Wavelet Module based on Morlet Wavelet
 // Used for robust transient/onset detection particularly for unvoiced
 // consonants
+//
+// Two engines compute the per-scale response magnitude:
+//
+// WAVELET_ENGINE_CONVOLUTION: complex convolution with the sampled Morlet
+//   kernel (6 sigma wide, capped at 128 taps). Cost grows with the kernel
+//   length, i.e. with sample_rate / freq. All scales read one mirrored input
+//   history; single samples use SIMD dot products against split re/im
+//   kernels, and long enough blocks use FFT overlap-save.
+//
+// WAVELET_ENGINE_RECURSIVE: the input is demodulated to baseband and the
+//   Gaussian envelope is approximated by a cascade of 4 moving averages
+//   (a cubic B-spline with the same variance), each run as a running sum.
+//   Cost is O(1) per sample per scale regardless of the kernel length.
+//
+//   Error bound against the convolution engine: both kernels have unit
+//   energy, so per sample | |y_conv| - |y_rec| | <= e * ||x||, where ||x|| is
+//   the L2 norm of the input over the kernel support and e is the relative L2
+//   distance between the two kernels (best integer alignment). Measured over
+//   8-48 kHz and every scale the convolution engine does not truncate:
+//     e <= 0.05 for sigma >= 10 samples (e.g. 2-6 kHz at 44.1/48 kHz)
+//     e <= 0.08 for sigma >= 5 samples
+//     e <= 0.17 for sigma >= 2 samples (scales near Nyquist)
+//   where sigma = 6 * sample_rate / (2 * pi * freq). Scales wider than the
+//   128-tap cap are truncated by the convolution engine only, so the engines
+//   differ more there (the recursive one follows the untruncated wavelet).
+//   The recursive response lags the convolution one by about sigma / 2
+//   samples.
+//
+// Multi-rate (either engine): the input feeds an octave ladder of half-band
+// decimators (31 taps, passband to 0.2 and about -50 dB from 0.3 of each
+// level's input rate). A scale runs at the lowest level whose rate is at
+// least 4x its frequency, so every level carries the same number of samples
+// per cycle and, at most, half the work of the level above: filtering cost
+// stays close to 2x that of the top octave however many octaves the scales
+// span. Only the energy interpolation and transient score still run at the
+// input rate for every scale (branch-free in wavelet_process_block).
+// Decimated energies are gain-matched to the input rate and interpolated
+// linearly back to it, one level sample late; each level also adds the
+// half-band delay (15 samples at its input rate) on top of the level above.
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,11 +62,15 @@ typedef struct WaveletDetector WaveletDetector;
 // min_freq: Minimum frequency to check (e.g., 2000Hz for unvoiced)
 // max_freq: Maximum frequency to check (e.g., 8000Hz)
 // num_scales: Number of scales (frequencies) to analyze
+// engine: Filter bank implementation (see above)
+// multirate: Run each scale at the lowest octave rate that resolves it
+// simd: Kernels to run with (see simd_dispatch.h)
+// arena: Memory for the detector, kernels, histories and FFT plans (see
+//        arena.h); NULL is returned while measuring
 WaveletDetector *wavelet_create(int sample_rate, float min_freq, float max_freq,
-                                int num_scales, void *(*alloc_fn)(size_t));
-
-// Destroy the detector
-void wavelet_destroy(WaveletDetector *wd, void (*free_fn)(void *));
+                                int num_scales, SyllableWaveletEngine engine,
+                                int multirate, const SimdKernels *simd,
+                                DspArena *arena);
 
 // Reset state
 void wavelet_reset(WaveletDetector *wd);
@@ -34,9 +79,20 @@ void wavelet_reset(WaveletDetector *wd);
 // Returns the "transient score" (0.0 to 1.0+) indicating likelihood of an onset
 float wavelet_process(WaveletDetector *wd, float sample);
 
+// Process a block of samples, writing the transient score for each sample.
+// Equivalent to calling wavelet_process once per sample. The convolution engine
+// switches to FFT overlap-save when the block is long enough for it to pay
+// off (results then match per-sample processing up to float rounding).
+void wavelet_process_block(WaveletDetector *wd, const float *in, float *out,
+                           int n);
+
 // Get current energy at a specific scale index
 float wavelet_get_energy(WaveletDetector *wd, int scale_idx);
 
+// Input samples per sample of the lowest octave level (1 unless multi-rate).
+// Output depends on the input position modulo this period.
+int wavelet_decimation(const WaveletDetector *wd);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,32 +1,42 @@
 #include "zff.h"
+#include "lanes.h"
 #include <stdlib.h>
 #include <string.h>
 
 
-void zff_init(ZFF *z, int sample_rate, float trend_window_ms,
-              void *(*custom_alloc)(size_t)) {
-  z->int1 = 0.0;
-  z->int2 = 0.0;
+// Sum of the trend window. The running sum is rebuilt from it once per window
+// so its rounding error does not accumulate: the output then depends only on
+// recent input, however long the stream.
+static float trend_window_sum(const float *trend, int size) {
+  float sum = 0.0f;
+  for (int i = 0; i < size; i++)
+    sum += trend[i];
+  return sum;
+}
 
+int zff_init(ZFF *z, int sample_rate, float trend_window_ms,
+             DspArena *arena) {
   // Window size in samples
-  z->trend_buf_size = (int)(sample_rate * trend_window_ms * 0.001f);
-  if (z->trend_buf_size < 1)
-    z->trend_buf_size = 1;
+  int buf_size = (int)(sample_rate * trend_window_ms * 0.001f);
+  if (buf_size < 1)
+    buf_size = 1;
 
-  size_t buf_bytes = z->trend_buf_size * sizeof(float);
-  if (custom_alloc) {
-    z->trend_buffer = (float *)custom_alloc(buf_bytes);
-  } else {
-    z->trend_buffer = (float *)malloc(buf_bytes);
-  }
+  size_t buf_bytes = buf_size * sizeof(float);
+  float *buffer = (float *)dsp_arena_alloc(arena, buf_bytes);
+  if (!dsp_arena_ok(arena))
+    return 0;
+
+  z->int1 = 0.0;
+  z->int2 = 0.0;
+  z->trend_buffer = buffer;
+  z->trend_buf_size = buf_size;
 
   // Zero out buffer
-  if (z->trend_buffer) {
-    memset(z->trend_buffer, 0, buf_bytes);
-  }
+  memset(z->trend_buffer, 0, buf_bytes);
 
   z->trend_write_pos = 0;
   z->trend_accum = 0.0f;
+  return 1;
 }
 
 void zff_process(ZFF *z, float in, float *zff_out, float *slope_out) {
@@ -127,8 +137,10 @@ void zff_process(ZFF *z, float in, float *zff_out, float *slope_out) {
     z->trend_buffer[z->trend_write_pos] = val;
     z->trend_accum += val - old_val;
     z->trend_write_pos++;
-    if (z->trend_write_pos >= z->trend_buf_size)
+    if (z->trend_write_pos >= z->trend_buf_size) {
       z->trend_write_pos = 0;
+      z->trend_accum = trend_window_sum(z->trend_buffer, z->trend_buf_size);
+    }
 
     float trend = z->trend_accum / z->trend_buf_size;
     *zff_out = val - trend;
@@ -141,13 +153,98 @@ void zff_process(ZFF *z, float in, float *zff_out, float *slope_out) {
   *slope_out = 0.0f; // TODO: Maintain history for slope if needed
 }
 
-void zff_destroy(ZFF *z, void (*custom_free)(void *)) {
-  if (z->trend_buffer) {
-    if (custom_free) {
-      custom_free(z->trend_buffer);
-    } else {
-      free(z->trend_buffer);
+void zff_process_block(ZFF *z, const float *in, float *zff_out, int n) {
+  // Same arithmetic as zff_process, state kept in locals across the block
+  const double leak = 0.999;
+  double int1 = z->int1;
+  double int2 = z->int2;
+
+  if (!z->trend_buffer) {
+    for (int i = 0; i < n; i++) {
+      int1 += (double)in[i];
+      int2 += int1;
+      int1 = int1 * leak + (double)in[i];
+      int2 = int2 * leak + int1;
+      zff_out[i] = (float)int2;
+    }
+    z->int1 = int1;
+    z->int2 = int2;
+    return;
+  }
+
+  float *trend = z->trend_buffer;
+  const int size = z->trend_buf_size;
+  int pos = z->trend_write_pos;
+  float accum = z->trend_accum;
+
+  for (int i = 0; i < n; i++) {
+    int1 += (double)in[i];
+    int2 += int1;
+    int1 = int1 * leak + (double)in[i];
+    int2 = int2 * leak + int1;
+
+    float val = (float)int2;
+    float old_val = trend[pos];
+    trend[pos] = val;
+    accum += val - old_val;
+    if (++pos >= size) {
+      pos = 0;
+      accum = trend_window_sum(trend, size);
+    }
+
+    zff_out[i] = val - accum / size;
+  }
+
+  z->int1 = int1;
+  z->int2 = int2;
+  z->trend_write_pos = pos;
+  z->trend_accum = accum;
+}
+
+void zff_process_lanes(ZFF *const *z, int lanes, const float *in,
+                       float *zff_out, int n) {
+  const double leak = 0.999;
+  double int1[DSP_MAX_LANES], int2[DSP_MAX_LANES];
+  for (int l = 0; l < lanes; l++) {
+    int1[l] = z[l]->int1;
+    int2[l] = z[l]->int2;
+  }
+  for (int i = 0; i < n; i++) {
+    const float *xi = in + i * lanes;
+    float *yi = zff_out + i * lanes;
+    for (int l = 0; l < lanes; l++) {
+      double a = int1[l] + (double)xi[l];
+      double b = int2[l] + a;
+      a = a * leak + (double)xi[l];
+      b = b * leak + a;
+      int1[l] = a;
+      int2[l] = b;
+      yi[l] = (float)b;
+    }
+  }
+
+  for (int l = 0; l < lanes; l++) {
+    z[l]->int1 = int1[l];
+    z[l]->int2 = int2[l];
+    if (!z[l]->trend_buffer)
+      continue;
+
+    float *trend = z[l]->trend_buffer;
+    const int size = z[l]->trend_buf_size;
+    int pos = z[l]->trend_write_pos;
+    float accum = z[l]->trend_accum;
+    for (int i = 0; i < n; i++) {
+      float val = zff_out[i * lanes + l];
+      float old_val = trend[pos];
+      trend[pos] = val;
+      accum += val - old_val;
+      if (++pos >= size) {
+        pos = 0;
+        accum = trend_window_sum(trend, size);
+      }
+      zff_out[i * lanes + l] = val - accum / size;
     }
-    z->trend_buffer = NULL;
+    z[l]->trend_write_pos = pos;
+    z[l]->trend_accum = accum;
   }
 }
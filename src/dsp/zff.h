@@ -10,11 +10,19 @@ typedef struct {
   float trend_accum;
 } ZFF;
 
+#include "arena.h"
 #include <stddef.h>
 
-void zff_init(ZFF *z, int sample_rate, float trend_window_ms,
-              void *(*custom_alloc)(size_t));
+// Takes the trend buffer from arena (see arena.h). Returns 0, leaving z
+// untouched, while measuring or on failure.
+int zff_init(ZFF *z, int sample_rate, float trend_window_ms, DspArena *arena);
 void zff_process(ZFF *z, float in, float *zff_out, float *slope_out);
-void zff_destroy(ZFF *z, void (*custom_free)(void *));
+// Block variant of zff_process (slope output is omitted; it is always 0)
+void zff_process_block(ZFF *z, const float *in, float *zff_out, int n);
+// zff_process_block over lanes <= DSP_MAX_LANES instances, samples
+// interleaved by lane (see lanes.h). The integrators run across lanes; the
+// trend removal then walks each lane's own buffer.
+void zff_process_lanes(ZFF *const *z, int lanes, const float *in,
+                       float *zff_out, int n);
 
 #endif
@@ -12,11 +12,20 @@
 
 #include "syllable_detector.h"
 #include "dsp/agc.h"
+#include "dsp/arena.h"
 #include "dsp/biquad.h"
+#include "dsp/decimator.h"
 #include "dsp/envelope.h"
 #include "dsp/high_freq_energy.h"
+#include "dsp/lanes.h"
 #include "dsp/mfcc.h"
+#include "dsp/resampler.h"
+#include "dsp/running_median.h"
+#include "dsp/simd_dispatch.h"
+#include "dsp/simd_utils.h"
 #include "dsp/spectral_flux.h"
+#include "dsp/spsc_ring.h"
+#include "dsp/stft.h"
 #include "dsp/wavelet.h"
 #include "dsp/zff.h"
 #include <float.h>
@@ -27,22 +36,107 @@
 
 // --- Constants & Defaults ---
 #define DEFAULT_SAMPLE_RATE 44100
-#define PROMINENCE_BUFFER_SIZE 16 // Power of 2
 #define SILENCE_THRESHOLD 0.001f
 #define FEATURE_HISTORY_SIZE 32 // For feature normalization
-#define FUSION_HISTORY_SIZE 64  // For online threshold (median+MAD)
+#define FUSION_WINDOW_HOP 16    // Samples between fusion window scores
+#define PROCESS_BLOCK_SIZE 256  // Samples per stage pass in syllable_process
+#define TEO_ALPHA 0.001f        // TEO statistics EMA coefficient (per sample)
+
+// Low-rate front-end: decimated blocks are at most half as long
+#define LOW_RATE_BLOCK_SIZE (PROCESS_BLOCK_SIZE / 2)
+
+// Events syllable_pump collects per block before queueing them
+#define STREAM_EVENT_CHUNK 16
+
+// Most events handed to the batch event callback at once
+#define EVENT_BATCH_SIZE 16
 
 // Real-Time Mode Constants
 #define RT_NUM_FEATURES 6
 #define RT_BUF_SIZE 100
 #define RT_MIN_THRESH 1e-9f
 
+// --- Performance Counters ---
+
+// PERF_START(t) declares timestamp t; PERF_LAP(d, stage, t, calls) charges
+// the time since t to stage and restarts t. Both vanish unless the library is
+// built with SYLLABLE_PERF_COUNTERS.
+#ifdef SYLLABLE_PERF_COUNTERS
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PERF_CYCLES 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define PERF_CYCLES 1
+#else
+#include <time.h>
+#define PERF_CYCLES 0
+#endif
+
+static inline uint64_t perf_now(void) {
+#if PERF_CYCLES
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline void perf_lap(SyllablePerfCounters *c, SyllablePerfStage stage,
+                            uint64_t *t, uint64_t calls) {
+  uint64_t now = perf_now();
+  c->ticks[stage] += now - *t;
+  c->calls[stage] += calls;
+  *t = now;
+}
+
+#define PERF_START(t) uint64_t t = perf_now()
+#define PERF_LAP(d, stage, t, calls) perf_lap(&(d)->perf, stage, &(t), calls)
+#else
+#define PERF_START(t) ((void)0)
+#define PERF_LAP(d, stage, t, calls) ((void)0)
+#endif
+
+#if MFCC_NUM_COEFFS != SYLLABLE_MFCC_COEFFS
+#error "SyllableFeatureFrame.mfcc must hold MFCC_NUM_COEFFS coefficients"
+#endif
+
 // --- Internal Structs ---
 
+// Per-stage outputs for one block of syllable_process. Every DSP stage runs
+// over the whole block before the decision stage walks the results.
 typedef struct {
-  SyllableEvent event;
-  int is_ready;
-} BufferedEvent;
+  float signal[PROCESS_BLOCK_SIZE];  // AGC output (input to every stage)
+  float zff[PROCESS_BLOCK_SIZE];     // ZFF trend-removed output
+  float env[PROCESS_BLOCK_SIZE];     // PeakRate band envelope
+  float teo_z[PROCESS_BLOCK_SIZE];   // TEO z-score
+  float ler[PROCESS_BLOCK_SIZE];     // Local energy ratio
+  float hfe[PROCESS_BLOCK_SIZE];     // High-frequency energy
+  float wavelet[PROCESS_BLOCK_SIZE]; // Wavelet transient score
+
+  // STFT hops: sample offset and per-frame feature values of each hop
+  int hop[PROCESS_BLOCK_SIZE];
+  float flux[PROCESS_BLOCK_SIZE];
+  float flux_weber[PROCESS_BLOCK_SIZE];
+  float mfcc_delta[PROCESS_BLOCK_SIZE];
+  float flatness[PROCESS_BLOCK_SIZE]; // Recorded only while tracing
+  float flatness_weber_start; // Flatness Weber ratio before the block
+  int n_hops;
+} BlockScratch;
+
+// Outputs of the low-rate front-end, each interpolated to the BlockScratch
+// array of the same name
+enum { LOW_ZFF, LOW_ENV, LOW_TEO_Z, LOW_LER, LOW_RATE_OUTPUTS };
+
+// ZFF, PeakRate envelope and TEO/LER on the decimated front-end: one block
+// at the low rate, and the last two low-rate values of each output before it,
+// which its interpolation back to the input rate starts from
+typedef struct {
+  float signal[LOW_RATE_BLOCK_SIZE]; // Decimated AGC output
+  float out[LOW_RATE_OUTPUTS][LOW_RATE_BLOCK_SIZE];
+  float tail[LOW_RATE_OUTPUTS][2];
+} LowRateBlock;
 
 // Feature statistics for normalization
 typedef struct {
@@ -65,15 +159,29 @@ typedef struct {
 } RealtimeCalibration;
 
 struct SyllableDetector {
-  SyllableConfig config;
+  SyllableConfig config; // sample_rate is the analysis rate
   uint64_t total_samples;
 
-  // DSP Modules (Legacy)
+  // Input resampling to the analysis rate (config.analysis_rate_hz). Every
+  // sample count of the detector, total_samples included, is in analysis
+  // samples; event and trace timestamps are mapped back to input samples.
+  Resampler *resampler; // NULL: the input is analyzed at its own rate
+  int input_rate;       // Rate of the audio passed in (Hz)
+  int input_block;      // Input samples per block: at most PROCESS_BLOCK_SIZE
+                        // analysis samples come out of one
+  float *resample_in;   // Integer PCM converted ahead of the resampler
+
+  // DSP Modules (Legacy). With a decimator these run at the low rate
+  // (config.front_end_rate_hz) and are interpolated back to the input rate.
   Biquad bp_filter;
   EnvelopeFollower env_follower;
   ZFF zff;
+  Decimator *decimator; // NULL: the front-end runs at the input rate
+  float front_end_rate; // Rate of the stages above (Hz)
 
   // DSP Modules (NEW - Multi-Feature)
+  const SimdKernels *simd; // Chosen once for this CPU (see simd_dispatch.h)
+  StftFrontEnd *stft; // Shared analysis frames for Spectral Flux and MFCC
   SpectralFlux *spectral_flux;
   HighFreqEnergy *high_freq_energy;
   MFCC *mfcc;
@@ -89,6 +197,7 @@ struct SyllableDetector {
   float last_zff_val;
   float last_zff_slope;
   int last_epoch_samples_ago;
+  float last_epoch_frac; // Epoch's sub-sample offset before its sample
   float current_f0;
   float smoothed_f0;       // EMA-smoothed F0
   float prev_smoothed_f0;  // Previous frame F0 (for derivative)
@@ -102,12 +211,8 @@ struct SyllableDetector {
   float f0_baseline_alpha; // EMA coefficient for baseline
   float f0_semitone_diff;  // Current F0 - baseline in semitones
 
-  // Online threshold: fusion score history for median+MAD
-  float fusion_history[FUSION_HISTORY_SIZE];
-  int fusion_history_idx;
-  int fusion_history_count;
-  float fusion_median; // Running median
-  float fusion_mad;    // Median Absolute Deviation
+  // Exact median and MAD of recent fusion scores (NULL: left out)
+  RunningMedian *fusion_window;
 
   int voicing_counter;
   int unvoiced_counter;
@@ -122,6 +227,7 @@ struct SyllableDetector {
   float prev_sample;      // x[n-1] for TEO
   float prev_prev_sample; // x[n-2] for TEO (actually x[n+1] relative to prev)
   float current_teo;      // Current TEO value
+  float teo_alpha;        // EMA coefficient for teo_mean / teo_var
   float teo_mean;         // Running mean for normalization
   float teo_var;          // Running variance
 
@@ -129,6 +235,8 @@ struct SyllableDetector {
   float short_energy; // Short-term energy (EMA, ~20ms)
   float long_energy;  // Long-term energy (EMA, ~500ms)
   float current_ler;  // Short/Long ratio
+  float ler_alpha_short; // EMA coefficient for short_energy
+  float ler_alpha_long;  // EMA coefficient for long_energy
 
   // Adaptive PeakRate Threshold
   int adaptive_enabled;
@@ -172,16 +280,49 @@ struct SyllableDetector {
   SyllableOnsetType current_onset_type;
 
   // Event Buffer (Ring Buffer) for Prominence Context
-  BufferedEvent event_buffer[PROMINENCE_BUFFER_SIZE];
+  SyllableEvent *event_buffer; // In the block, or on the heap once grown
+  int event_buffer_size;
   int buf_write_idx;
   int buf_read_idx;
   int buf_count;
+  uint64_t event_overflows;              // Events dropped: buffer full
+  void *event_buffer_heap;               // Grown buffer (EVENT_OVERFLOW_GROW)
+  const SyllableEvent **context_scratch; // context_size events
+  float *context_f0;                     // context_size F0 values
 
   // Real-Time Calibration State
   RealtimeCalibration rt_cal;
 
-  // Memory
-  void *(*alloc_fn)(size_t);
+  // Block engine scratch
+  BlockScratch blk;
+  LowRateBlock low;
+
+  // Streaming queues (NULL: stream_buffer_ms is 0)
+  SpscRing *audio_ring; // Input samples, syllable_push -> syllable_pump
+  SpscRing *event_ring; // Events, syllable_pump -> syllable_pop_events
+
+  // Event callbacks (both NULL: events go to events_out)
+  SyllableEventFn event_fn;
+  void *event_user;
+  SyllableEventBatchFn event_batch_fn;
+  void *event_batch_user;
+  SyllableEvent event_batch[EVENT_BATCH_SIZE]; // Collected for event_batch_fn
+  int event_batch_count;
+
+  // Feature trace (NULL trace_fn: disabled)
+  SyllableFeatureTraceFn trace_fn;
+  void *trace_user;
+  float *hop_mfcc;     // MFCCs of each hop of the block, recorded while tracing
+  int trace_hop_size;  // Hop length when there is no STFT to define hops
+  int trace_since_hop; // Samples since the last hop without an STFT
+
+#ifdef SYLLABLE_PERF_COUNTERS
+  SyllablePerfCounters perf;
+#endif
+
+  // Memory: the detector and all of its modules live in this one block
+  void *block;
+  void *(*alloc_fn)(size_t); // Only for EVENT_OVERFLOW_GROW
   void (*free_fn)(void *);
 };
 
@@ -201,12 +342,26 @@ static float bandpass_q_factor(const SyllableConfig *cfg) {
   return bandpass_center_hz(cfg) / bandwidth;
 }
 
-static void configure_bandpass(Biquad *filter, const SyllableConfig *cfg) {
+static void configure_bandpass(Biquad *filter, const SyllableConfig *cfg,
+                               float sample_rate) {
   float q = bandpass_q_factor(cfg);
   if (q < 0.1f)
     q = 0.1f;
-  biquad_config_bandpass(filter, (float)cfg->sample_rate,
-                         bandpass_center_hz(cfg), q);
+  biquad_config_bandpass(filter, sample_rate, bandpass_center_hz(cfg), q);
+}
+
+// Decimation factor of the front-end (1: it runs at the input rate). The
+// low rate is at least front_end_rate_hz, and high enough for the PeakRate
+// band to stay inside the decimator's passband.
+static int front_end_decimation(const SyllableConfig *cfg) {
+  if (cfg->front_end_rate_hz <= 0.0f)
+    return 1;
+  float rate = cfg->front_end_rate_hz;
+  float min_rate = cfg->peak_rate_band_max / DECIMATOR_PASSBAND;
+  if (rate < min_rate)
+    rate = min_rate;
+  int factor = (int)(cfg->sample_rate / rate);
+  return factor > 1 ? factor : 1;
 }
 
 // Initialize feature statistics
@@ -440,9 +595,11 @@ SyllableConfig syllable_default_config(int sample_rate) {
   memset(&cfg, 0, sizeof(cfg));
 
   cfg.sample_rate = sample_rate > 0 ? sample_rate : DEFAULT_SAMPLE_RATE;
+  cfg.analysis_rate_hz = 0;
   cfg.zff_trend_window_ms = 10.0f;
   cfg.peak_rate_band_min = 500.0f;
   cfg.peak_rate_band_max = 3200.0f;
+  cfg.front_end_rate_hz = 0.0f;
   cfg.min_syllable_dist_ms = 150.0f;
   cfg.threshold_peak_rate = 0.0003f;
   cfg.adaptive_peak_rate_k = 4.0f;
@@ -451,6 +608,8 @@ SyllableConfig syllable_default_config(int sample_rate) {
   cfg.hysteresis_on_factor = 1.2f;
   cfg.hysteresis_off_factor = 0.8f;
   cfg.context_size = 2;
+  cfg.event_backlog = 13;
+  cfg.event_overflow = EVENT_OVERFLOW_DROP_OLDEST;
 
   // Multi-Feature Detection defaults
   cfg.enable_spectral_flux = 1;
@@ -462,6 +621,11 @@ SyllableConfig syllable_default_config(int sample_rate) {
   cfg.fft_size_ms = 32.0f;
   cfg.hop_size_ms = 16.0f;
   cfg.high_freq_cutoff_hz = 2000.0f;
+  cfg.wavelet_min_freq_hz = 2000.0f;
+  cfg.wavelet_max_freq_hz = 6000.0f;
+  cfg.wavelet_num_scales = 3;
+  cfg.wavelet_engine = WAVELET_ENGINE_CONVOLUTION;
+  cfg.wavelet_multirate = 0;
 
   // Feature weights (tuned for balanced detection)
   cfg.weight_peak_rate = 0.30f;
@@ -473,6 +637,7 @@ SyllableConfig syllable_default_config(int sample_rate) {
 
   // Fusion blend ratio (alpha * max + (1-alpha) * avg)
   cfg.fusion_blend_alpha = 0.6f;
+  cfg.fusion_window_size = 0;
 
   cfg.unvoiced_onset_threshold = 0.5f;
   cfg.allow_unvoiced_onsets = 1;
@@ -482,42 +647,47 @@ SyllableConfig syllable_default_config(int sample_rate) {
   cfg.calibration_duration_ms = 2000.0f;
   cfg.snr_threshold_db = 6.0f;
 
+  // Streaming defaults (off)
+  cfg.stream_buffer_ms = 0.0f;
+  cfg.stream_event_capacity = 64;
+
   cfg.user_malloc = NULL;
   cfg.user_free = NULL;
 
   return cfg;
 }
 
-// Calculate delta_f0: difference from context median
-static void calculate_delta_f0(SyllableDetector *d, int target_idx) {
-  BufferedEvent *target = &d->event_buffer[target_idx];
-  if (!target->is_ready) {
-    target->event.delta_f0 = 0.0f;
-    return;
+// Gather the context of the oldest buffered event: the events buffered after
+// it, up to context_size (those before it have already been emitted).
+// Returns the count.
+static int gather_context(const SyllableDetector *d) {
+  int count = d->buf_count - 1;
+  if (count > d->config.context_size)
+    count = d->config.context_size;
+
+  int idx = d->buf_read_idx;
+  for (int i = 0; i < count; i++) {
+    if (++idx == d->event_buffer_size)
+      idx = 0;
+    d->context_scratch[i] = &d->event_buffer[idx];
   }
+  return count;
+}
 
-  // Gather F0 values from context
-  float f0_values[PROMINENCE_BUFFER_SIZE];
+// delta_f0: difference from the median F0 of the context. f0_values is
+// scratch for count values.
+static float context_delta_f0(const SyllableEvent *target,
+                              const SyllableEvent *const *context, int count,
+                              float *f0_values) {
   int f0_count = 0;
 
-  for (int i = 1; i <= d->config.context_size; i++) {
-    int prev_idx =
-        (target_idx - i + PROMINENCE_BUFFER_SIZE) % PROMINENCE_BUFFER_SIZE;
-    if (d->event_buffer[prev_idx].is_ready &&
-        d->event_buffer[prev_idx].event.f0 > 50.0f) {
-      f0_values[f0_count++] = d->event_buffer[prev_idx].event.f0;
-    }
-    int next_idx = (target_idx + i) % PROMINENCE_BUFFER_SIZE;
-    if (d->event_buffer[next_idx].is_ready &&
-        d->event_buffer[next_idx].event.f0 > 50.0f) {
-      f0_values[f0_count++] = d->event_buffer[next_idx].event.f0;
-    }
+  for (int i = 0; i < count; i++) {
+    if (context[i]->f0 > 50.0f)
+      f0_values[f0_count++] = context[i]->f0;
   }
 
-  if (f0_count == 0 || target->event.f0 < 50.0f) {
-    target->event.delta_f0 = 0.0f;
-    return;
-  }
+  if (f0_count == 0 || target->f0 < 50.0f)
+    return 0.0f;
 
   // Simple median approximation: sort and take middle
   for (int i = 0; i < f0_count - 1; i++) {
@@ -530,43 +700,26 @@ static void calculate_delta_f0(SyllableDetector *d, int target_idx) {
     }
   }
   float median_f0 = f0_values[f0_count / 2];
-  target->event.delta_f0 = target->event.f0 - median_f0;
+  return target->f0 - median_f0;
 }
 
-static float calculate_prominence(SyllableDetector *d, int target_idx) {
-  BufferedEvent *target = &d->event_buffer[target_idx];
-  if (!target->is_ready)
-    return 0.0f;
-
+// Prominence of target relative to its context
+static float context_prominence(const SyllableEvent *target,
+                                const SyllableEvent *const *context,
+                                int count) {
   float local_avg_energy = 0.0f;
   float local_avg_pr = 0.0f;
   float local_avg_dur = 0.0f;
   float local_avg_slope = 0.0f;
   float local_avg_fusion = 0.0f;
-  int count = 0;
 
   // Gather context values
-  for (int i = 1; i <= d->config.context_size; i++) {
-    int prev_idx =
-        (target_idx - i + PROMINENCE_BUFFER_SIZE) % PROMINENCE_BUFFER_SIZE;
-    if (d->event_buffer[prev_idx].is_ready) {
-      local_avg_energy += d->event_buffer[prev_idx].event.energy;
-      local_avg_pr += d->event_buffer[prev_idx].event.peak_rate;
-      local_avg_dur += d->event_buffer[prev_idx].event.duration_s;
-      local_avg_slope += d->event_buffer[prev_idx].event.pr_slope;
-      local_avg_fusion += d->event_buffer[prev_idx].event.fusion_score;
-      count++;
-    }
-
-    int next_idx = (target_idx + i) % PROMINENCE_BUFFER_SIZE;
-    if (d->event_buffer[next_idx].is_ready) {
-      local_avg_energy += d->event_buffer[next_idx].event.energy;
-      local_avg_pr += d->event_buffer[next_idx].event.peak_rate;
-      local_avg_dur += d->event_buffer[next_idx].event.duration_s;
-      local_avg_slope += d->event_buffer[next_idx].event.pr_slope;
-      local_avg_fusion += d->event_buffer[next_idx].event.fusion_score;
-      count++;
-    }
+  for (int i = 0; i < count; i++) {
+    local_avg_energy += context[i]->energy;
+    local_avg_pr += context[i]->peak_rate;
+    local_avg_dur += context[i]->duration_s;
+    local_avg_slope += context[i]->pr_slope;
+    local_avg_fusion += context[i]->fusion_score;
   }
 
   if (count == 0)
@@ -579,33 +732,31 @@ static float calculate_prominence(SyllableDetector *d, int target_idx) {
   local_avg_fusion /= count;
 
   // Calculate individual ratio scores
-  float e_score = (target->event.energy > 0)
-                      ? (target->event.energy / (local_avg_energy + 0.0001f))
+  float e_score = (target->energy > 0)
+                      ? (target->energy / (local_avg_energy + 0.0001f))
                       : 0.0f;
-  float pr_score = (target->event.peak_rate > 0)
-                       ? (target->event.peak_rate / (local_avg_pr + 0.0001f))
+  float pr_score = (target->peak_rate > 0)
+                       ? (target->peak_rate / (local_avg_pr + 0.0001f))
                        : 0.0f;
-  float d_score = (target->event.duration_s > 0)
-                      ? (target->event.duration_s / (local_avg_dur + 0.0001f))
+  float d_score = (target->duration_s > 0)
+                      ? (target->duration_s / (local_avg_dur + 0.0001f))
                       : 0.0f;
-  float slope_score =
-      (target->event.pr_slope > 0)
-          ? (target->event.pr_slope / (local_avg_slope + 0.0001f))
-          : 0.0f;
+  float slope_score = (target->pr_slope > 0)
+                          ? (target->pr_slope / (local_avg_slope + 0.0001f))
+                          : 0.0f;
   float fusion_score_ratio =
-      (target->event.fusion_score > 0)
-          ? (target->event.fusion_score / (local_avg_fusion + 0.0001f))
+      (target->fusion_score > 0)
+          ? (target->fusion_score / (local_avg_fusion + 0.0001f))
           : 0.0f;
 
   // F0 change bonus
-  float f0_bonus =
-      (target->event.delta_f0 > 0) ? (target->event.delta_f0 / 50.0f) : 0.0f;
+  float f0_bonus = (target->delta_f0 > 0) ? (target->delta_f0 / 50.0f) : 0.0f;
   if (f0_bonus > 1.0f)
     f0_bonus = 1.0f;
 
   // Stress integral: FusionScore × Duration (key Weber-Fechner metric)
   // This captures "how strong and how long" the syllable is
-  float stress_integral = target->event.fusion_score * target->event.duration_s;
+  float stress_integral = target->fusion_score * target->duration_s;
   float avg_stress = local_avg_fusion * local_avg_dur;
   float stress_ratio =
       (avg_stress > 0.001f) ? (stress_integral / avg_stress) : 1.0f;
@@ -616,12 +767,12 @@ static float calculate_prominence(SyllableDetector *d, int target_idx) {
   // energy) Positive semitone difference = pitch higher than baseline =
   // potential accent Bonus kicks in at 2+ semitones above baseline
   float f0_level_bonus = 0.0f;
-  if (target->event.f0 > 60.0f) { // Valid F0
+  if (target->f0 > 60.0f) { // Valid F0
     // Approximate semitone diff from stored F0 and typical baseline
     // This is a simplified version; ideally we'd store f0_semitone_diff per
     // event
-    float f0_norm = target->event.f0 / 150.0f;  // Normalize around typical F0
-    if (f0_norm > 1.1f) {                       // Higher than average
+    float f0_norm = target->f0 / 150.0f;       // Normalize around typical F0
+    if (f0_norm > 1.1f) {                      // Higher than average
       f0_level_bonus = (f0_norm - 1.0f) * 0.5f; // Scale to 0-0.15 range
       if (f0_level_bonus > 0.15f)
         f0_level_bonus = 0.15f;
@@ -639,107 +790,303 @@ static float calculate_prominence(SyllableDetector *d, int target_idx) {
   return score;
 }
 
-// --- API Implementation ---
-
-SyllableDetector *syllable_create(const SyllableConfig *config) {
-  SyllableConfig cfg =
-      config ? *config : syllable_default_config(DEFAULT_SAMPLE_RATE);
-
-  void *(*alloc)(size_t) = cfg.user_malloc ? cfg.user_malloc : default_malloc;
-
-  SyllableDetector *d = (SyllableDetector *)alloc(sizeof(SyllableDetector));
-  if (!d)
-    return NULL;
-
-  memset(d, 0, sizeof(SyllableDetector));
-  d->config = cfg;
-  d->alloc_fn = alloc;
-  d->free_fn = cfg.user_free ? cfg.user_free : default_free;
-
-  // Init Legacy DSP
-  biquad_reset(&d->bp_filter);
-  configure_bandpass(&d->bp_filter, &cfg);
-
-  envelope_init(&d->env_follower, (float)cfg.sample_rate, 5.0f, 20.0f);
-
-  zff_init(&d->zff, cfg.sample_rate, cfg.zff_trend_window_ms, d->alloc_fn);
+// Calculate delta_f0 of the oldest buffered event from its context
+static void calculate_delta_f0(SyllableDetector *d) {
+  SyllableEvent *target = &d->event_buffer[d->buf_read_idx];
+  int count = gather_context(d);
+  target->delta_f0 =
+      context_delta_f0(target, d->context_scratch, count, d->context_f0);
+}
 
-  d->voiced_hold_samples = (int)(cfg.voiced_hold_ms * 0.001f * cfg.sample_rate);
-  if (d->voiced_hold_samples < 1)
-    d->voiced_hold_samples = 1;
+// Prominence of the oldest buffered event from its context
+static float calculate_prominence(SyllableDetector *d) {
+  const SyllableEvent *target = &d->event_buffer[d->buf_read_idx];
+  int count = gather_context(d);
+  return context_prominence(target, d->context_scratch, count);
+}
 
-  // IMPROVED: Set max time for ONSET_RISING state (50ms)
-  d->max_onset_rising_samples = (int)(0.050f * cfg.sample_rate);
+// Double the event buffer, keeping the buffered events in order. Returns 0 if
+// memory runs out.
+static int grow_event_buffer(SyllableDetector *d) {
+  int size = 2 * d->event_buffer_size;
+  SyllableEvent *grown =
+      (SyllableEvent *)d->alloc_fn((size_t)size * sizeof(SyllableEvent));
+  if (!grown)
+    return 0;
+  memset(grown, 0, (size_t)size * sizeof(SyllableEvent));
+
+  int idx = d->buf_read_idx;
+  for (int i = 0; i < d->buf_count; i++) {
+    grown[i] = d->event_buffer[idx];
+    if (++idx == d->event_buffer_size)
+      idx = 0;
+  }
+  if (d->event_buffer_heap)
+    d->free_fn(d->event_buffer_heap);
 
-  // Initialize F0 smoothing and energy tracking
-  d->smoothed_f0 = 0.0f;
-  d->prev_smoothed_f0 = 0.0f;
-  d->f0_derivative = 0.0f;
-  d->min_f0_since_peak = 0.0f;
-  d->f0_has_risen = 1; // Start as true to allow first detection
-  d->f0_jump_counter = 0;
-  d->current_energy = 0.0f;
-  d->energy_floor = 0.0f;
+  d->event_buffer = grown;
+  d->event_buffer_heap = grown;
+  d->event_buffer_size = size;
+  d->buf_read_idx = 0;
+  d->buf_write_idx = d->buf_count;
+  return 1;
+}
 
-  // Initialize TEO
-  d->prev_sample = 0.0f;
-  d->prev_prev_sample = 0.0f;
-  d->current_teo = 0.0f;
-  d->teo_mean = 0.0f;
-  d->teo_var = 0.0f;
+// Append a finished syllable. A full buffer grows or loses its oldest event,
+// as the overflow policy says.
+static void buffer_event(SyllableDetector *d, const SyllableEvent *evt) {
+  if (d->buf_count == d->event_buffer_size &&
+      !(d->config.event_overflow == EVENT_OVERFLOW_GROW &&
+        grow_event_buffer(d))) {
+    d->event_overflows++;
+    if (++d->buf_read_idx == d->event_buffer_size)
+      d->buf_read_idx = 0;
+    d->buf_count--;
+  }
 
-  // Initialize LER with EMA coefficients
-  // Short: ~20ms, Long: ~500ms
-  d->short_energy = 0.0f;
-  d->long_energy = 0.0001f; // Small value to avoid division by zero
-  d->current_ler = 1.0f;
+  d->event_buffer[d->buf_write_idx] = *evt;
+  if (++d->buf_write_idx == d->event_buffer_size)
+    d->buf_write_idx = 0;
+  d->buf_count++;
+}
 
-  // Initialize F0 baseline (for secondary accent detection)
-  d->f0_baseline = 0.0f;
-  d->f0_baseline_alpha = 1.0f - expf(-1.0f / (1.0f * cfg.sample_rate)); // ~1s
-  d->f0_semitone_diff = 0.0f;
+// Drop the oldest buffered event once it has been emitted
+static void release_oldest_event(SyllableDetector *d) {
+  if (++d->buf_read_idx == d->event_buffer_size)
+    d->buf_read_idx = 0;
+  d->buf_count--;
+}
 
-  // Initialize online threshold (fusion score history)
-  memset(d->fusion_history, 0, sizeof(d->fusion_history));
-  d->fusion_history_idx = 0;
-  d->fusion_history_count = 0;
-  d->fusion_median = 0.5f;
-  d->fusion_mad = 0.2f;
+// --- API Implementation ---
 
-  // Init Multi-Feature DSP
-  int fft_size = (int)(cfg.fft_size_ms * 0.001f * cfg.sample_rate);
+// Carve the detector and every DSP module it enables out of arena (see
+// dsp/arena.h). cfg->sample_rate is the analysis rate, which audio at
+// input_rate is resampled to. Returns NULL while measuring.
+static SyllableDetector *layout_detector(const SyllableConfig *cfg,
+                                         int input_rate,
+                                         const SimdKernels *simd,
+                                         DspArena *arena) {
+  int fft_size = (int)(cfg->fft_size_ms * 0.001f * cfg->sample_rate);
   // Round to power of 2
   int fft_power = 1;
   while (fft_power < fft_size)
     fft_power <<= 1;
   fft_size = fft_power;
 
-  int hop_size = (int)(cfg.hop_size_ms * 0.001f * cfg.sample_rate);
+  int hop_size = (int)(cfg->hop_size_ms * 0.001f * cfg->sample_rate);
+
+  SyllableDetector *d =
+      (SyllableDetector *)dsp_arena_alloc(arena, sizeof(SyllableDetector));
+
+  // Input resampling, in blocks that each yield at most PROCESS_BLOCK_SIZE
+  // analysis samples
+  int resample = input_rate != cfg->sample_rate;
+  int input_block = PROCESS_BLOCK_SIZE;
+  Resampler *resampler = NULL;
+  float *resample_in = NULL;
+  if (resample) {
+    input_block = resampler_max_input(input_rate, cfg->sample_rate,
+                                      PROCESS_BLOCK_SIZE);
+    resampler = resampler_create(input_rate, cfg->sample_rate, input_block,
+                                 simd, arena);
+    resample_in =
+        (float *)dsp_arena_alloc(arena, (size_t)input_block * sizeof(float));
+  }
+
+  // Decimated front-end for ZFF, the PeakRate envelope and TEO/LER
+  int decimation = front_end_decimation(cfg);
+  Decimator *decimator = NULL;
+  if (decimation > 1)
+    decimator = decimator_create(decimation, PROCESS_BLOCK_SIZE, simd, arena);
+
+  ZFF zff;
+  int zff_ok = zff_init(&zff, cfg->sample_rate / decimation,
+                        cfg->zff_trend_window_ms, arena);
+  RunningMedian *fusion_window = NULL;
+  if (cfg->fusion_window_size > 0)
+    fusion_window = running_median_create(cfg->fusion_window_size, arena);
+
+  // One windowed FFT per hop, shared by Spectral Flux and MFCC
+  int use_stft = cfg->enable_spectral_flux || cfg->enable_mfcc_delta;
+  StftFrontEnd *stft = NULL;
+  SpectralFlux *spectral_flux = NULL;
+  HighFreqEnergy *high_freq_energy = NULL;
+  MFCC *mfcc = NULL;
+  WaveletDetector *wavelet = NULL;
+  AgcState *agc = NULL;
+  if (use_stft) {
+    // Both read the complex spectrum and derive what they need from it
+    stft = stft_create(fft_size, hop_size, simd, arena);
+  }
 
-  if (cfg.enable_spectral_flux) {
-    d->spectral_flux =
-        spectral_flux_create(cfg.sample_rate, fft_size, hop_size, alloc);
+  if (cfg->enable_spectral_flux) {
+    spectral_flux = spectral_flux_create(fft_size, simd, arena);
   }
 
-  if (cfg.enable_high_freq_energy) {
-    d->high_freq_energy =
-        hfe_create(cfg.sample_rate, cfg.high_freq_cutoff_hz, 10.0f, alloc);
+  if (cfg->enable_high_freq_energy) {
+    high_freq_energy =
+        hfe_create(cfg->sample_rate, cfg->high_freq_cutoff_hz, 10.0f, arena);
   }
 
-  if (cfg.enable_mfcc_delta) {
-    d->mfcc = mfcc_create(cfg.sample_rate, fft_size, hop_size, alloc);
+  if (cfg->enable_mfcc_delta) {
+    mfcc = mfcc_create(cfg->sample_rate, fft_size, simd, arena);
   }
 
-  if (cfg.enable_wavelet) {
-    // 3 scales from 2000Hz to 6000Hz for high-frequency transients
-    d->wavelet = wavelet_create(cfg.sample_rate, 2000.0f, 6000.0f, 3, alloc);
+  if (cfg->enable_wavelet) {
+    // Default: 3 scales from 2000Hz to 6000Hz for high-frequency transients
+    wavelet = wavelet_create(
+        cfg->sample_rate, cfg->wavelet_min_freq_hz, cfg->wavelet_max_freq_hz,
+        cfg->wavelet_num_scales, (SyllableWaveletEngine)cfg->wavelet_engine,
+        cfg->wavelet_multirate, simd, arena);
   }
 
-  if (cfg.enable_agc) {
+  if (cfg->enable_agc) {
     // Target -23dB (broadcast standard), max gain 30dB
-    d->agc = agc_create(cfg.sample_rate, -23.0f, 30.0f, alloc);
+    agc = agc_create(cfg->sample_rate, -23.0f, 30.0f, arena);
+  }
+
+  // Per-hop MFCCs for the feature trace: at most one hop per hop_size samples
+  // of a block, plus one straddling its start
+  float *hop_mfcc = NULL;
+  if (cfg->enable_mfcc_delta) {
+    int max_hops = PROCESS_BLOCK_SIZE / (hop_size > 1 ? hop_size : 1) + 1;
+    if (max_hops > PROCESS_BLOCK_SIZE)
+      max_hops = PROCESS_BLOCK_SIZE;
+    hop_mfcc = (float *)dsp_arena_alloc(
+        arena, (size_t)max_hops * MFCC_NUM_COEFFS * sizeof(float));
+  }
+
+  // Prominence buffer: the syllables awaiting their context, the backlog
+  // awaiting events_out space, and scratch for scoring one against the other
+  int context_size = cfg->context_size; // >= 0, see syllable_create
+  int event_buffer_size =
+      context_size + 1 + (cfg->event_backlog > 0 ? cfg->event_backlog : 0);
+  SyllableEvent *event_buffer = (SyllableEvent *)dsp_arena_alloc(
+      arena, (size_t)event_buffer_size * sizeof(SyllableEvent));
+  const SyllableEvent **context_scratch =
+      (const SyllableEvent **)dsp_arena_alloc(
+          arena, (size_t)(context_size + 1) * sizeof(SyllableEvent *));
+  float *context_f0 = (float *)dsp_arena_alloc(
+      arena, (size_t)(context_size + 1) * sizeof(float));
+
+  // Streaming queues: audio at the input rate, at least one block of it
+  int streaming = cfg->stream_buffer_ms > 0.0f;
+  SpscRing *audio_ring = NULL;
+  SpscRing *event_ring = NULL;
+  if (streaming) {
+    size_t ring_samples =
+        (size_t)(cfg->stream_buffer_ms * 0.001f * input_rate);
+    if (ring_samples < (size_t)input_block)
+      ring_samples = (size_t)input_block;
+    int event_capacity =
+        cfg->stream_event_capacity > 0 ? cfg->stream_event_capacity : 1;
+    audio_ring = spsc_ring_create(ring_samples, sizeof(float), arena);
+    event_ring = spsc_ring_create((size_t)event_capacity,
+                                  sizeof(SyllableEvent), arena);
+  }
+
+  if (!dsp_arena_ok(arena) || !zff_ok ||
+      (cfg->fusion_window_size > 0 && !fusion_window) ||
+      (resample && !resampler) || (decimation > 1 && !decimator) ||
+      (streaming && (!audio_ring || !event_ring)) || (use_stft && !stft) ||
+      (cfg->enable_spectral_flux && !spectral_flux) ||
+      (cfg->enable_high_freq_energy && !high_freq_energy) ||
+      (cfg->enable_mfcc_delta && !mfcc) || (cfg->enable_wavelet && !wavelet) ||
+      (cfg->enable_agc && !agc))
+    return NULL;
+
+  memset(d, 0, sizeof(SyllableDetector));
+  d->resampler = resampler;
+  d->input_rate = input_rate;
+  d->input_block = input_block;
+  d->resample_in = resample_in;
+  d->zff = zff;
+  d->decimator = decimator;
+  d->front_end_rate = (float)cfg->sample_rate / decimation;
+  d->simd = simd;
+  d->stft = stft;
+  d->spectral_flux = spectral_flux;
+  d->high_freq_energy = high_freq_energy;
+  d->mfcc = mfcc;
+  d->wavelet = wavelet;
+  d->agc = agc;
+  d->hop_mfcc = hop_mfcc;
+  d->fusion_window = fusion_window;
+  d->event_buffer = event_buffer;
+  d->event_buffer_size = event_buffer_size;
+  d->context_scratch = context_scratch;
+  d->context_f0 = context_f0;
+  d->audio_ring = audio_ring;
+  d->event_ring = event_ring;
+  d->trace_hop_size = hop_size > 1 ? hop_size : 1;
+  return d;
+}
+
+SyllableDetector *syllable_create(const SyllableConfig *config) {
+  SyllableConfig cfg =
+      config ? *config : syllable_default_config(DEFAULT_SAMPLE_RATE);
+
+  if (cfg.context_size < 0)
+    cfg.context_size = 0;
+
+  // Everything from here on runs at the analysis rate
+  int input_rate = cfg.sample_rate;
+  if (cfg.analysis_rate_hz > 0)
+    cfg.sample_rate = cfg.analysis_rate_hz;
+
+  void *(*alloc)(size_t) = cfg.user_malloc ? cfg.user_malloc : default_malloc;
+  void (*free_fn)(void *) = cfg.user_free ? cfg.user_free : default_free;
+
+  // Kernels for this CPU, picked once for the detector's lifetime
+  const SimdKernels *simd = simd_select_kernels();
+
+  // Measure the footprint, then lay everything out in one zeroed block
+  DspArena arena;
+  dsp_arena_init(&arena, NULL, 0);
+  layout_detector(&cfg, input_rate, simd, &arena);
+  size_t block_size = dsp_arena_block_size(&arena);
+
+  void *block = alloc(block_size);
+  if (!block)
+    return NULL;
+  memset(block, 0, block_size);
+  dsp_arena_init(&arena, block, block_size);
+
+  SyllableDetector *d = layout_detector(&cfg, input_rate, simd, &arena);
+  if (!d) {
+    free_fn(block);
+    return NULL;
   }
 
+  d->config = cfg;
+  d->block = block;
+  d->alloc_fn = alloc;
+  d->free_fn = free_fn;
+
+  // Init Legacy DSP
+  biquad_reset(&d->bp_filter);
+  configure_bandpass(&d->bp_filter, &cfg, d->front_end_rate);
+
+  envelope_init(&d->env_follower, d->front_end_rate, 5.0f, 20.0f);
+
+  d->voiced_hold_samples = (int)(cfg.voiced_hold_ms * 0.001f * cfg.sample_rate);
+  if (d->voiced_hold_samples < 1)
+    d->voiced_hold_samples = 1;
+
+  // IMPROVED: Set max time for ONSET_RISING state (50ms)
+  d->max_onset_rising_samples = (int)(0.050f * cfg.sample_rate);
+
+  // EMA coefficients for LER (short ~20ms, long ~500ms) and the F0 baseline
+  // (~1s); the state they drive is initialized by syllable_reset. TEO/LER
+  // run at the front-end rate, and keep their time constants there.
+  d->ler_alpha_short = 1.0f - expf(-1.0f / (0.020f * d->front_end_rate));
+  d->ler_alpha_long = 1.0f - expf(-1.0f / (0.500f * d->front_end_rate));
+  d->f0_baseline_alpha = 1.0f - expf(-1.0f / (1.0f * cfg.sample_rate));
+  d->teo_alpha = TEO_ALPHA;
+  if (d->decimator)
+    d->teo_alpha = 1.0f - powf(1.0f - TEO_ALPHA,
+                               (float)decimator_factor(d->decimator));
+
   // Adaptive threshold
   d->adaptive_enabled =
       (cfg.adaptive_peak_rate_k > 0.0f && cfg.adaptive_peak_rate_tau_ms > 0.0f);
@@ -777,14 +1124,66 @@ void syllable_reset(SyllableDetector *d) {
   d->buf_read_idx = 0;
   d->buf_write_idx = 0;
   d->buf_count = 0;
+  d->event_overflows = 0;
+
+  // Clear the event buffer (which keeps its grown size) and the syllable
+  // being built
+  memset(d->event_buffer, 0,
+         (size_t)d->event_buffer_size * sizeof(SyllableEvent));
+  memset(&d->wip_event, 0, sizeof(d->wip_event));
+  memset(&d->blk, 0, sizeof(d->blk));
+  d->trace_since_hop = 0;
+  d->event_batch_count = 0;
+  d->state_timer = 0;
+  d->max_peak_rate_in_syllable = 0.0f;
+  d->max_fusion_score_in_syllable = 0.0f;
+  d->energy_accum = 0.0f;
+  d->onset_timestamp = 0;
+  d->last_event_samples = 0;
+  d->peak_sample_offset = 0;
+  d->current_onset_type = ONSET_TYPE_VOICED;
+
+  // PeakRate and ZFF state
+  d->current_peak_rate = 0.0f;
+  d->peak_rate_accum = 0.0f;
+  d->last_zff_val = 0.0f;
+  d->last_zff_slope = 0.0f;
+  d->last_epoch_samples_ago = 0;
+  d->last_epoch_frac = 0.0f;
+  d->current_f0 = 0.0f;
+
+  // F0 smoothing and energy tracking
+  d->smoothed_f0 = 0.0f;
+  d->prev_smoothed_f0 = 0.0f;
+  d->f0_derivative = 0.0f;
+  d->min_f0_since_peak = 0.0f;
+  d->f0_has_risen = 1; // Start as true to allow first detection
+  d->f0_jump_counter = 0;
+  d->current_energy = 0.0f;
+  d->energy_floor = 0.0f;
+
+  // TEO
+  d->prev_sample = 0.0f;
+  d->prev_prev_sample = 0.0f;
+  d->current_teo = 0.0f;
+  d->teo_mean = 0.0f;
+  d->teo_var = 0.0f;
+
+  // LER
+  d->short_energy = 0.0f;
+  d->long_energy = 0.0001f; // Small value to avoid division by zero
+  d->current_ler = 1.0f;
+
+  // F0 baseline (for secondary accent detection)
+  d->f0_baseline = 0.0f;
+  d->f0_semitone_diff = 0.0f;
 
-  // Clear buffer flags
-  for (int i = 0; i < PROMINENCE_BUFFER_SIZE; i++)
-    d->event_buffer[i].is_ready = 0;
+  // Online threshold (fusion score history)
+  running_median_reset(d->fusion_window);
 
   // Reset Legacy DSP
   biquad_reset(&d->bp_filter);
-  configure_bandpass(&d->bp_filter, &d->config);
+  configure_bandpass(&d->bp_filter, &d->config, d->front_end_rate);
   d->env_follower.output = 0.0f;
   if (d->zff.trend_buffer && d->zff.trend_buf_size > 0) {
     memset(d->zff.trend_buffer, 0,
@@ -794,22 +1193,38 @@ void syllable_reset(SyllableDetector *d) {
   d->zff.int2 = 0.0;
   d->zff.trend_write_pos = 0;
   d->zff.trend_accum = 0.0f;
+  if (d->resampler)
+    resampler_reset(d->resampler);
+  if (d->decimator)
+    decimator_reset(d->decimator);
+  memset(&d->low, 0, sizeof(d->low));
 
   d->adaptive_mean = 0.0f;
   d->adaptive_var = 0.0f;
 
   // Reset Multi-Feature DSP
+  if (d->stft)
+    stft_reset(d->stft);
   if (d->spectral_flux)
     spectral_flux_reset(d->spectral_flux);
   if (d->high_freq_energy)
     hfe_reset(d->high_freq_energy);
   if (d->mfcc)
     mfcc_reset(d->mfcc);
+  if (d->wavelet)
+    wavelet_reset(d->wavelet);
+  if (d->agc)
+    agc_reset(d->agc);
+  if (d->audio_ring) {
+    spsc_ring_reset(d->audio_ring);
+    spsc_ring_reset(d->event_ring);
+  }
 
   // Reset feature values
   d->current_spectral_flux = 0.0f;
   d->current_high_freq_energy = 0.0f;
   d->current_mfcc_delta = 0.0f;
+  d->current_wavelet_score = 0.0f;
   d->current_fusion_score = 0.0f;
 
   // Reset feature stats
@@ -830,20 +1245,11 @@ void syllable_destroy(SyllableDetector *d) {
   if (!d)
     return;
 
-  // Destroy Multi-Feature DSP
-  if (d->spectral_flux)
-    spectral_flux_destroy(d->spectral_flux, d->free_fn);
-  if (d->high_freq_energy)
-    hfe_destroy(d->high_freq_energy, d->free_fn);
-  if (d->mfcc)
-    mfcc_destroy(d->mfcc, d->free_fn);
-  if (d->wavelet)
-    wavelet_destroy(d->wavelet, d->free_fn);
-  if (d->agc)
-    agc_destroy(d->agc, d->free_fn);
-
-  zff_destroy(&d->zff, d->free_fn);
-  d->free_fn(d);
+  // The detector and all of its modules share one block; only a grown event
+  // buffer lives outside it
+  if (d->event_buffer_heap)
+    d->free_fn(d->event_buffer_heap);
+  d->free_fn(d->block);
 }
 
 // Compute fusion score from all features (IMPROVED: Energy-Gated + Max/Avg
@@ -974,34 +1380,382 @@ static SyllableOnsetType determine_onset_type(SyllableDetector *d) {
   }
 }
 
-int syllable_process(SyllableDetector *d, const float *input, int num_samples,
-                     SyllableEvent *events_out, int max_events) {
-  int events_written = 0;
+// TEO (Teager Energy Operator): Ψ[x(n)] = x(n)² - x(n-1) * x(n+1)
+// We compute with delay: x[n-1]² - x[n-2] * x[n]
+// LER (Local Energy Ratio): short-term / long-term energy
+static void run_teo_ler(SyllableDetector *d, const float *x, float *teo_z,
+                        float *ler_out, int n) {
+  float prev = d->prev_sample, prev_prev = d->prev_prev_sample;
+  float teo_mean = d->teo_mean, teo_var = d->teo_var;
+  const float teo_alpha = d->teo_alpha;
+  float short_energy = d->short_energy, long_energy = d->long_energy;
+  const float alpha_short = d->ler_alpha_short;
+  const float alpha_long = d->ler_alpha_long;
+  float teo_raw = d->current_teo, ler = d->current_ler;
+
+  for (int i = 0; i < n; i++) {
+    float in_sample = x[i];
+
+    teo_raw = prev * prev - prev_prev * in_sample;
+    if (teo_raw < 0.0f)
+      teo_raw = 0.0f; // Half-wave rectify
+
+    // Update TEO stats for normalization (EMA, ~1000 input samples)
+    float teo_delta = teo_raw - teo_mean;
+    teo_mean += teo_alpha * teo_delta;
+    teo_var =
+        (1.0f - teo_alpha) * (teo_var + teo_alpha * teo_delta * teo_delta);
+
+    float teo_std = (teo_var > 0) ? sqrtf(teo_var) : 1e-6f;
+    teo_z[i] = (teo_raw - teo_mean) / (teo_std + 1e-6f);
+
+    prev_prev = prev;
+    prev = in_sample;
+
+    float sample_energy = in_sample * in_sample;
+    short_energy =
+        alpha_short * sample_energy + (1.0f - alpha_short) * short_energy;
+    long_energy =
+        alpha_long * sample_energy + (1.0f - alpha_long) * long_energy;
+
+    // Compute LER (clamped to reasonable range)
+    if (long_energy > 1e-10f) {
+      ler = short_energy / long_energy;
+      if (ler > 10.0f)
+        ler = 10.0f; // Clamp
+    } else {
+      ler = 1.0f;
+    }
+    ler_out[i] = ler;
+  }
+
+  d->prev_sample = prev;
+  d->prev_prev_sample = prev_prev;
+  d->current_teo = teo_raw;
+  d->teo_mean = teo_mean;
+  d->teo_var = teo_var;
+  d->short_energy = short_energy;
+  d->long_energy = long_energy;
+  d->current_ler = ler;
+}
 
-  // Temporary buffers for frame-based features
-  float flux_buf[8];
-  float mfcc_delta_buf[8]; // Process sample by sample
-  for (int i = 0; i < num_samples; i++) {
-    float in_sample = input[i];
+// run_teo_ler for lanes <= DSP_MAX_LANES detectors in lockstep, samples
+// interleaved by lane (see dsp/lanes.h). Same arithmetic per lane.
+static void run_teo_ler_lanes(SyllableDetector *const *d, int lanes,
+                              const float *x, float *teo_z, float *ler_out,
+                              int n) {
+  float prev[DSP_MAX_LANES], prev_prev[DSP_MAX_LANES];
+  float teo_mean[DSP_MAX_LANES], teo_var[DSP_MAX_LANES];
+  float short_energy[DSP_MAX_LANES], long_energy[DSP_MAX_LANES];
+  float alpha_short[DSP_MAX_LANES], alpha_long[DSP_MAX_LANES];
+  float teo_alpha[DSP_MAX_LANES];
+  float teo_raw[DSP_MAX_LANES], ler[DSP_MAX_LANES];
+  for (int l = 0; l < lanes; l++) {
+    prev[l] = d[l]->prev_sample;
+    prev_prev[l] = d[l]->prev_prev_sample;
+    teo_mean[l] = d[l]->teo_mean;
+    teo_var[l] = d[l]->teo_var;
+    teo_alpha[l] = d[l]->teo_alpha;
+    short_energy[l] = d[l]->short_energy;
+    long_energy[l] = d[l]->long_energy;
+    alpha_short[l] = d[l]->ler_alpha_short;
+    alpha_long[l] = d[l]->ler_alpha_long;
+    teo_raw[l] = d[l]->current_teo;
+    ler[l] = d[l]->current_ler;
+  }
 
-    // 0. AGC (Robustness)
-    if (d->agc) {
-      in_sample = agc_process(d->agc, in_sample);
+  for (int i = 0; i < n; i++) {
+    const float *xi = x + i * lanes;
+    for (int l = 0; l < lanes; l++) {
+      float in_sample = xi[l];
+
+      float raw = prev[l] * prev[l] - prev_prev[l] * in_sample;
+      raw = raw < 0.0f ? 0.0f : raw;
+
+      float teo_delta = raw - teo_mean[l];
+      float mean = teo_mean[l] + teo_alpha[l] * teo_delta;
+      float var = (1.0f - teo_alpha[l]) *
+                  (teo_var[l] + teo_alpha[l] * teo_delta * teo_delta);
+      float root = sqrtf(var > 0 ? var : 0.0f); // Computed for every lane
+      float teo_std = (var > 0) ? root : 1e-6f;
+      teo_z[i * lanes + l] = (raw - mean) / (teo_std + 1e-6f);
+      teo_raw[l] = raw;
+      teo_mean[l] = mean;
+      teo_var[l] = var;
+
+      prev_prev[l] = prev[l];
+      prev[l] = in_sample;
+
+      float sample_energy = in_sample * in_sample;
+      float se = alpha_short[l] * sample_energy +
+                 (1.0f - alpha_short[l]) * short_energy[l];
+      float le = alpha_long[l] * sample_energy +
+                 (1.0f - alpha_long[l]) * long_energy[l];
+      float r = se / le;
+      r = r > 10.0f ? 10.0f : r;
+      r = le > 1e-10f ? r : 1.0f;
+      short_energy[l] = se;
+      long_energy[l] = le;
+      ler[l] = r;
+      ler_out[i * lanes + l] = r;
     }
+  }
+
+  for (int l = 0; l < lanes; l++) {
+    d[l]->prev_sample = prev[l];
+    d[l]->prev_prev_sample = prev_prev[l];
+    d[l]->current_teo = teo_raw[l];
+    d[l]->teo_mean = teo_mean[l];
+    d[l]->teo_var = teo_var[l];
+    d[l]->short_energy = short_energy[l];
+    d[l]->long_energy = long_energy[l];
+    d[l]->current_ler = ler[l];
+  }
+}
+
+// Frame-based and multi-rate stages over one block of (AGC'd) signal: each
+// completed STFT hop feeds one frame to Spectral Flux and MFCC, and the
+// wavelet filter bank runs over the whole block.
+static void run_frame_stages(SyllableDetector *d, const float *x, int n) {
+  BlockScratch *blk = &d->blk;
+
+  PERF_START(t);
+
+  blk->n_hops = 0;
+  blk->flatness_weber_start =
+      d->spectral_flux ? spectral_flux_get_flatness_weber(d->spectral_flux)
+                       : 0.0f;
+  if (d->stft) {
+    int pos = 0;
+    while (pos < n) {
+      pos += stft_push(d->stft, x + pos, n - pos);
+      if (!stft_frame_ready(d->stft))
+        continue;
+
+      int h = blk->n_hops++;
+      blk->hop[h] = pos - 1;
+      if (d->spectral_flux) {
+        blk->flux[h] = spectral_flux_process_frame(
+            d->spectral_flux, stft_get_spectrum(d->stft));
+        blk->flux_weber[h] =
+            spectral_flux_get_flatness_weber(d->spectral_flux);
+      }
+      if (d->mfcc) {
+        blk->mfcc_delta[h] =
+            mfcc_process_frame(d->mfcc, stft_get_spectrum(d->stft));
+      }
+
+      // Frame values the decision stage does not use, kept for the trace
+      if (d->trace_fn) {
+        if (d->spectral_flux)
+          blk->flatness[h] = spectral_flux_get_flatness(d->spectral_flux);
+        if (d->mfcc)
+          mfcc_get_coeffs(d->mfcc, d->hop_mfcc + h * MFCC_NUM_COEFFS);
+      }
+    }
+  } else if (d->trace_fn) {
+    // No STFT: trace hops are counted here
+    int pos = d->trace_hop_size - d->trace_since_hop - 1;
+    for (; pos < n; pos += d->trace_hop_size)
+      blk->hop[blk->n_hops++] = pos;
+    d->trace_since_hop = (d->trace_since_hop + n) % d->trace_hop_size;
+  }
+  if (d->stft)
+    PERF_LAP(d, SYLLABLE_STAGE_SPECTRAL, t, 1);
+
+  if (d->wavelet) {
+    wavelet_process_block(d->wavelet, x, blk->wavelet, n);
+    PERF_LAP(d, SYLLABLE_STAGE_WAVELET, t, 1);
+  }
+}
+
+// Interpolate the low-rate outputs of the block into the block scratch
+static void interpolate_low_rate(SyllableDetector *d, int n) {
+  BlockScratch *blk = &d->blk;
+  LowRateBlock *low = &d->low;
+  const float *in[LOW_RATE_OUTPUTS];
+  float *out[LOW_RATE_OUTPUTS] = {blk->zff, blk->env, blk->teo_z, blk->ler};
+  for (int k = 0; k < LOW_RATE_OUTPUTS; k++)
+    in[k] = low->out[k];
+  decimator_interpolate(d->decimator, LOW_RATE_OUTPUTS, in, low->tail, out,
+                        n);
+}
+
+// ZFF, PeakRate envelope and TEO/LER on the decimated front-end: the block
+// is decimated, the stages run over the low-rate samples, and each output is
+// interpolated back to one value per input sample of the block scratch
+static void run_low_rate_stages(SyllableDetector *d, const float *x, int n) {
+  LowRateBlock *low = &d->low;
+
+  PERF_START(t);
+
+  int m = decimator_process_block(d->decimator, x, n, low->signal);
+  PERF_LAP(d, SYLLABLE_STAGE_DECIMATION, t, 1);
+
+  zff_process_block(&d->zff, low->signal, low->out[LOW_ZFF], m);
+  PERF_LAP(d, SYLLABLE_STAGE_ZFF, t, 1);
+
+  biquad_process_block(&d->bp_filter, low->signal, low->out[LOW_ENV], m);
+  envelope_process_block(&d->env_follower, low->out[LOW_ENV],
+                         low->out[LOW_ENV], m);
+  PERF_LAP(d, SYLLABLE_STAGE_PEAK_RATE, t, 1);
+
+  run_teo_ler(d, low->signal, low->out[LOW_TEO_Z], low->out[LOW_LER], m);
+  PERF_LAP(d, SYLLABLE_STAGE_TEO_LER, t, 1);
+
+  interpolate_low_rate(d, n);
+  PERF_LAP(d, SYLLABLE_STAGE_DECIMATION, t, 0);
+}
+
+// Run every DSP stage over one block (n <= PROCESS_BLOCK_SIZE), writing each
+// stage's per-sample output into the block scratch. Hop-based features record
+// the sample offset at which each hop completed.
+static void run_feature_stages(SyllableDetector *d, const float *input,
+                               int n) {
+  BlockScratch *blk = &d->blk;
+  const float *x = input;
+
+  PERF_START(t);
+
+  // 0. AGC
+  if (d->agc) {
+    agc_process_block(d->agc, input, blk->signal, n);
+    x = blk->signal;
+    PERF_LAP(d, SYLLABLE_STAGE_AGC, t, 1);
+  }
+
+  if (d->decimator) {
+    // 1-2. ZFF, PeakRate envelope and TEO / LER at the low rate
+    run_low_rate_stages(d, x, n);
+  } else {
+    // 1. ZFF
+    zff_process_block(&d->zff, x, blk->zff, n);
+    PERF_LAP(d, SYLLABLE_STAGE_ZFF, t, 1);
+
+    // 2. PeakRate band envelope (bandpass output is written in place)
+    biquad_process_block(&d->bp_filter, x, blk->env, n);
+    envelope_process_block(&d->env_follower, blk->env, blk->env, n);
+    PERF_LAP(d, SYLLABLE_STAGE_PEAK_RATE, t, 1);
+
+    // TEO / LER
+    run_teo_ler(d, x, blk->teo_z, blk->ler, n);
+    PERF_LAP(d, SYLLABLE_STAGE_TEO_LER, t, 1);
+  }
+
+  // 3. Multi-Feature stages
+  if (d->high_freq_energy) {
+    PERF_START(t_hfe);
+    hfe_process_block(d->high_freq_energy, x, blk->hfe, n);
+    PERF_LAP(d, SYLLABLE_STAGE_HIGH_FREQ, t_hfe, 1);
+  }
+
+  run_frame_stages(d, x, n);
+}
+
+// Input sample of analysis sample t (the same index without resampling).
+// The low-rate front-end lags by the decimator delay, which is taken back
+// out so that onsets land where they do at the input rate.
+static uint64_t input_timestamp(const SyllableDetector *d, uint64_t t) {
+  if (d->decimator) {
+    uint64_t delay = (uint64_t)decimator_delay(d->decimator);
+    t = t > delay ? t - delay : 0;
+  }
+  return d->resampler ? resampler_input_position(d->resampler, t) : t;
+}
+
+// Hand the features at sample i, the end of block hop h, to the trace
+static void emit_feature_frame(SyllableDetector *d, int i, int h,
+                               float flatness_weber) {
+  const BlockScratch *blk = &d->blk;
+  SyllableFeatureFrame f;
+  memset(&f, 0, sizeof(f));
+
+  f.timestamp_samples = input_timestamp(d, d->total_samples - 1);
+  f.peak_rate = d->current_peak_rate;
+  if (d->spectral_flux) {
+    f.spectral_flux = d->current_spectral_flux;
+    f.spectral_flatness = blk->flatness[h];
+    f.flatness_weber = flatness_weber;
+  }
+  f.high_freq_energy = d->current_high_freq_energy;
+  if (d->mfcc)
+    memcpy(f.mfcc, d->hop_mfcc + h * MFCC_NUM_COEFFS, sizeof(f.mfcc));
+  f.mfcc_delta = d->current_mfcc_delta;
+  f.wavelet_score = d->current_wavelet_score;
+  f.teo = blk->teo_z[i];
+  f.ler = blk->ler[i];
+  f.f0 = d->current_f0;
+  f.fusion_score = d->current_fusion_score;
+  f.is_voiced = d->is_voiced;
+
+  d->trace_fn(d->trace_user, &f);
+}
+
+// Events go to the callbacks instead of events_out once one is installed
+static int has_event_callback(const SyllableDetector *d) {
+  return d->event_fn || d->event_batch_fn;
+}
+
+// Hand the collected events to the batch callback
+static void flush_event_batch(SyllableDetector *d) {
+  if (d->event_batch_count > 0) {
+    d->event_batch_fn(d->event_batch_user, d->event_batch,
+                      d->event_batch_count);
+    d->event_batch_count = 0;
+  }
+}
 
+// Deliver one event whose prominence context is complete, straight from the
+// prominence buffer: to the callbacks if installed, else into events_out.
+// Returns the new events_written.
+static int deliver_event(SyllableDetector *d, const SyllableEvent *evt,
+                         SyllableEvent *events_out, int events_written) {
+  if (!has_event_callback(d)) {
+    events_out[events_written] = *evt;
+    return events_written + 1;
+  }
+  if (d->event_fn)
+    d->event_fn(d->event_user, evt);
+  if (d->event_batch_fn) {
+    d->event_batch[d->event_batch_count++] = *evt;
+    if (d->event_batch_count == EVENT_BATCH_SIZE)
+      flush_event_batch(d);
+  }
+  return events_written + 1;
+}
+
+// Walk the stage outputs of one block sample by sample: voicing/F0 tracking,
+// feature statistics, fusion, the state machine and delayed event emission.
+// With an event callback installed, events_out is not used.
+static int run_decision_stage(SyllableDetector *d, int n,
+                              SyllableEvent *events_out, int max_events) {
+  const BlockScratch *blk = &d->blk;
+  int events_written = 0;
+  int hop = 0;
+  float flatness_weber = blk->flatness_weber_start; // Advanced per hop
+  PERF_START(t);
+
+  for (int i = 0; i < n; i++) {
     d->total_samples++;
 
     // 1. ZFF Detection (Voicing / F0) with IMPROVED F0 smoothing
-    float zff_out, zff_slope;
-    zff_process(&d->zff, in_sample, &zff_out, &zff_slope);
+    float zff_out = blk->zff[i];
 
     int is_epoch = 0;
     if (d->last_zff_val < 0.0f && zff_out >= 0.0f) {
       is_epoch = 1;
 
+      // The low-rate ZFF arrives linearly interpolated, so its zero crossing
+      // lies exactly epoch_frac samples before this one; at the input rate
+      // epochs stay on whole samples
+      float epoch_frac = 0.0f;
+      if (d->decimator)
+        epoch_frac = zff_out / (zff_out - d->last_zff_val);
+
       if (d->last_epoch_samples_ago > 0) {
-        float period_s =
-            (float)d->last_epoch_samples_ago / d->config.sample_rate;
+        float period = (float)d->last_epoch_samples_ago +
+                       d->last_epoch_frac - epoch_frac;
+        float period_s = period / d->config.sample_rate;
         float raw_f0 = 1.0f / period_s;
 
         // Validate F0 range (50-600 Hz for human voice)
@@ -1036,6 +1790,7 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
         }
       }
       d->last_epoch_samples_ago = 0;
+      d->last_epoch_frac = epoch_frac;
     } else {
       d->last_epoch_samples_ago++;
     }
@@ -1099,8 +1854,7 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
     }
 
     // 2. PeakRate Pipeline (Legacy) + Energy Tracking
-    float bp_out = biquad_process(&d->bp_filter, in_sample);
-    float env_out = envelope_process(&d->env_follower, bp_out);
+    float env_out = blk->env[i];
 
     float diff = env_out - d->prev_env;
     float peak_rate = (diff > 0.0f) ? diff : 0.0f;
@@ -1119,45 +1873,6 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
           0.9999f * d->energy_floor + 0.0001f * env_out; // Slow rise
     }
 
-    // TEO (Teager Energy Operator): Ψ[x(n)] = x(n)² - x(n-1) * x(n+1)
-    // We compute with delay: x[n-1]² - x[n-2] * x[n]
-    float teo_raw =
-        d->prev_sample * d->prev_sample - d->prev_prev_sample * in_sample;
-    if (teo_raw < 0.0f)
-      teo_raw = 0.0f; // Half-wave rectify
-    d->current_teo = teo_raw;
-
-    // Update TEO stats for normalization (EMA)
-    float teo_alpha = 0.001f; // ~1000 samples
-    float teo_delta = teo_raw - d->teo_mean;
-    d->teo_mean += teo_alpha * teo_delta;
-    d->teo_var =
-        (1.0f - teo_alpha) * (d->teo_var + teo_alpha * teo_delta * teo_delta);
-
-    // Shift samples for next TEO
-    d->prev_prev_sample = d->prev_sample;
-    d->prev_sample = in_sample;
-
-    // LER (Local Energy Ratio): short-term / long-term energy
-    // EMA coefficients: short ~20ms, long ~500ms
-    float sample_energy = in_sample * in_sample;
-    float alpha_short = 1.0f - expf(-1.0f / (0.020f * d->config.sample_rate));
-    float alpha_long = 1.0f - expf(-1.0f / (0.500f * d->config.sample_rate));
-
-    d->short_energy =
-        alpha_short * sample_energy + (1.0f - alpha_short) * d->short_energy;
-    d->long_energy =
-        alpha_long * sample_energy + (1.0f - alpha_long) * d->long_energy;
-
-    // Compute LER (clamped to reasonable range)
-    if (d->long_energy > 1e-10f) {
-      d->current_ler = d->short_energy / d->long_energy;
-      if (d->current_ler > 10.0f)
-        d->current_ler = 10.0f; // Clamp
-    } else {
-      d->current_ler = 1.0f;
-    }
-
     // Update PeakRate stats
     if (d->is_voiced || d->config.allow_unvoiced_onsets) {
       update_feature_stats(&d->stats_peak_rate, peak_rate);
@@ -1165,34 +1880,33 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
 
     // 3. Multi-Feature Processing
 
+    // Frame-based features update at the sample completing each STFT hop
+    int hop_here = (hop < blk->n_hops && blk->hop[hop] == i);
+
     // Spectral Flux (frame-based, updates less frequently)
-    if (d->spectral_flux) {
-      int n_flux =
-          spectral_flux_process(d->spectral_flux, &in_sample, 1, flux_buf, 8);
-      if (n_flux > 0) {
-        d->current_spectral_flux = flux_buf[n_flux - 1];
-        update_feature_stats(&d->stats_spectral_flux, d->current_spectral_flux);
-      }
+    if (hop_here && d->spectral_flux) {
+      d->current_spectral_flux = blk->flux[hop];
+      flatness_weber = blk->flux_weber[hop];
+      update_feature_stats(&d->stats_spectral_flux, d->current_spectral_flux);
     }
 
     // High-Frequency Energy (sample-based)
     if (d->high_freq_energy) {
-      d->current_high_freq_energy = hfe_process(d->high_freq_energy, in_sample);
+      d->current_high_freq_energy = blk->hfe[i];
       update_feature_stats(&d->stats_high_freq, d->current_high_freq_energy);
     }
 
     // MFCC Delta (frame-based)
-    if (d->mfcc) {
-      int n_mfcc = mfcc_process(d->mfcc, &in_sample, 1, mfcc_delta_buf, 8);
-      if (n_mfcc > 0) {
-        d->current_mfcc_delta = mfcc_delta_buf[n_mfcc - 1];
-        update_feature_stats(&d->stats_mfcc_delta, d->current_mfcc_delta);
-      }
+    if (hop_here && d->mfcc) {
+      d->current_mfcc_delta = blk->mfcc_delta[hop];
+      update_feature_stats(&d->stats_mfcc_delta, d->current_mfcc_delta);
     }
+    if (hop_here)
+      hop++; // hop - 1 is this hop from here on
 
     // Wavelet Transform (sample-based)
     if (d->wavelet) {
-      d->current_wavelet_score = wavelet_process(d->wavelet, in_sample);
+      d->current_wavelet_score = blk->wavelet[i];
       update_feature_stats(&d->stats_wavelet, d->current_wavelet_score);
     }
 
@@ -1201,31 +1915,17 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
       update_rt_calibration(d);
     }
 
+    PERF_LAP(d, SYLLABLE_STAGE_TRACKING, t, 1);
+
     // 4. Compute Fusion Score
     d->current_fusion_score = compute_fusion_score(d);
 
-    // Update fusion score history for online threshold (median + MAD)
-    d->fusion_history[d->fusion_history_idx] = d->current_fusion_score;
-    d->fusion_history_idx = (d->fusion_history_idx + 1) % FUSION_HISTORY_SIZE;
-    if (d->fusion_history_count < FUSION_HISTORY_SIZE)
-      d->fusion_history_count++;
-
-    // Recompute median and MAD periodically (every 16 samples for efficiency)
-    if ((d->total_samples % 16) == 0 && d->fusion_history_count >= 8) {
-      // Simple approximation: use running statistics instead of exact median
-      // For online processing, EMA-based approximation is sufficient
-      float sum = 0.0f, sum_abs_dev = 0.0f;
-      for (int j = 0; j < d->fusion_history_count; j++) {
-        sum += d->fusion_history[j];
-      }
-      float mean = sum / d->fusion_history_count;
-      for (int j = 0; j < d->fusion_history_count; j++) {
-        float dev = d->fusion_history[j] - mean;
-        sum_abs_dev += (dev > 0) ? dev : -dev;
-      }
-      d->fusion_median = mean; // Approximate median with mean
-      d->fusion_mad = sum_abs_dev / d->fusion_history_count;
-    }
+    if (hop_here && d->trace_fn)
+      emit_feature_frame(d, i, hop - 1, flatness_weber);
+
+    // Fusion score statistics, read out on demand
+    if (d->fusion_window && d->total_samples % FUSION_WINDOW_HOP == 0)
+      running_median_push(d->fusion_window, d->current_fusion_score);
 
     // Adaptive threshold for legacy path
     if (d->adaptive_enabled && d->is_voiced) {
@@ -1252,6 +1952,8 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
     float fusion_threshold_on = 0.6f * d->config.hysteresis_on_factor;
     float fusion_threshold_off = 0.4f * d->config.hysteresis_off_factor;
 
+    PERF_LAP(d, SYLLABLE_STAGE_FUSION, t, 1);
+
     // 5. State Machine
     // SKIP state machine during realtime calibration to collect only noise
     // floor
@@ -1294,18 +1996,13 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
 
       // Strong evidence bypass: if any Weber-Fechner saliency is high, trust it
       // TEO: normalized value > 3σ (nonlinear energy burst)
-      float teo_std = (d->teo_var > 0) ? sqrtf(d->teo_var) : 1e-6f;
-      float teo_normalized = (d->current_teo - d->teo_mean) / (teo_std + 1e-6f);
-      int teo_strong = (teo_normalized > 3.0f); // 3σ above mean
+      int teo_strong = (blk->teo_z[i] > 3.0f); // 3σ above mean
 
       // LER: local energy is 2x higher than long-term (Weber ratio > 1)
-      int ler_strong = (d->current_ler > 2.0f);
+      int ler_strong = (blk->ler[i] > 2.0f);
 
       // Spectral Flatness Weber: rapid harmonicity increase (vowel onset)
       // Negative Weber ratio means flatness decreased = becoming more harmonic
-      float flatness_weber =
-          d->spectral_flux ? spectral_flux_get_flatness_weber(d->spectral_flux)
-                           : 0.0f;
       int harmonicity_strong =
           (flatness_weber < -0.3f); // 30% decrease in flatness
 
@@ -1354,9 +2051,9 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
 
         // Init Event
         memset(&d->wip_event, 0, sizeof(d->wip_event));
-        d->wip_event.timestamp_samples = d->total_samples;
+        d->wip_event.timestamp_samples = input_timestamp(d, d->total_samples);
         d->wip_event.time_seconds =
-            (double)d->total_samples / d->config.sample_rate;
+            (double)d->wip_event.timestamp_samples / d->input_rate;
         d->wip_event.peak_rate = peak_rate;
         d->wip_event.pr_slope = 0.0f;
         d->wip_event.energy = env_out;
@@ -1470,17 +2167,7 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
         d->wip_event.f0 = d->current_f0;
 
         // Push to Ring Buffer
-        if (d->buf_count < PROMINENCE_BUFFER_SIZE) {
-          d->event_buffer[d->buf_write_idx].event = d->wip_event;
-          d->event_buffer[d->buf_write_idx].is_ready = 1;
-          d->buf_write_idx = (d->buf_write_idx + 1) % PROMINENCE_BUFFER_SIZE;
-          d->buf_count++;
-        } else {
-          d->event_buffer[d->buf_write_idx].event = d->wip_event;
-          d->event_buffer[d->buf_write_idx].is_ready = 1;
-          d->buf_write_idx = (d->buf_write_idx + 1) % PROMINENCE_BUFFER_SIZE;
-          d->buf_read_idx = (d->buf_read_idx + 1) % PROMINENCE_BUFFER_SIZE;
-        }
+        buffer_event(d, &d->wip_event);
 
         // Update last event time for F0 bypass calculation
         d->last_event_samples = d->total_samples;
@@ -1499,12 +2186,13 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
     // delay)
     int context_needed = d->config.realtime_mode ? 0 : d->config.context_size;
 
-    while (d->buf_count > context_needed && events_written < max_events) {
-      SyllableEvent *evt = &d->event_buffer[d->buf_read_idx].event;
+    while (d->buf_count > context_needed &&
+           (events_written < max_events || has_event_callback(d))) {
+      SyllableEvent *evt = &d->event_buffer[d->buf_read_idx];
 
-      calculate_delta_f0(d, d->buf_read_idx);
+      calculate_delta_f0(d);
 
-      float score = calculate_prominence(d, d->buf_read_idx);
+      float score = calculate_prominence(d);
       evt->prominence_score = score;
 
       // 2-tier threshold: primary (1.0+) and secondary (0.7+) accents
@@ -1512,40 +2200,742 @@ int syllable_process(SyllableDetector *d, const float *input, int num_samples,
       // "definitely"
       evt->is_accented = (score > 0.9f); // Lower threshold for better recall
 
-      events_out[events_written++] = *evt;
+      events_written = deliver_event(d, evt, events_out, events_written);
+
+      release_oldest_event(d);
+    }
+    PERF_LAP(d, SYLLABLE_STAGE_STATE_MACHINE, t, 1);
+  }
+
+#ifdef SYLLABLE_PERF_COUNTERS
+  d->perf.samples += n;
+#endif
+  return events_written;
+}
+
+// Resample one block of input (n <= input_block) to the analysis rate, into
+// the block scratch. Returns the number of analysis samples.
+static int resample_block(SyllableDetector *d, const float *x, int n) {
+  PERF_START(t);
+  int m = resampler_process_block(d->resampler, x, n, d->blk.signal);
+  PERF_LAP(d, SYLLABLE_STAGE_RESAMPLE, t, 1);
+  return m;
+}
+
+// Run one block of input (n <= input_block) through every stage. Returns
+// events_written plus the events the block completed.
+static int process_block(SyllableDetector *d, const float *x, int n,
+                         SyllableEvent *events_out, int events_written,
+                         int max_events) {
+  if (d->resampler) {
+    n = resample_block(d, x, n);
+    x = d->blk.signal;
+    if (n == 0)
+      return events_written;
+  }
+  run_feature_stages(d, x, n);
+  if (has_event_callback(d))
+    return events_written + run_decision_stage(d, n, NULL, 0);
+  return events_written + run_decision_stage(d, n,
+                                             events_out + events_written,
+                                             max_events - events_written);
+}
+
+int syllable_process(SyllableDetector *d, const float *input, int num_samples,
+                     SyllableEvent *events_out, int max_events) {
+  int events_written = 0;
+
+  // Run the pipeline stage by stage over fixed-size blocks
+  for (int start = 0; start < num_samples; start += d->input_block) {
+    int n = num_samples - start;
+    if (n > d->input_block)
+      n = d->input_block;
+
+    events_written = process_block(d, input + start, n, events_out,
+                                   events_written, max_events);
+  }
+
+  if (d->event_batch_fn)
+    flush_event_batch(d);
+  return events_written;
+}
+
+// --- PCM Input ---
+
+// Full-scale reciprocals of the integer sample formats
+#define PCM_I16_SCALE (1.0f / 32768.0f)
+#define PCM_I24_SCALE (1.0f / 8388608.0f)
+#define PCM_I32_SCALE (1.0f / 2147483648.0f)
+
+typedef enum { PCM_I16, PCM_I24, PCM_I32 } PcmFormat;
+
+static inline int32_t pcm_sample(const void *input, PcmFormat format,
+                                 size_t index) {
+  switch (format) {
+  case PCM_I16:
+    return ((const int16_t *)input)[index];
+  case PCM_I24:
+    return simd_load_i24((const uint8_t *)input + 3 * index);
+  default:
+    return ((const int32_t *)input)[index];
+  }
+}
 
-      d->event_buffer[d->buf_read_idx].is_ready = 0;
-      d->buf_read_idx = (d->buf_read_idx + 1) % PROMINENCE_BUFFER_SIZE;
-      d->buf_count--;
+// Convert n frames, from frame first on, of interleaved PCM to float in
+// [-1, 1): one channel, or the mean of all channels for channel -1. Mono and
+// 16-bit stereo are vectorized.
+static void convert_pcm(const SimdKernels *simd, const void *input,
+                        PcmFormat format, int num_channels, int channel,
+                        size_t first, float *out, int n) {
+  float scale = format == PCM_I16   ? PCM_I16_SCALE
+                : format == PCM_I24 ? PCM_I24_SCALE
+                                    : PCM_I32_SCALE;
+  size_t stride = (size_t)num_channels;
+
+  if (num_channels == 1) {
+    if (format == PCM_I16)
+      simd->i16_to_f32((const int16_t *)input + first, out, n, scale);
+    else if (format == PCM_I24)
+      simd->i24_to_f32((const uint8_t *)input + 3 * first, out, n, scale);
+    else
+      simd->i32_to_f32((const int32_t *)input + first, out, n, scale);
+    return;
+  }
+  if (num_channels == 2 && format == PCM_I16) {
+    simd->i16_stereo_to_f32((const int16_t *)input + 2 * first, out, n,
+                            channel, channel < 0 ? 0.5f * scale : scale);
+    return;
+  }
+
+  for (int i = 0; i < n; i++) {
+    size_t frame = (first + i) * stride;
+    if (channel >= 0) {
+      out[i] = (float)pcm_sample(input, format, frame + channel) * scale;
+    } else {
+      int64_t sum = 0;
+      for (int c = 0; c < num_channels; c++)
+        sum += pcm_sample(input, format, frame + c);
+      out[i] = (float)sum * (scale / num_channels);
     }
   }
+}
 
+// syllable_process over integer PCM. Each block is converted straight into
+// the block scratch, where the first stage (AGC, in place) picks it up, or
+// ahead of the resampler, which writes the block scratch.
+static int process_pcm(SyllableDetector *d, const void *input,
+                       PcmFormat format, int num_frames, int num_channels,
+                       int channel, SyllableEvent *events_out,
+                       int max_events) {
+  if (num_channels < 1 || channel < -1 || channel >= num_channels)
+    return 0;
+
+  float *x = d->resampler ? d->resample_in : d->blk.signal;
+  int events_written = 0;
+  for (int start = 0; start < num_frames; start += d->input_block) {
+    int n = num_frames - start;
+    if (n > d->input_block)
+      n = d->input_block;
+
+    convert_pcm(d->simd, input, format, num_channels, channel, (size_t)start,
+                x, n);
+    events_written =
+        process_block(d, x, n, events_out, events_written, max_events);
+  }
+
+  if (d->event_batch_fn)
+    flush_event_batch(d);
   return events_written;
 }
 
+int syllable_process_i16(SyllableDetector *d, const int16_t *input,
+                         int num_samples, SyllableEvent *events_out,
+                         int max_events) {
+  return process_pcm(d, input, PCM_I16, num_samples, 1, 0, events_out,
+                     max_events);
+}
+
+int syllable_process_i24(SyllableDetector *d, const uint8_t *input,
+                         int num_samples, SyllableEvent *events_out,
+                         int max_events) {
+  return process_pcm(d, input, PCM_I24, num_samples, 1, 0, events_out,
+                     max_events);
+}
+
+int syllable_process_i32(SyllableDetector *d, const int32_t *input,
+                         int num_samples, SyllableEvent *events_out,
+                         int max_events) {
+  return process_pcm(d, input, PCM_I32, num_samples, 1, 0, events_out,
+                     max_events);
+}
+
+int syllable_process_i16_interleaved(SyllableDetector *d,
+                                     const int16_t *input, int num_frames,
+                                     int num_channels, int channel,
+                                     SyllableEvent *events_out,
+                                     int max_events) {
+  return process_pcm(d, input, PCM_I16, num_frames, num_channels, channel,
+                     events_out, max_events);
+}
+
+int syllable_process_i24_interleaved(SyllableDetector *d,
+                                     const uint8_t *input, int num_frames,
+                                     int num_channels, int channel,
+                                     SyllableEvent *events_out,
+                                     int max_events) {
+  return process_pcm(d, input, PCM_I24, num_frames, num_channels, channel,
+                     events_out, max_events);
+}
+
+int syllable_process_i32_interleaved(SyllableDetector *d,
+                                     const int32_t *input, int num_frames,
+                                     int num_channels, int channel,
+                                     SyllableEvent *events_out,
+                                     int max_events) {
+  return process_pcm(d, input, PCM_I32, num_frames, num_channels, channel,
+                     events_out, max_events);
+}
+
 int syllable_flush(SyllableDetector *d, SyllableEvent *events_out,
                    int max_events) {
   int events_written = 0;
+  int context_needed = d->config.realtime_mode ? 0 : d->config.context_size;
 
-  while (d->buf_count > 0 && events_written < max_events) {
-    SyllableEvent *evt = &d->event_buffer[d->buf_read_idx].event;
+  while (d->buf_count > 0 &&
+         (events_written < max_events || has_event_callback(d))) {
+    SyllableEvent *evt = &d->event_buffer[d->buf_read_idx];
 
-    calculate_delta_f0(d, d->buf_read_idx);
+    calculate_delta_f0(d);
 
-    float score = calculate_prominence(d, d->buf_read_idx);
+    // Backlog events had their full context and are scored as
+    // syllable_process would have; only the last ones, short of context, get
+    // the stricter threshold
+    float score = calculate_prominence(d);
     evt->prominence_score = score;
-    evt->is_accented = (score > 1.2f);
+    evt->is_accented = d->buf_count > context_needed ? (score > 0.9f)
+                                                     : (score > 1.2f);
 
-    events_out[events_written++] = *evt;
+    events_written = deliver_event(d, evt, events_out, events_written);
 
-    d->event_buffer[d->buf_read_idx].is_ready = 0;
-    d->buf_read_idx = (d->buf_read_idx + 1) % PROMINENCE_BUFFER_SIZE;
-    d->buf_count--;
+    release_oldest_event(d);
   }
 
+  if (d->event_batch_fn)
+    flush_event_batch(d);
   return events_written;
 }
 
+uint64_t syllable_get_event_overflows(const SyllableDetector *d) {
+  return d ? d->event_overflows : 0;
+}
+
+// --- Realtime Streaming ---
+
+int syllable_push(SyllableDetector *d, const float *input, int num_samples) {
+  if (!d->audio_ring || num_samples <= 0)
+    return 0;
+  return (int)spsc_ring_write(d->audio_ring, input, (size_t)num_samples);
+}
+
+int syllable_pump(SyllableDetector *d, int max_samples) {
+  if (!d->audio_ring)
+    return 0;
+
+  // Analyze the queued audio in place, one block at a time, releasing each
+  // block to syllable_push as soon as it is done
+  SyllableEvent events[STREAM_EVENT_CHUNK];
+  int processed = 0;
+  while (max_samples <= 0 || processed < max_samples) {
+    void *data;
+    size_t n = spsc_ring_peek(d->audio_ring, &data);
+    if (n == 0)
+      break;
+    if (n > (size_t)d->input_block)
+      n = (size_t)d->input_block;
+    if (max_samples > 0 && n > (size_t)(max_samples - processed))
+      n = (size_t)(max_samples - processed);
+
+    int count = syllable_process(d, (const float *)data, (int)n, events,
+                                 STREAM_EVENT_CHUNK);
+    spsc_ring_consume(d->audio_ring, n);
+    if (!has_event_callback(d))
+      spsc_ring_write(d->event_ring, events, (size_t)count);
+    processed += (int)n;
+  }
+
+  if (processed == 0)
+    spsc_ring_note_underrun(d->audio_ring);
+  return processed;
+}
+
+int syllable_pop_events(SyllableDetector *d, SyllableEvent *events_out,
+                        int max_events) {
+  if (!d->event_ring || max_events <= 0)
+    return 0;
+  return (int)spsc_ring_read(d->event_ring, events_out, (size_t)max_events);
+}
+
+int syllable_get_stream_stats(const SyllableDetector *d,
+                              SyllableStreamStats *out) {
+  memset(out, 0, sizeof(*out));
+  if (!d->audio_ring)
+    return 0;
+  out->samples_pushed = spsc_ring_written(d->audio_ring);
+  out->samples_processed = spsc_ring_consumed(d->audio_ring);
+  out->overruns = spsc_ring_dropped(d->audio_ring);
+  out->underruns = spsc_ring_underruns(d->audio_ring);
+  out->peak_fill = spsc_ring_peak_fill(d->audio_ring);
+  out->events_published = spsc_ring_written(d->event_ring);
+  out->events_dropped = spsc_ring_dropped(d->event_ring);
+  return 1;
+}
+
+// --- Batch API ---
+
+struct SyllableDetectorBatch {
+  int num_streams;
+  SyllableDetector **streams;
+
+  // Lane-interleaved stage outputs for one group of up to DSP_MAX_LANES
+  // streams (see dsp/lanes.h), PROCESS_BLOCK_SIZE samples each
+  float *lane_in;
+  float *lane_signal;
+  float *lane_zff;
+  float *lane_env;
+  float *lane_teo_z;
+  float *lane_ler;
+  float *lane_hfe;
+  float *lane_low; // Decimated signal (low-rate front-end only)
+
+  void (*free_fn)(void *);
+};
+
+#define BATCH_LANE_BUFFERS 8
+
+SyllableDetectorBatch *syllable_batch_create(const SyllableConfig *config,
+                                             int num_streams) {
+  if (num_streams < 1)
+    return NULL;
+
+  void *(*alloc)(size_t) =
+      config && config->user_malloc ? config->user_malloc : default_malloc;
+  void (*free_fn)(void *) =
+      config && config->user_free ? config->user_free : default_free;
+
+  SyllableDetectorBatch *b =
+      (SyllableDetectorBatch *)alloc(sizeof(SyllableDetectorBatch));
+  if (!b)
+    return NULL;
+  memset(b, 0, sizeof(SyllableDetectorBatch));
+  b->free_fn = free_fn;
+
+  b->streams =
+      (SyllableDetector **)alloc(num_streams * sizeof(SyllableDetector *));
+  size_t lane_floats = (size_t)PROCESS_BLOCK_SIZE * DSP_MAX_LANES;
+  b->lane_in = (float *)alloc(BATCH_LANE_BUFFERS * lane_floats * sizeof(float));
+  if (!b->streams || !b->lane_in) {
+    syllable_batch_destroy(b);
+    return NULL;
+  }
+  b->lane_signal = b->lane_in + lane_floats;
+  b->lane_zff = b->lane_signal + lane_floats;
+  b->lane_env = b->lane_zff + lane_floats;
+  b->lane_teo_z = b->lane_env + lane_floats;
+  b->lane_ler = b->lane_teo_z + lane_floats;
+  b->lane_hfe = b->lane_ler + lane_floats;
+  b->lane_low = b->lane_hfe + lane_floats;
+
+  for (int s = 0; s < num_streams; s++) {
+    b->streams[s] = syllable_create(config);
+    if (!b->streams[s]) {
+      syllable_batch_destroy(b);
+      return NULL;
+    }
+    b->num_streams = s + 1;
+  }
+
+  return b;
+}
+
+void syllable_batch_reset(SyllableDetectorBatch *b) {
+  if (!b)
+    return;
+  for (int s = 0; s < b->num_streams; s++)
+    syllable_reset(b->streams[s]);
+}
+
+void syllable_batch_destroy(SyllableDetectorBatch *b) {
+  if (!b)
+    return;
+  for (int s = 0; s < b->num_streams; s++)
+    syllable_destroy(b->streams[s]);
+  if (b->streams)
+    b->free_fn(b->streams);
+  if (b->lane_in)
+    b->free_fn(b->lane_in);
+  b->free_fn(b);
+}
+
+// run_low_rate_stages for a group of streams: each stream decimates its own
+// signal (already in its block scratch), the low-rate stages run in lockstep,
+// and each stream interpolates its outputs back. The streams' decimators are
+// always in phase, so they all produce the same number of low-rate samples.
+static void run_low_rate_stages_lanes(SyllableDetectorBatch *b,
+                                      SyllableDetector *const *d, int lanes,
+                                      ZFF *const *zff, Biquad *const *bp,
+                                      EnvelopeFollower *const *env, int n) {
+  int m = 0;
+  for (int l = 0; l < lanes; l++) {
+    LowRateBlock *low = &d[l]->low;
+    m = decimator_process_block(d[l]->decimator, d[l]->blk.signal, n,
+                                low->signal);
+    for (int k = 0; k < m; k++)
+      b->lane_low[k * lanes + l] = low->signal[k];
+  }
+
+  zff_process_lanes(zff, lanes, b->lane_low, b->lane_zff, m);
+  biquad_process_lanes(bp, lanes, b->lane_low, b->lane_env, m);
+  envelope_process_lanes(env, lanes, b->lane_env, b->lane_env, m);
+  run_teo_ler_lanes(d, lanes, b->lane_low, b->lane_teo_z, b->lane_ler, m);
+
+  for (int l = 0; l < lanes; l++) {
+    LowRateBlock *low = &d[l]->low;
+    for (int k = 0; k < m; k++) {
+      low->out[LOW_ZFF][k] = b->lane_zff[k * lanes + l];
+      low->out[LOW_ENV][k] = b->lane_env[k * lanes + l];
+      low->out[LOW_TEO_Z][k] = b->lane_teo_z[k * lanes + l];
+      low->out[LOW_LER][k] = b->lane_ler[k * lanes + l];
+    }
+    interpolate_low_rate(d[l], n);
+  }
+}
+
+// Per-sample stages of one block for a group of streams in lockstep, then
+// frame stages per stream. Fills each stream's block scratch exactly as
+// run_feature_stages would.
+static void run_feature_stages_lanes(SyllableDetectorBatch *b,
+                                     SyllableDetector *const *d, int lanes,
+                                     const float *const *inputs, int n) {
+  AgcState *agc[DSP_MAX_LANES];
+  ZFF *zff[DSP_MAX_LANES];
+  Biquad *bp[DSP_MAX_LANES];
+  EnvelopeFollower *env[DSP_MAX_LANES];
+  HighFreqEnergy *hfe[DSP_MAX_LANES];
+  for (int l = 0; l < lanes; l++) {
+    agc[l] = d[l]->agc;
+    zff[l] = &d[l]->zff;
+    bp[l] = &d[l]->bp_filter;
+    env[l] = &d[l]->env_follower;
+    hfe[l] = d[l]->high_freq_energy;
+  }
+  // The config is shared, so all streams have a decimator or none do
+  int low_rate = d[0]->decimator != NULL;
+
+  for (int l = 0; l < lanes; l++)
+    for (int i = 0; i < n; i++)
+      b->lane_in[i * lanes + l] = inputs[l][i];
+
+  // 0. AGC (the config is shared, so all streams have it or none do)
+  const float *x = b->lane_in;
+  if (agc[0]) {
+    agc_process_lanes(agc, lanes, b->lane_in, b->lane_signal, n);
+    x = b->lane_signal;
+  }
+
+  // Per-stream signal, for the frame stages and the decimators
+  for (int l = 0; l < lanes; l++) {
+    BlockScratch *blk = &d[l]->blk;
+    for (int i = 0; i < n; i++)
+      blk->signal[i] = x[i * lanes + l];
+  }
+
+  if (low_rate) {
+    // 1-2. ZFF, PeakRate envelope and TEO / LER at the low rate
+    run_low_rate_stages_lanes(b, d, lanes, zff, bp, env, n);
+  } else {
+    // 1. ZFF
+    zff_process_lanes(zff, lanes, x, b->lane_zff, n);
+
+    // 2. PeakRate band envelope
+    biquad_process_lanes(bp, lanes, x, b->lane_env, n);
+    envelope_process_lanes(env, lanes, b->lane_env, b->lane_env, n);
+
+    // TEO / LER
+    run_teo_ler_lanes(d, lanes, x, b->lane_teo_z, b->lane_ler, n);
+  }
+
+  // 3. High-frequency energy
+  if (hfe[0])
+    hfe_process_lanes(hfe, lanes, x, b->lane_hfe, n);
+
+  // Back to per-stream layout, then the frame stages
+  for (int l = 0; l < lanes; l++) {
+    BlockScratch *blk = &d[l]->blk;
+    for (int i = 0; i < n; i++) {
+      int k = i * lanes + l;
+      if (!low_rate) {
+        blk->zff[i] = b->lane_zff[k];
+        blk->env[i] = b->lane_env[k];
+        blk->teo_z[i] = b->lane_teo_z[k];
+        blk->ler[i] = b->lane_ler[k];
+      }
+      if (hfe[0])
+        blk->hfe[i] = b->lane_hfe[k];
+    }
+    run_frame_stages(d[l], blk->signal, n);
+  }
+}
+
+int syllable_batch_process(SyllableDetectorBatch *b,
+                           const float *const *inputs, int num_samples,
+                           SyllableEvent *const *events_out, int max_events,
+                           int *num_events) {
+  int total = 0;
+  const float *group_in[DSP_MAX_LANES];
+  const SyllableDetector *first = b->streams[0];
+
+  for (int s = 0; s < b->num_streams; s++)
+    num_events[s] = 0;
+
+  for (int start = 0; start < num_samples; start += first->input_block) {
+    int n_in = num_samples - start;
+    if (n_in > first->input_block)
+      n_in = first->input_block;
+
+    for (int g = 0; g < b->num_streams; g += DSP_MAX_LANES) {
+      int lanes = b->num_streams - g;
+      if (lanes > DSP_MAX_LANES)
+        lanes = DSP_MAX_LANES;
+
+      // Each stream resamples its own input; the resamplers are always in
+      // phase, so they all produce the same number of analysis samples
+      int n = n_in;
+      for (int l = 0; l < lanes; l++) {
+        SyllableDetector *d = b->streams[g + l];
+        group_in[l] = inputs[g + l] + start;
+        if (d->resampler) {
+          n = resample_block(d, group_in[l], n_in);
+          group_in[l] = d->blk.signal;
+        }
+      }
+      if (n == 0)
+        continue;
+      run_feature_stages_lanes(b, b->streams + g, lanes, group_in, n);
+
+      for (int l = 0; l < lanes; l++) {
+        int s = g + l;
+        int written = run_decision_stage(b->streams[s], n,
+                                         events_out[s] + num_events[s],
+                                         max_events - num_events[s]);
+        num_events[s] += written;
+        total += written;
+      }
+    }
+  }
+
+  return total;
+}
+
+int syllable_batch_flush(SyllableDetectorBatch *b,
+                         SyllableEvent *const *events_out, int max_events,
+                         int *num_events) {
+  int total = 0;
+  for (int s = 0; s < b->num_streams; s++) {
+    num_events[s] = syllable_flush(b->streams[s], events_out[s], max_events);
+    total += num_events[s];
+  }
+  return total;
+}
+
+// --- Segmented Offline Analysis ---
+
+// Samples run past a segment's end so that syllables starting inside it are
+// finalized: onset rise (at most 50 ms) plus nucleus (at most 100 ms)
+#define SEGMENT_POSTROLL_MS 250.0f
+#define SEGMENT_EVENT_CHUNK 16
+
+float syllable_default_preroll_ms(const SyllableConfig *config) {
+  SyllableConfig cfg =
+      config ? *config : syllable_default_config(DEFAULT_SAMPLE_RATE);
+
+  // Per-sample state: feature statistics and adaptive threshold
+  // (adaptive_peak_rate_tau_ms), F0 baseline (1 s), AGC release and LER
+  // long-term energy (500 ms)
+  float tau_ms = cfg.adaptive_peak_rate_tau_ms;
+  if (tau_ms < 1000.0f)
+    tau_ms = 1000.0f;
+
+  // Spectral Flux and MFCC statistics use the per-sample coefficient but
+  // update once per hop, so their time constant is hop_size times longer
+  if (cfg.enable_spectral_flux || cfg.enable_mfcc_delta) {
+    int rate =
+        cfg.analysis_rate_hz > 0 ? cfg.analysis_rate_hz : cfg.sample_rate;
+    int hop_size = (int)(cfg.hop_size_ms * 0.001f * rate);
+    if (hop_size > 1 && cfg.adaptive_peak_rate_tau_ms * hop_size > tau_ms)
+      tau_ms = cfg.adaptive_peak_rate_tau_ms * hop_size;
+  }
+
+  // Five time constants: the state is within 1% of a converged run
+  return 5.0f * tau_ms;
+}
+
+static uint64_t gcd_u64(uint64_t a, uint64_t b) {
+  while (b) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Period, in input samples, that segment warm-up starts are aligned to, so
+// that processing blocks, STFT hops, the wavelet octave ladder and the
+// low-rate front-end keep the phase they have when a single detector runs
+// from the start of the recording. With resampling, starts also fall on the
+// resampler's output grid, at a multiple of that period in analysis samples.
+static uint64_t segment_alignment(const SyllableDetector *d) {
+  uint64_t align = PROCESS_BLOCK_SIZE;
+  uint64_t period[3] = {
+      d->stft ? (uint64_t)stft_hop_size(d->stft) : 1,
+      d->wavelet ? (uint64_t)wavelet_decimation(d->wavelet) : 1,
+      d->decimator ? (uint64_t)decimator_factor(d->decimator) : 1};
+  for (int i = 0; i < 3; i++) {
+    if (period[i] > 1)
+      align = align / gcd_u64(align, period[i]) * period[i];
+  }
+  if (d->resampler) {
+    // Every down input samples are up analysis samples
+    int up, down;
+    resampler_ratio(d->resampler, &up, &down);
+    align = align / gcd_u64(align, (uint64_t)up) * (uint64_t)down;
+  }
+  return align;
+}
+
+// Append the events whose onset lies in [seg_start, seg_end)
+static int keep_segment_events(const SyllableEvent *events, int count,
+                               uint64_t seg_start, uint64_t seg_end,
+                               SyllableEvent *events_out, int written,
+                               int max_events) {
+  for (int i = 0; i < count && written < max_events; i++) {
+    uint64_t t = events[i].timestamp_samples;
+    if (t >= seg_start && t < seg_end)
+      events_out[written++] = events[i];
+  }
+  return written;
+}
+
+int syllable_process_segment(SyllableDetector *d, const float *audio,
+                             uint64_t num_samples, uint64_t seg_start,
+                             uint64_t seg_end, float preroll_ms,
+                             SyllableEvent *events_out, int max_events) {
+  if (seg_end > num_samples)
+    seg_end = num_samples;
+  if (seg_start >= seg_end)
+    return 0;
+
+  float rate = (float)d->input_rate;
+  uint64_t preroll =
+      preroll_ms > 0.0f ? (uint64_t)(preroll_ms * 0.001f * rate) : 0;
+  uint64_t postroll = (uint64_t)(SEGMENT_POSTROLL_MS * 0.001f * rate);
+  uint64_t start = seg_start > preroll ? seg_start - preroll : 0;
+  start -= start % segment_alignment(d);
+  uint64_t end =
+      num_samples - seg_end > postroll ? seg_end + postroll : num_samples;
+
+  // Count samples from the start of the recording, so timestamps and the
+  // sample-phase dependent updates line up with a single detector's
+  uint64_t first = start;
+  if (d->resampler) {
+    int up, down;
+    resampler_ratio(d->resampler, &up, &down);
+    first = start / (uint64_t)down * (uint64_t)up;
+  }
+  syllable_reset(d);
+  d->total_samples = first;
+  d->last_event_samples = first;
+
+  // Events of the pre-roll and post-roll must not escape, so the event
+  // callbacks are set aside and every event comes back through chunk
+  SyllableEventFn event_fn = d->event_fn;
+  SyllableEventBatchFn event_batch_fn = d->event_batch_fn;
+  d->event_fn = NULL;
+  d->event_batch_fn = NULL;
+
+  SyllableEvent chunk[SEGMENT_EVENT_CHUNK];
+  int written = 0;
+  for (uint64_t pos = start; pos < end; pos += PROCESS_BLOCK_SIZE) {
+    int n = end - pos < PROCESS_BLOCK_SIZE ? (int)(end - pos)
+                                           : PROCESS_BLOCK_SIZE;
+    int count = syllable_process(d, audio + pos, n, chunk, SEGMENT_EVENT_CHUNK);
+    written = keep_segment_events(chunk, count, seg_start, seg_end, events_out,
+                                  written, max_events);
+  }
+
+  int count;
+  while ((count = syllable_flush(d, chunk, SEGMENT_EVENT_CHUNK)) > 0) {
+    written = keep_segment_events(chunk, count, seg_start, seg_end, events_out,
+                                  written, max_events);
+  }
+
+  d->event_fn = event_fn;
+  d->event_batch_fn = event_batch_fn;
+  return written;
+}
+
+int syllable_stitch_segments(const SyllableConfig *config,
+                             SyllableEvent *events, int num_events) {
+  if (!config || !events || num_events <= 0)
+    return 0;
+
+  // Scratch for scoring an event against context_size others
+  int context_size = config->context_size > 0 ? config->context_size : 0;
+  void *(*alloc)(size_t) =
+      config->user_malloc ? config->user_malloc : default_malloc;
+  void (*free_fn)(void *) =
+      config->user_free ? config->user_free : default_free;
+  size_t context_bytes = (size_t)(context_size + 1) * sizeof(SyllableEvent *);
+  void *scratch =
+      alloc(context_bytes + (size_t)(context_size + 1) * sizeof(float));
+  if (!scratch)
+    return 0;
+  const SyllableEvent **context = (const SyllableEvent **)scratch;
+  float *context_f0 = (float *)((char *)scratch + context_bytes);
+
+  // Both segments around a boundary may report the same syllable; a single
+  // detector never emits onsets closer than the minimum distance
+  uint64_t min_dist = (uint64_t)(config->min_syllable_dist_ms * 0.001f *
+                                 config->sample_rate);
+  int count = 1;
+  for (int i = 1; i < num_events; i++) {
+    if (events[i].timestamp_samples <
+        events[count - 1].timestamp_samples + min_dist)
+      continue;
+    events[count++] = events[i];
+  }
+
+  // Score each event as the ring buffer does when it is emitted: the context
+  // is the following events still buffered (earlier ones have already left),
+  // and the last ones are scored by syllable_flush with a stricter threshold
+  int context_needed = config->realtime_mode ? 0 : context_size;
+
+  for (int i = 0; i < count; i++) {
+    int n = 0;
+    for (int k = 1; k <= context_needed && i + k < count; k++)
+      context[n++] = &events[i + k];
+
+    SyllableEvent *evt = &events[i];
+    evt->delta_f0 = context_delta_f0(evt, context, n, context_f0);
+    float score = context_prominence(evt, context, n);
+    evt->prominence_score = score;
+    evt->is_accented = count - i > context_needed ? (score > 0.9f)
+                                                  : (score > 1.2f);
+  }
+
+  free_fn(scratch);
+  return count;
+}
+
 // --- Real-Time Mode API ---
 
 /**
@@ -1607,3 +2997,80 @@ void syllable_set_snr_threshold(SyllableDetector *d, float snr_db) {
     d->rt_cal.gamma = powf(10.0f, snr_db / 10.0f);
   }
 }
+
+void syllable_set_feature_trace(SyllableDetector *d,
+                                SyllableFeatureTraceFn callback,
+                                void *user_data) {
+  if (!d)
+    return;
+  d->trace_fn = callback;
+  d->trace_user = user_data;
+  d->trace_since_hop = 0;
+}
+
+void syllable_set_event_callback(SyllableDetector *d, SyllableEventFn callback,
+                                 void *user_data) {
+  if (!d)
+    return;
+  d->event_fn = callback;
+  d->event_user = user_data;
+}
+
+void syllable_set_event_batch_callback(SyllableDetector *d,
+                                       SyllableEventBatchFn callback,
+                                       void *user_data) {
+  if (!d)
+    return;
+  d->event_batch_fn = callback;
+  d->event_batch_user = user_data;
+}
+
+int syllable_get_fusion_stats(const SyllableDetector *d, float *median,
+                              float *mad) {
+  int count = d ? running_median_count(d->fusion_window) : 0;
+  if (median)
+    *median = count ? running_median_get(d->fusion_window) : 0.0f;
+  if (mad)
+    *mad = count ? running_median_mad(d->fusion_window) : 0.0f;
+  return count;
+}
+
+int syllable_get_perf_counters(const SyllableDetector *d,
+                               SyllablePerfCounters *out) {
+  if (!out)
+    return 0;
+  memset(out, 0, sizeof(*out));
+#ifdef SYLLABLE_PERF_COUNTERS
+  if (d) {
+    *out = d->perf;
+    out->ticks_are_cycles = PERF_CYCLES;
+    return 1;
+  }
+#else
+  (void)d;
+#endif
+  return 0;
+}
+
+void syllable_reset_perf_counters(SyllableDetector *d) {
+#ifdef SYLLABLE_PERF_COUNTERS
+  if (d)
+    memset(&d->perf, 0, sizeof(d->perf));
+#else
+  (void)d;
+#endif
+}
+
+const char *syllable_perf_stage_name(SyllablePerfStage stage) {
+  static const char *const names[SYLLABLE_NUM_STAGES] = {
+      "agc",      "zff",     "peak_rate", "teo_ler", "high_freq",
+      "spectral", "wavelet", "tracking",  "fusion",  "state_machine",
+      "decimation", "resample"};
+  if ((int)stage < 0 || stage >= SYLLABLE_NUM_STAGES)
+    return "unknown";
+  return names[stage];
+}
+
+const char *syllable_get_simd_path(const SyllableDetector *d) {
+  return d ? simd_isa_name(d->simd->isa) : NULL;
+}
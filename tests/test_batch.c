@@ -0,0 +1,149 @@
+// test_batch - The batch API against separate detectors
+//
+// syllable_batch_process must produce exactly the events of one
+// syllable_process detector per stream (compared byte for byte), for stream
+// counts that fill SIMD lane groups partially and completely, for block
+// lengths below and above the internal block, and for the configurations
+// whose stages run in lockstep differently (feature subsets, resampled and
+// decimated front-ends).
+
+#include "syllable_detector.h"
+#include "test_signal.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SECONDS 4
+#define MAX_EVENTS 256
+
+static int failures;
+
+// Feed one detector in blocks of block samples, then flush
+static int run_scalar(const SyllableConfig *config, const float *x, int n,
+                      int block, SyllableEvent *events) {
+  SyllableDetector *d = syllable_create(config);
+  if (!d)
+    return -1;
+  int count = 0;
+  for (int i = 0; i < n; i += block) {
+    int m = n - i < block ? n - i : block;
+    count += syllable_process(d, x + i, m, events + count, MAX_EVENTS - count);
+  }
+  count += syllable_flush(d, events + count, MAX_EVENTS - count);
+  syllable_destroy(d);
+  return count;
+}
+
+static void check_batch(const char *name, const SyllableConfig *config,
+                        int num_streams, int block) {
+  int n = config->sample_rate * SECONDS;
+  float **x = (float **)calloc(num_streams, sizeof(float *));
+  const float **in = (const float **)calloc(num_streams, sizeof(float *));
+  SyllableEvent *ref = (SyllableEvent *)calloc(
+      (size_t)num_streams * MAX_EVENTS, sizeof(SyllableEvent));
+  SyllableEvent *got = (SyllableEvent *)calloc(
+      (size_t)num_streams * MAX_EVENTS, sizeof(SyllableEvent));
+  SyllableEvent **out =
+      (SyllableEvent **)calloc(num_streams, sizeof(SyllableEvent *));
+  int *num_ref = (int *)calloc(num_streams, sizeof(int));
+  int *num_got = (int *)calloc(num_streams, sizeof(int));
+  int *counts = (int *)calloc(num_streams, sizeof(int));
+  SyllableDetectorBatch *b = syllable_batch_create(config, num_streams);
+
+  int ok = x && in && ref && got && out && num_ref && num_got && counts && b;
+  for (int s = 0; ok && s < num_streams; s++) {
+    x[s] = test_make_syllables(config->sample_rate, n, s);
+    ok = x[s] != NULL;
+    if (ok)
+      num_ref[s] = run_scalar(config, x[s], n, block, ref + s * MAX_EVENTS);
+    ok = ok && num_ref[s] >= 0;
+  }
+
+  for (int i = 0; ok && i < n; i += block) {
+    int m = n - i < block ? n - i : block;
+    for (int s = 0; s < num_streams; s++) {
+      in[s] = x[s] + i;
+      out[s] = got + s * MAX_EVENTS + num_got[s];
+    }
+    syllable_batch_process(b, in, m, out, MAX_EVENTS / 4, counts);
+    for (int s = 0; s < num_streams; s++)
+      num_got[s] += counts[s];
+  }
+  if (ok) {
+    for (int s = 0; s < num_streams; s++)
+      out[s] = got + s * MAX_EVENTS + num_got[s];
+    syllable_batch_flush(b, out, MAX_EVENTS / 4, counts);
+  }
+
+  int total = 0;
+  int mismatch = -1;
+  for (int s = 0; ok && s < num_streams; s++) {
+    num_got[s] += counts[s];
+    total += num_ref[s];
+    if (mismatch < 0 &&
+        (num_got[s] != num_ref[s] ||
+         memcmp(got + s * MAX_EVENTS, ref + s * MAX_EVENTS,
+                (size_t)num_ref[s] * sizeof(SyllableEvent)) != 0))
+      mismatch = s;
+  }
+
+  if (!ok) {
+    printf("  FAIL: %s: setup failed\n", name);
+    failures++;
+  } else if (mismatch >= 0) {
+    printf("  FAIL: %s, %d streams, block %d: stream %d has %d events, "
+           "expected %d\n",
+           name, num_streams, block, mismatch, num_got[mismatch],
+           num_ref[mismatch]);
+    failures++;
+  } else if (total == 0) {
+    printf("  FAIL: %s: no events to compare\n", name);
+    failures++;
+  } else {
+    printf("%-22s %2d streams, block %4d: %4d events ok\n", name,
+           num_streams, block, total);
+  }
+
+  syllable_batch_destroy(b);
+  for (int s = 0; x && s < num_streams; s++)
+    free(x[s]);
+  free(x);
+  free(in);
+  free(ref);
+  free(got);
+  free(out);
+  free(num_ref);
+  free(num_got);
+  free(counts);
+}
+
+int main(void) {
+  SyllableConfig config = syllable_default_config(16000);
+  check_batch("16 kHz default", &config, 1, 97);
+  check_batch("16 kHz default", &config, 5, 97);
+  check_batch("16 kHz default", &config, 17, 4000);
+
+  config.enable_agc = 0;
+  config.enable_high_freq_energy = 0;
+  check_batch("16 kHz no AGC/HFE", &config, 5, 4000);
+
+  config = syllable_default_config(16000);
+  config.enable_spectral_flux = 0;
+  config.enable_mfcc_delta = 0;
+  config.enable_wavelet = 0;
+  config.enable_high_freq_energy = 0;
+  check_batch("16 kHz filters only", &config, 5, 97);
+
+  config = syllable_default_config(48000);
+  check_batch("48 kHz default", &config, 5, 4000);
+
+  config.front_end_rate_hz = 8000.0f;
+  check_batch("48 kHz front-end 8k", &config, 5, 97);
+
+  config = syllable_default_config(44100);
+  config.analysis_rate_hz = 16000;
+  check_batch("44.1 kHz analysis 16k", &config, 5, 4000);
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// test_running_median - The sliding-window median and MAD against sorting
+//
+// After every push, running_median_get and running_median_mad must equal
+// the median and MAD of the last capacity values computed by sorting a copy
+// of them, exactly. Windows cover the single-value case, both parities, and
+// lengths spanning several skip-list levels; values include long runs of
+// ties, and resets must start the window over.
+
+#include "dsp/running_median.h"
+#include "test_signal.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PUSHES 5000
+
+static int failures;
+
+static uint32_t rng = 0x12345678u;
+
+static int compare_floats(const void *a, const void *b) {
+  float x = *(const float *)a, y = *(const float *)b;
+  return (x > y) - (x < y);
+}
+
+static float sorted_median(float *v, int n) {
+  qsort(v, n, sizeof(float), compare_floats);
+  if (n & 1)
+    return v[n >> 1];
+  return 0.5f * (v[(n >> 1) - 1] + v[n >> 1]);
+}
+
+// Median and MAD of the last n values of history (ending at end)
+static void reference(const float *history, int end, int n, float *median,
+                      float *mad, float *scratch) {
+  memcpy(scratch, history + end - n, n * sizeof(float));
+  *median = sorted_median(scratch, n);
+  for (int i = 0; i < n; i++) {
+    float d = history[end - n + i] - *median;
+    scratch[i] = d < 0.0f ? -d : d;
+  }
+  *mad = sorted_median(scratch, n);
+}
+
+// levels distinct values (0: continuous)
+static float make_value(int levels) {
+  if (levels > 0)
+    return (float)(test_random(&rng) % (uint32_t)levels) * 0.25f;
+  return test_random_unit(&rng);
+}
+
+// Window in its own block, laid out the way a detector lays out its modules
+static RunningMedian *create_window(int capacity, void **memory) {
+  DspArena arena;
+  dsp_arena_init(&arena, NULL, 0);
+  running_median_create(capacity, &arena);
+  size_t size = dsp_arena_block_size(&arena);
+  *memory = calloc(1, size);
+  if (!*memory)
+    return NULL;
+  dsp_arena_init(&arena, *memory, size);
+  return running_median_create(capacity, &arena);
+}
+
+static void check_window(int capacity, int levels) {
+  void *memory = NULL;
+  RunningMedian *rm = create_window(capacity, &memory);
+  float *history = (float *)malloc(PUSHES * sizeof(float));
+  float *scratch = (float *)malloc(PUSHES * sizeof(float));
+  if (!rm || !history || !scratch) {
+    printf("  FAIL: window %d: out of memory\n", capacity);
+    failures++;
+    free(memory);
+    free(history);
+    free(scratch);
+    return;
+  }
+
+  int errors = 0;
+  int start = 0; // History index the window restarted from
+  for (int i = 0; i < PUSHES && errors == 0; i++) {
+    if (i == PUSHES / 2) {
+      running_median_reset(rm);
+      start = i;
+    }
+    history[i] = make_value(levels);
+    running_median_push(rm, history[i]);
+
+    int n = i + 1 - start < capacity ? i + 1 - start : capacity;
+    float median, mad;
+    reference(history, i + 1, n, &median, &mad, scratch);
+    if (running_median_count(rm) != n || running_median_get(rm) != median ||
+        running_median_mad(rm) != mad) {
+      printf("  FAIL: window %d, %d levels, push %d: count %d median %g "
+             "mad %g, expected %d %g %g\n",
+             capacity, levels, i, running_median_count(rm),
+             running_median_get(rm), running_median_mad(rm), n, median, mad);
+      errors++;
+    }
+  }
+  if (errors)
+    failures++;
+  else
+    printf("window %4d, %s: ok\n", capacity,
+           levels ? "ties      " : "continuous");
+
+  free(memory);
+  free(history);
+  free(scratch);
+}
+
+int main(void) {
+  static const int capacities[] = {1, 2, 3, 8, 63, 64, 257, 1000};
+  for (int i = 0; i < (int)(sizeof(capacities) / sizeof(capacities[0]));
+       i++) {
+    check_window(capacities[i], 0);
+    check_window(capacities[i], 5);
+  }
+
+  // Empty window
+  void *memory = NULL;
+  RunningMedian *rm = create_window(4, &memory);
+  if (!rm || running_median_count(rm) != 0 || running_median_get(rm) != 0.0f ||
+      running_median_mad(rm) != 0.0f) {
+    printf("  FAIL: empty window\n");
+    failures++;
+  }
+  free(memory);
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+// test_segments - Stitched segments against a single detector
+//
+// A recording analyzed as independent segments (syllable_process_segment
+// with the default pre-roll) and merged with syllable_stitch_segments must
+// reproduce the events of one detector run over the whole recording, byte
+// for byte: the same onsets, and the same delta_f0, prominence and accents
+// across the segment boundaries. Covered at the input rate, with
+// resampling to an analysis rate, and with a low-rate front-end. The
+// default pre-roll (minutes) reaches back to the start of these recordings,
+// so each segment replays everything before it.
+//
+// Shorter pre-rolls on a longer recording warm up from the middle of it, on
+// starts aligned down to the processing period, and leave the slow feature
+// statistics partly converged: there the onsets away from segment
+// boundaries must still match within ONSET_TOLERANCE_MS, and the event
+// counts stay close.
+//
+// With event callbacks installed, segments still return their events and
+// the callbacks receive none.
+//
+// Segments feed the detector in 256-sample processing blocks, so the single
+// run does too: at 44.1/48 kHz the wavelet's overlap-save engine only runs
+// on long enough blocks, and its rounding differs from direct convolution.
+
+#include "syllable_detector.h"
+#include "test_signal.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SECONDS 20
+#define MAX_EVENTS 1024
+#define BLOCK 256 // PROCESS_BLOCK_SIZE
+
+// Short pre-roll cases
+#define LONG_SECONDS 60
+#define ONSET_TOLERANCE_MS 20.0
+#define BOUNDARY_MARGIN_MS 1000.0 // Onsets this close to a boundary are free
+#define MIN_MATCHED 0.9           // Of the onsets away from boundaries
+#define MAX_COUNT_ERROR 0.05      // Relative difference in event counts
+
+static int failures;
+
+static void check_segments(const char *name, const SyllableConfig *config,
+                           int num_segments) {
+  int n = config->sample_rate * SECONDS;
+  float *x = test_make_syllables(config->sample_rate, n, 0);
+  SyllableEvent *ref =
+      (SyllableEvent *)calloc(MAX_EVENTS, sizeof(SyllableEvent));
+  SyllableEvent *got =
+      (SyllableEvent *)calloc(MAX_EVENTS, sizeof(SyllableEvent));
+  SyllableDetector *d = syllable_create(config);
+  if (!x || !ref || !got || !d) {
+    printf("  FAIL: %s: setup failed\n", name);
+    failures++;
+    goto done;
+  }
+
+  int num_ref = 0;
+  for (int i = 0; i < n; i += BLOCK) {
+    int m = n - i < BLOCK ? n - i : BLOCK;
+    num_ref += syllable_process(d, x + i, m, ref + num_ref,
+                                MAX_EVENTS - num_ref);
+  }
+  num_ref += syllable_flush(d, ref + num_ref, MAX_EVENTS - num_ref);
+
+  float preroll_ms = syllable_default_preroll_ms(config);
+  int num_got = 0;
+  for (int s = 0; s < num_segments; s++) {
+    uint64_t start = (uint64_t)n * s / num_segments;
+    uint64_t end = (uint64_t)n * (s + 1) / num_segments;
+    num_got += syllable_process_segment(d, x, n, start, end, preroll_ms,
+                                        got + num_got, MAX_EVENTS - num_got);
+  }
+  num_got = syllable_stitch_segments(config, got, num_got);
+
+  int first = -1; // First differing event
+  for (int i = 0; i < num_ref && i < num_got && first < 0; i++) {
+    if (memcmp(&got[i], &ref[i], sizeof(SyllableEvent)) != 0)
+      first = i;
+  }
+  if (num_ref == 0) {
+    printf("  FAIL: %s: no events to compare\n", name);
+    failures++;
+  } else if (num_got != num_ref || first >= 0) {
+    printf("  FAIL: %s, %d segments: %d events, expected %d", name,
+           num_segments, num_got, num_ref);
+    if (first >= 0)
+      printf("; event %d at %llu differs", first,
+             (unsigned long long)ref[first].timestamp_samples);
+    printf("\n");
+    failures++;
+  } else {
+    printf("%-22s %d segments: %4d events ok\n", name, num_segments,
+           num_ref);
+  }
+
+done:
+  syllable_destroy(d);
+  free(x);
+  free(ref);
+  free(got);
+}
+
+// Nearest stitched onset to t, as a distance in samples
+static uint64_t nearest_onset(const SyllableEvent *events, int count,
+                              uint64_t t) {
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < count; i++) {
+    uint64_t e = events[i].timestamp_samples;
+    uint64_t d = e > t ? e - t : t - e;
+    if (d < best)
+      best = d;
+  }
+  return best;
+}
+
+static void check_short_preroll(const char *name, const SyllableConfig *config,
+                                int num_segments, float preroll_ms) {
+  int rate = config->sample_rate;
+  int n = rate * LONG_SECONDS;
+  float *x = test_make_syllables(rate, n, 0);
+  SyllableEvent *ref =
+      (SyllableEvent *)calloc(MAX_EVENTS, sizeof(SyllableEvent));
+  SyllableEvent *got =
+      (SyllableEvent *)calloc(MAX_EVENTS, sizeof(SyllableEvent));
+  SyllableDetector *d = syllable_create(config);
+  if (!x || !ref || !got || !d) {
+    printf("  FAIL: %s: setup failed\n", name);
+    failures++;
+    goto done;
+  }
+
+  int num_ref = 0;
+  for (int i = 0; i < n; i += BLOCK) {
+    int m = n - i < BLOCK ? n - i : BLOCK;
+    num_ref += syllable_process(d, x + i, m, ref + num_ref,
+                                MAX_EVENTS - num_ref);
+  }
+  num_ref += syllable_flush(d, ref + num_ref, MAX_EVENTS - num_ref);
+
+  // Every segment but the first warms up from inside the recording
+  uint64_t preroll = (uint64_t)(preroll_ms * 0.001 * rate);
+  int num_got = 0;
+  for (int s = 0; s < num_segments; s++) {
+    uint64_t start = (uint64_t)n * s / num_segments;
+    uint64_t end = (uint64_t)n * (s + 1) / num_segments;
+    if (s > 0 && start <= preroll) {
+      printf("  FAIL: %s: segment %d warms up from the start\n", name, s);
+      failures++;
+      goto done;
+    }
+    num_got += syllable_process_segment(d, x, n, start, end, preroll_ms,
+                                        got + num_got, MAX_EVENTS - num_got);
+  }
+  num_got = syllable_stitch_segments(config, got, num_got);
+
+  uint64_t tolerance = (uint64_t)(ONSET_TOLERANCE_MS * 0.001 * rate);
+  uint64_t margin = (uint64_t)(BOUNDARY_MARGIN_MS * 0.001 * rate);
+  int away = 0, matched = 0;
+  for (int i = 0; i < num_ref; i++) {
+    uint64_t t = ref[i].timestamp_samples;
+    int near_boundary = 0;
+    for (int s = 1; s < num_segments; s++) {
+      uint64_t b = (uint64_t)n * s / num_segments;
+      near_boundary |= (t > b ? t - b : b - t) < margin;
+    }
+    if (near_boundary)
+      continue;
+    away++;
+    matched += nearest_onset(got, num_got, t) <= tolerance;
+  }
+
+  double count_error = fabs((double)(num_got - num_ref)) / num_ref;
+  if (away == 0 || matched < MIN_MATCHED * away ||
+      count_error > MAX_COUNT_ERROR) {
+    printf("  FAIL: %s, %d segments, %.0f ms pre-roll: %d of %d onsets "
+           "matched, %d events, expected %d\n",
+           name, num_segments, preroll_ms, matched, away, num_got, num_ref);
+    failures++;
+  } else {
+    printf("%-22s %d segments, %5.0f ms pre-roll: %d of %d onsets, "
+           "%d events for %d ok\n",
+           name, num_segments, preroll_ms, matched, away, num_got, num_ref);
+  }
+
+done:
+  syllable_destroy(d);
+  free(x);
+  free(ref);
+  free(got);
+}
+
+static void count_event(void *user_data, const SyllableEvent *event) {
+  (void)event;
+  (*(int *)user_data)++;
+}
+
+static void count_batch(void *user_data, const SyllableEvent *events,
+                        int count) {
+  (void)events;
+  *(int *)user_data += count;
+}
+
+// A mid-recording segment with a short pre-roll, with and without callbacks
+static void check_callbacks(void) {
+  SyllableConfig config = syllable_default_config(16000);
+  int n = config.sample_rate * SECONDS;
+  uint64_t start = (uint64_t)n / 4, end = (uint64_t)n / 2;
+  float *x = test_make_syllables(config.sample_rate, n, 0);
+  SyllableEvent *ref =
+      (SyllableEvent *)calloc(MAX_EVENTS, sizeof(SyllableEvent));
+  SyllableEvent *got =
+      (SyllableEvent *)calloc(MAX_EVENTS, sizeof(SyllableEvent));
+  SyllableDetector *d = syllable_create(&config);
+  if (!x || !ref || !got || !d) {
+    printf("  FAIL: callbacks: setup failed\n");
+    failures++;
+    goto done;
+  }
+
+  int num_ref =
+      syllable_process_segment(d, x, n, start, end, 3000.0f, ref, MAX_EVENTS);
+
+  int delivered = 0;
+  syllable_set_event_callback(d, count_event, &delivered);
+  syllable_set_event_batch_callback(d, count_batch, &delivered);
+  int num_got =
+      syllable_process_segment(d, x, n, start, end, 3000.0f, got, MAX_EVENTS);
+
+  int inside = 1;
+  for (int i = 0; i < num_got; i++)
+    inside &= got[i].timestamp_samples >= start &&
+              got[i].timestamp_samples < end;
+
+  // The callbacks are back in place for the next call
+  int returned = 0;
+  for (int i = 0; i < n; i += BLOCK) {
+    int m = n - i < BLOCK ? n - i : BLOCK;
+    returned += syllable_process(d, x + i, m, NULL, 0);
+  }
+  returned += syllable_flush(d, NULL, 0);
+
+  if (num_ref == 0 || num_got != num_ref ||
+      memcmp(got, ref, (size_t)num_ref * sizeof(SyllableEvent)) != 0 ||
+      !inside) {
+    printf("  FAIL: callbacks: segment returned %d events, expected %d\n",
+           num_got, num_ref);
+    failures++;
+  } else if (delivered != 2 * returned || returned == 0) {
+    printf("  FAIL: callbacks: received %d events, expected %d\n", delivered,
+           2 * returned);
+    failures++;
+  } else {
+    printf("%-22s segment: %4d events ok\n", "callbacks installed",
+           num_got);
+  }
+
+done:
+  syllable_destroy(d);
+  free(x);
+  free(ref);
+  free(got);
+}
+
+int main(void) {
+  SyllableConfig config = syllable_default_config(16000);
+  check_segments("16 kHz default", &config, 1);
+  check_segments("16 kHz default", &config, 4);
+  check_segments("16 kHz default", &config, 7);
+
+  config = syllable_default_config(48000);
+  config.analysis_rate_hz = 16000;
+  check_segments("48 kHz analysis 16k", &config, 3);
+
+  config = syllable_default_config(48000);
+  config.front_end_rate_hz = 8000.0f;
+  check_segments("48 kHz front-end 8k", &config, 3);
+
+  config = syllable_default_config(16000);
+  check_short_preroll("16 kHz default", &config, 4, 10000.0f);
+  check_short_preroll("16 kHz default", &config, 7, 3000.0f);
+
+  check_callbacks();
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// test_signal.h - Deterministic random numbers and synthetic speech for the
+// tests and benchmarks
+//
+// Everything is generated from an explicit xorshift32 state, so a given seed
+// yields the same data on every run and platform.
+
+#ifndef TEST_SIGNAL_H
+#define TEST_SIGNAL_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Next xorshift32 value (the state must not be 0)
+static inline uint32_t test_random(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+// Uniform in [0, 1)
+static inline float test_random_unit(uint32_t *state) {
+  return (float)(test_random(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Uniform in [-1, 1)
+static inline float test_noise(uint32_t *state) {
+  return (float)(test_random(state) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+// n samples of voiced syllables with a moving F0, fricative onsets, clicks
+// and a noise floor; seed varies the rhythm, pitch and level. Returns a
+// malloc'd buffer, or NULL.
+static inline float *test_make_syllables(int sample_rate, int n, int seed) {
+  float *x = (float *)malloc((size_t)n * sizeof(float));
+  if (!x)
+    return NULL;
+  uint32_t rng = 0x9e3779b9u + (uint32_t)seed * 7919u;
+  double period = 0.27 + 0.01 * (seed % 3);
+  double gain = 0.4 + 0.15 * (seed % 7);
+  double phase = 0.0;
+  for (int i = 0; i < n; i++) {
+    double t = (double)i / sample_rate + seed * 0.031;
+    int index = (int)(t / period);
+    double pos = fmod(t, period);
+    double f0 = 110.0 + 40.0 * sin(2.1 * t) + 15.0 * (index % 3) + seed;
+    phase += 2.0 * M_PI * f0 / sample_rate;
+
+    double v = 0.0;
+    if (pos > 0.05 && pos < 0.22) {
+      double env = sin(M_PI * (pos - 0.05) / 0.17);
+      double level = index % 4 == 1 ? 0.6 : 0.25;
+      for (int h = 1; h <= 12; h++)
+        v += level * env * sin(h * phase) / h;
+    }
+    if (pos > 0.02 && pos < 0.05 && index % 2 == 0)
+      v += 0.08 * test_noise(&rng);
+    if (pos < 0.0015 && index % 5 == 2)
+      v += 0.5 * test_noise(&rng);
+    v += 0.001 * test_noise(&rng);
+    x[i] = (float)(v * gain);
+  }
+  return x;
+}
+
+#endif // TEST_SIGNAL_H
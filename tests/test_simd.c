@@ -0,0 +1,349 @@
+// test_simd - Accuracy of every SIMD kernel on every ISA this host runs
+//
+// Each kernel table (see src/dsp/simd_dispatch.h) is checked against a
+// double-precision reference over lengths that exercise every vector width
+// and tail, and for writes past the end of the output.
+
+#include "dsp/simd_dispatch.h"
+#include "test_signal.h"
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_N 1100
+#define GUARD 32 // Output floats past n that must stay untouched
+
+// Lengths 0..70 cover every tail of 4-, 8- and 16-lane loops; the rest are
+// the bin counts and windows the detector uses
+static const size_t long_lengths[] = {127, 129, 255, 257, 513, 1024, 1031};
+#define NUM_LONG (int)(sizeof(long_lengths) / sizeof(long_lengths[0]))
+#define NUM_SHORT 71
+
+static int failures;
+
+#define CHECK(cond, ...)                                                       \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      failures++;                                                              \
+      if (failures <= 20) {                                                    \
+        printf("  FAIL: ");                                                    \
+        printf(__VA_ARGS__);                                                   \
+        printf("\n");                                                          \
+      }                                                                        \
+    }                                                                          \
+  } while (0)
+
+static uint32_t rng = 0x9e3779b9u;
+
+// Uniform in [lo, hi)
+static float uniform(float lo, float hi) {
+  return lo + (hi - lo) * test_random_unit(&rng);
+}
+
+static size_t test_length(int k) {
+  return k < NUM_SHORT ? (size_t)k : long_lengths[k - NUM_SHORT];
+}
+
+// Distance from ref in units in the last place of ref (as a float)
+static double ulp_error(float got, double ref) {
+  float r = (float)ref;
+  double ulp = (double)nextafterf(fabsf(r), INFINITY) - fabsf(r);
+  return fabs((double)got - ref) / ulp;
+}
+
+// Tolerance of a float sum of n terms whose magnitudes add up to abs_sum,
+// in any order
+static double sum_tolerance(size_t n, double abs_sum) {
+  return (double)(n + 2) * FLT_EPSILON * abs_sum + 1e-30;
+}
+
+static float out[MAX_N + GUARD];
+static float out2[MAX_N + GUARD];
+
+static void fill_guard(float *buf, size_t n) {
+  for (size_t i = 0; i < n + GUARD; i++)
+    buf[i] = -12345.0f;
+}
+
+static int guard_intact(const float *buf, size_t n) {
+  for (size_t i = n; i < n + GUARD; i++)
+    if (buf[i] != -12345.0f)
+      return 0;
+  return 1;
+}
+
+// --- Kernels ---
+
+static void test_reductions(const SimdKernels *k) {
+  static float a[MAX_N], b[MAX_N], c[MAX_N];
+  for (int t = 0; t < NUM_SHORT + NUM_LONG; t++) {
+    size_t n = test_length(t);
+    for (size_t i = 0; i < n; i++) {
+      a[i] = uniform(-1.0f, 1.0f);
+      b[i] = uniform(-1.0f, 1.0f);
+      c[i] = uniform(-1.0f, 1.0f);
+    }
+
+    double dot = 0, dot_abs = 0, sq = 0, hwr = 0, cr = 0, ci = 0;
+    double c_abs = 0;
+    for (size_t i = 0; i < n; i++) {
+      dot += (double)a[i] * b[i];
+      dot_abs += fabs((double)a[i] * b[i]);
+      sq += (double)a[i] * a[i];
+      double d = (double)a[i] - b[i];
+      if (d > 0)
+        hwr += d * d;
+      cr += (double)a[i] * b[i];
+      ci += (double)a[i] * c[i];
+      c_abs += fabs((double)a[i] * c[i]);
+    }
+
+    float got = k->dot_product(a, b, n);
+    CHECK(fabs(got - dot) <= sum_tolerance(n, dot_abs),
+          "dot_product n=%zu: %g vs %g", n, got, dot);
+    got = k->sum_squares(a, n);
+    CHECK(fabs(got - sq) <= sum_tolerance(n, sq), "sum_squares n=%zu: %g vs %g",
+          n, got, sq);
+    // The difference itself rounds, hence the extra term per element
+    got = k->hwr_diff_sum(a, b, n);
+    CHECK(fabs(got - hwr) <= sum_tolerance(3 * n, hwr),
+          "hwr_diff_sum n=%zu: %g vs %g", n, got, hwr);
+
+    float r, im;
+    k->complex_dot(a, b, c, n, &r, &im);
+    CHECK(fabs(r - cr) <= sum_tolerance(n, dot_abs) &&
+              fabs(im - ci) <= sum_tolerance(n, c_abs),
+          "complex_dot n=%zu: (%g, %g) vs (%g, %g)", n, r, im, cr, ci);
+  }
+}
+
+static void test_windows(const SimdKernels *k) {
+  static float data[MAX_N], window[MAX_N];
+  for (int t = 0; t < NUM_SHORT + NUM_LONG; t++) {
+    size_t n = test_length(t);
+    for (size_t i = 0; i < n; i++) {
+      data[i] = uniform(-1.0f, 1.0f);
+      window[i] = uniform(0.0f, 1.0f);
+    }
+
+    // One rounding per product: exact against the float product
+    fill_guard(out, n);
+    k->window_copy(data, window, out, n);
+    int exact = 1;
+    for (size_t i = 0; i < n; i++)
+      exact &= out[i] == data[i] * window[i];
+    CHECK(exact, "window_copy n=%zu differs from data * window", n);
+    CHECK(guard_intact(out, n), "window_copy n=%zu wrote past n", n);
+
+    fill_guard(out2, n);
+    memcpy(out2, data, n * sizeof(float));
+    k->apply_window(out2, window, n);
+    CHECK(memcmp(out, out2, n * sizeof(float)) == 0,
+          "apply_window n=%zu differs from window_copy", n);
+    CHECK(guard_intact(out2, n), "apply_window n=%zu wrote past n", n);
+  }
+}
+
+static void test_spectra(const SimdKernels *k) {
+  static float cpx[2 * MAX_N], prev[MAX_N + GUARD];
+  for (int t = 0; t < NUM_SHORT + NUM_LONG; t++) {
+    size_t n = test_length(t);
+    for (size_t i = 0; i < 2 * n; i++)
+      cpx[i] = uniform(-100.0f, 100.0f);
+    // Some empty bins, which the flatness sums must skip
+    for (size_t i = 0; i < n; i += 7)
+      cpx[2 * i] = cpx[2 * i + 1] = 0.0f;
+
+    double max_mag = 0, max_pow = 0;
+    fill_guard(out, n);
+    fill_guard(out2, n);
+    k->magnitude(cpx, out, n);
+    k->power(cpx, out2, n);
+    for (size_t i = 0; i < n; i++) {
+      double p = (double)cpx[2 * i] * cpx[2 * i] +
+                 (double)cpx[2 * i + 1] * cpx[2 * i + 1];
+      if (p == 0) {
+        CHECK(out[i] == 0 && out2[i] == 0, "empty bin %zu not zero", i);
+        continue;
+      }
+      double e = ulp_error(out[i], sqrt(p));
+      max_mag = e > max_mag ? e : max_mag;
+      e = ulp_error(out2[i], p);
+      max_pow = e > max_pow ? e : max_pow;
+    }
+    CHECK(max_mag <= 2.0, "magnitude n=%zu: %.2f ulp", n, max_mag);
+    CHECK(max_pow <= 2.0, "power n=%zu: %.2f ulp", n, max_pow);
+    CHECK(guard_intact(out, n), "magnitude n=%zu wrote past n", n);
+    CHECK(guard_intact(out2, n), "power n=%zu wrote past n", n);
+
+    // Spectral stats, against the previous frame in prev
+    for (size_t i = 0; i < n; i++)
+      prev[i] = uniform(0.0f, 120.0f);
+    for (size_t i = n; i < n + GUARD; i++)
+      prev[i] = -12345.0f;
+    double flux = 0, flux_err = 0, logs = 0, logs_abs = 0, arith = 0;
+    int valid = 0;
+    for (size_t i = 0; i < n; i++) {
+      double m = sqrt((double)cpx[2 * i] * cpx[2 * i] +
+                      (double)cpx[2 * i + 1] * cpx[2 * i + 1]);
+      double d = m - prev[i];
+      if (d > 0) {
+        // Each float magnitude is off by up to an ulp before it is
+        // differenced and squared
+        flux += d * d;
+        flux_err += 4.0 * FLT_EPSILON * d * (m + prev[i]);
+      }
+      if (m > 1e-10) {
+        logs += log(m);
+        logs_abs += fabs(log(m)) + 1.0;
+        arith += m;
+        valid++;
+      }
+    }
+    float log_sum, arith_sum;
+    int got_valid;
+    float got_flux =
+        k->spectral_stats(cpx, prev, n, &log_sum, &arith_sum, &got_valid);
+    CHECK(fabs(got_flux - flux) <= flux_err + sum_tolerance(n, flux),
+          "spectral_stats n=%zu: flux %g vs %g", n, got_flux, flux);
+    CHECK(fabs(log_sum - logs) <= sum_tolerance(n, logs_abs),
+          "spectral_stats n=%zu: log_sum %g vs %g", n, log_sum, logs);
+    CHECK(fabs(arith_sum - arith) <= sum_tolerance(n, arith),
+          "spectral_stats n=%zu: arith_sum %g vs %g", n, arith_sum, arith);
+    CHECK(got_valid == valid, "spectral_stats n=%zu: valid %d vs %d", n,
+          got_valid, valid);
+    CHECK(memcmp(prev, out, n * sizeof(float)) == 0,
+          "spectral_stats n=%zu: magnitudes differ from magnitude()", n);
+    CHECK(guard_intact(prev, n), "spectral_stats n=%zu wrote past n", n);
+  }
+}
+
+static void test_log_exp(const SimdKernels *k) {
+  static float in[MAX_N];
+  for (int t = 0; t < NUM_SHORT + NUM_LONG; t++) {
+    size_t n = test_length(t);
+
+    // log over the whole positive normal range, and around 1
+    for (size_t i = 0; i < n; i++)
+      in[i] = i & 1 ? ldexpf(uniform(1.0f, 2.0f),
+                             (int)(test_random(&rng) % 250) - 125)
+                    : uniform(0.5f, 2.0f);
+    fill_guard(out, n);
+    k->log(in, out, n);
+    double max_err = 0;
+    for (size_t i = 0; i < n; i++) {
+      // Absolute error near log(1) = 0, where ulps shrink without bound
+      double ref = log((double)in[i]);
+      double e = fabs(ref) < 0.5 ? fabs(out[i] - ref) / FLT_EPSILON
+                                 : ulp_error(out[i], ref);
+      max_err = e > max_err ? e : max_err;
+    }
+    CHECK(max_err <= 2.0, "log n=%zu: %.2f ulp", n, max_err);
+    CHECK(guard_intact(out, n), "log n=%zu wrote past n", n);
+
+    for (size_t i = 0; i < n; i++)
+      in[i] = i & 1 ? uniform(-87.0f, 88.0f) : uniform(-1.0f, 1.0f);
+    fill_guard(out, n);
+    k->exp(in, out, n);
+    max_err = 0;
+    for (size_t i = 0; i < n; i++) {
+      double e = ulp_error(out[i], exp((double)in[i]));
+      max_err = e > max_err ? e : max_err;
+    }
+    CHECK(max_err <= 2.0, "exp n=%zu: %.2f ulp", n, max_err);
+    CHECK(guard_intact(out, n), "exp n=%zu wrote past n", n);
+  }
+
+  // Clamped, still finite, at the ends of the range
+  in[0] = -200.0f;
+  in[1] = 200.0f;
+  k->exp(in, out, 2);
+  CHECK(out[0] > 0 && out[0] < 1e-37f && isfinite(out[1]) && out[1] > 1e38f,
+        "exp clamps: %g %g", out[0], out[1]);
+}
+
+static void test_pcm(const SimdKernels *k) {
+  static int16_t i16[2 * MAX_N];
+  static uint8_t i24[3 * MAX_N];
+  static int32_t i32[MAX_N];
+  const float scale = 1.0f / 32768.0f;
+  for (int t = 0; t < NUM_SHORT + NUM_LONG; t++) {
+    size_t n = test_length(t);
+    for (size_t i = 0; i < 2 * n; i++)
+      i16[i] = (int16_t)(test_random(&rng) >> 16);
+    i16[0] = -32768; // Extremes, where sign extension shows
+    i16[1] = 32767;
+    for (size_t i = 0; i < 3 * n; i++)
+      i24[i] = (uint8_t)test_random(&rng);
+    for (size_t i = 0; i < n; i++)
+      i32[i] = (int32_t)test_random(&rng);
+
+    // Conversions are exact (or round once, for 32-bit) before the scale
+    fill_guard(out, n);
+    k->i16_to_f32(i16, out, n, scale);
+    int exact = 1;
+    for (size_t i = 0; i < n; i++)
+      exact &= out[i] == (float)i16[i] * scale;
+    CHECK(exact && guard_intact(out, n), "i16_to_f32 n=%zu", n);
+
+    for (int channel = -1; channel < 2; channel++) {
+      fill_guard(out, n);
+      k->i16_stereo_to_f32(i16, out, n, channel, scale);
+      exact = 1;
+      for (size_t i = 0; i < n; i++) {
+        int x = channel < 0 ? i16[2 * i] + i16[2 * i + 1]
+                            : i16[2 * i + channel];
+        exact &= out[i] == (float)x * scale;
+      }
+      CHECK(exact && guard_intact(out, n), "i16_stereo_to_f32 n=%zu ch=%d",
+            n, channel);
+    }
+
+    fill_guard(out, n);
+    k->i24_to_f32(i24, out, n, scale);
+    exact = 1;
+    for (size_t i = 0; i < n; i++) {
+      int32_t x = (int32_t)((uint32_t)i24[3 * i] << 8 |
+                            (uint32_t)i24[3 * i + 1] << 16 |
+                            (uint32_t)i24[3 * i + 2] << 24) >>
+                  8;
+      exact &= out[i] == (float)x * scale;
+    }
+    CHECK(exact && guard_intact(out, n), "i24_to_f32 n=%zu", n);
+
+    fill_guard(out, n);
+    k->i32_to_f32(i32, out, n, scale);
+    exact = 1;
+    for (size_t i = 0; i < n; i++)
+      exact &= out[i] == (float)i32[i] * scale;
+    CHECK(exact && guard_intact(out, n), "i32_to_f32 n=%zu", n);
+  }
+}
+
+int main(void) {
+  int tested = 0;
+  for (int isa = SIMD_ISA_SCALAR; isa <= SIMD_ISA_AVX512; isa++) {
+    const SimdKernels *k = simd_get_kernels((SimdIsa)isa);
+    if (!k) {
+      printf("%-7s skipped (not built or not supported here)\n",
+             simd_isa_name((SimdIsa)isa));
+      continue;
+    }
+    int before = failures;
+    test_reductions(k);
+    test_windows(k);
+    test_spectra(k);
+    test_log_exp(k);
+    test_pcm(k);
+    printf("%-7s %s\n", simd_isa_name((SimdIsa)isa),
+           failures == before ? "ok" : "FAILED");
+    tested++;
+  }
+
+  const SimdKernels *selected = simd_select_kernels();
+  printf("selected: %s\n", simd_isa_name(selected->isa));
+  return failures == 0 && tested > 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// test_spsc_ring - The SPSC ring's wraparound and counters
+//
+// Drives one ring from a single thread through many wraps of its storage
+// with write and read sizes that straddle the end, checking that elements
+// come out in order and intact through both spsc_ring_read and
+// spsc_ring_peek / spsc_ring_consume, that writes into a full ring keep what
+// fits and count the rest as dropped, and that the peak fill, underrun and
+// reset bookkeeping add up.
+
+#include "dsp/spsc_ring.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures;
+
+static void check(int ok, const char *what) {
+  if (!ok) {
+    printf("  FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// Ring in its own block, laid out the way a detector lays out its modules
+static SpscRing *create_ring(size_t min_capacity, size_t elem_size,
+                             void **memory) {
+  DspArena arena;
+  dsp_arena_init(&arena, NULL, 0);
+  spsc_ring_create(min_capacity, elem_size, &arena);
+  size_t size = dsp_arena_block_size(&arena);
+  *memory = calloc(1, size);
+  if (!*memory)
+    return NULL;
+  dsp_arena_init(&arena, *memory, size);
+  return spsc_ring_create(min_capacity, elem_size, &arena);
+}
+
+// Sequence numbers through many wraps, copied out or peeked in place
+static void check_wraparound(int peek) {
+  void *memory = NULL;
+  SpscRing *r = create_ring(13, sizeof(uint32_t), &memory);
+  check(r && spsc_ring_capacity(r) == 16, "capacity rounds up to 16");
+  if (!r) {
+    free(memory);
+    return;
+  }
+
+  uint32_t in[16], out[16];
+  uint32_t next_in = 0, next_out = 0;
+  int in_order = 1;
+  for (int step = 0; step < 1000; step++) {
+    size_t want = 1 + (size_t)(step * 7) % 11;
+    for (size_t i = 0; i < want; i++)
+      in[i] = next_in + (uint32_t)i;
+    next_in += (uint32_t)spsc_ring_write(r, in, want);
+
+    size_t take = 1 + (size_t)(step * 5) % 9;
+    if (peek) {
+      // Contiguous runs only: at the end of storage a second peek
+      // continues from its start
+      while (take > 0) {
+        void *data;
+        size_t n = spsc_ring_peek(r, &data);
+        if (n == 0)
+          break;
+        if (n > take)
+          n = take;
+        for (size_t i = 0; i < n; i++)
+          in_order &= ((const uint32_t *)data)[i] == next_out++;
+        spsc_ring_consume(r, n);
+        take -= n;
+      }
+    } else {
+      size_t n = spsc_ring_read(r, out, take);
+      for (size_t i = 0; i < n; i++)
+        in_order &= out[i] == next_out++;
+    }
+  }
+  check(in_order, peek ? "peeked elements in order" : "read elements in order");
+  check(spsc_ring_written(r) == next_in, "written counts appended elements");
+  check(spsc_ring_consumed(r) == next_out, "consumed counts released ones");
+  check(spsc_ring_written(r) + spsc_ring_dropped(r) > 1000,
+        "writes wrapped the ring many times");
+  check(spsc_ring_peak_fill(r) == 16, "ring filled up");
+
+  if (failures == 0)
+    printf("wraparound (%s): %llu elements, %llu dropped ok\n",
+           peek ? "peek" : "read", (unsigned long long)next_out,
+           (unsigned long long)spsc_ring_dropped(r));
+  free(memory);
+}
+
+// Writes into a full ring keep what fits and count the rest
+static void check_drops(void) {
+  void *memory = NULL;
+  SpscRing *r = create_ring(8, 3, &memory); // Odd element size
+  if (!r) {
+    check(0, "drops: out of memory");
+    free(memory);
+    return;
+  }
+
+  unsigned char in[3 * 12], out[3 * 12];
+  for (int i = 0; i < (int)sizeof(in); i++)
+    in[i] = (unsigned char)(i + 1);
+
+  check(spsc_ring_write(r, in, 5) == 5, "5 of 5 written");
+  check(spsc_ring_peak_fill(r) == 5, "peak fill 5");
+  check(spsc_ring_write(r, in + 3 * 5, 7) == 3, "3 of 7 written when full");
+  check(spsc_ring_dropped(r) == 4, "4 dropped");
+  check(spsc_ring_write(r, in, 1) == 0, "nothing written into a full ring");
+  check(spsc_ring_dropped(r) == 5, "5 dropped");
+  check(spsc_ring_peak_fill(r) == 8, "peak fill 8");
+
+  int intact = spsc_ring_read(r, out, 12) == 8;
+  for (int i = 0; i < 3 * 8; i++)
+    intact &= out[i] == in[i];
+  check(intact, "the first 8 elements read back intact");
+
+  check(spsc_ring_read(r, out, 1) == 0, "nothing read from an empty ring");
+  spsc_ring_note_underrun(r);
+  spsc_ring_note_underrun(r);
+  check(spsc_ring_underruns(r) == 2, "2 underruns");
+
+  // After the reset the next write starts at the beginning of storage
+  spsc_ring_reset(r);
+  void *data;
+  check(spsc_ring_written(r) == 0 && spsc_ring_consumed(r) == 0 &&
+            spsc_ring_dropped(r) == 0 && spsc_ring_peak_fill(r) == 0 &&
+            spsc_ring_underruns(r) == 0,
+        "reset zeroes the counters");
+  check(spsc_ring_peek(r, &data) == 0, "reset empties the ring");
+  spsc_ring_write(r, in, 8);
+  check(spsc_ring_peek(r, &data) == 8, "whole ring contiguous after reset");
+
+  if (failures == 0)
+    printf("drops and counters ok\n");
+  free(memory);
+}
+
+int main(void) {
+  check_wraparound(0);
+  check_wraparound(1);
+  check_drops();
+  return failures == 0 ? 0 : 1;
+}